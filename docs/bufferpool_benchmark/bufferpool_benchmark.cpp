@@ -0,0 +1,155 @@
+// g++ -O2 -std=c++11 -I../../include bufferpool_benchmark.cpp ../../src/*.cpp -o bufferpool_benchmark -levent_core -lpthread
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+#include <jinx/buffer.hpp>
+#include <jinx/posix.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+typedef std::chrono::steady_clock Clock;
+
+struct BufferConfig
+{
+	constexpr static char const* Name = "Benchmark";
+	static constexpr const size_t Size = 2048;
+	static constexpr const size_t Reserve = 4096;
+	static constexpr const long Limit = -1;
+
+	struct Information { };
+};
+
+typedef BufferAllocator<posix::MemoryProvider, BufferConfig> AllocatorType;
+typedef AllocatorType::BufferType BufferType;
+
+static void report(const char* name, size_t threads, long ops, Clock::duration elapsed)
+{
+	auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	std::cout << name
+		<< " threads " << threads
+		<< " ops/s " << (ops * 1000000 / (us == 0 ? 1 : us))
+		<< std::endl;
+}
+
+template<typename F>
+static Clock::duration run_threads(size_t threads, F&& fun)
+{
+	std::atomic<bool> start{false};
+	std::vector<std::thread> workers{};
+	for (size_t t = 0; t < threads; ++t) {
+		workers.emplace_back([&, t]() {
+			while (not start) {
+				std::this_thread::yield();
+			}
+			fun(t);
+		});
+	}
+
+	auto t0 = Clock::now();
+	start = true;
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	return Clock::now() - t0;
+}
+
+/*
+	Every thread allocates `burst` buffers and releases them, like a loop serving its own connections.
+	An operation is one allocation and its release.
+*/
+static void bench_local(AllocatorType& allocator, size_t threads, size_t count, size_t burst)
+{
+	auto elapsed = run_threads(threads, [&](size_t t) {
+		std::vector<BufferType> held(burst);
+		for (size_t i = 0; i < count; i += burst) {
+			for (auto& buffer : held) {
+				buffer = allocator.allocate(BufferConfig{});
+			}
+			for (auto& buffer : held) {
+				buffer.reset();
+			}
+		}
+	});
+	report(burst == 1 ? "local" : "local-burst", threads, count * threads, elapsed);
+}
+
+/*
+	Buffers allocated on one thread are released on the next one, like a buffer handed to another loop.
+	Each thread passes through a single slot to its neighbour.
+*/
+static void bench_cross(AllocatorType& allocator, size_t threads, size_t count)
+{
+	struct alignas(64) Slot {
+		std::atomic<AllocatorType::MemoryType*> _memory{nullptr};
+	};
+	std::vector<Slot> slots(threads);
+
+	auto elapsed = run_threads(threads, [&](size_t t) {
+		auto& out = slots[(t + 1) % threads];
+		auto& in = slots[t];
+		size_t sent = 0;
+		size_t received = 0;
+		while (sent < count or received < count) {
+			bool progress = false;
+			if (sent < count and out._memory.load(std::memory_order_relaxed) == nullptr) {
+				auto buffer = allocator.allocate(BufferConfig{});
+				out._memory.store(buffer.release(), std::memory_order_release);
+				sent += 1;
+				progress = true;
+			}
+			auto* memory = in._memory.exchange(nullptr, std::memory_order_acquire);
+			if (memory != nullptr) {
+				BufferType buffer{memory};
+				buffer.reset();
+				received += 1;
+				progress = true;
+			}
+			// more threads than cores
+			if (not progress) {
+				std::this_thread::yield();
+			}
+		}
+	});
+	report("cross", threads, count * threads, elapsed);
+}
+
+// the memory provider alone, the cost without a pool
+static void bench_provider(const char* name, posix::MemoryProvider& memory, size_t threads, size_t count)
+{
+	auto elapsed = run_threads(threads, [&](size_t t) {
+		for (size_t i = 0; i < count; ++i) {
+			void* mem = memory.alloc(BufferConfig::Size);
+			*static_cast<volatile char*>(mem) = 0;
+			memory.free(mem);
+		}
+	});
+	report(name, threads, count * threads, elapsed);
+}
+
+int main(int argc, const char* argv[])
+{
+	const size_t count = 1000UL * 1000UL;
+	const size_t thread_counts[] = {1, 2, 4, 8, 16, 32};
+
+	posix::MemoryProvider memory{};
+	posix::SlabMemoryProvider slab{};
+	AllocatorType allocator{memory};
+
+	for (auto threads : thread_counts) {
+		bench_provider("provider", memory, threads, count);
+		bench_provider("provider-slab", slab, threads, count);
+		bench_local(allocator, threads, count, 1);
+		bench_local(allocator, threads, count, 16);
+		bench_cross(allocator, threads, count / 4);
+	}
+
+	if (allocator.active_buffer_count() != allocator.reserve_buffer_count()) {
+		std::cout << "buffers leaked" << std::endl;
+		return 1;
+	}
+	return 0;
+}
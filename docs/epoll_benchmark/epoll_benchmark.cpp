@@ -0,0 +1,150 @@
+// g++ -O2 -std=c++11 -I../../include epoll_benchmark.cpp ../../src/*.cpp -o epoll_benchmark -levent_core -lpthread
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/iouring.hpp>
+
+using namespace jinx;
+
+typedef std::chrono::steady_clock Clock;
+
+static long messages = 0;
+
+/*
+	Echo server side, reads a message and writes it back.
+*/
+template<typename EventEngine>
+class Echo : public AsyncRoutine {
+	typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+	int _fd{-1};
+	char _buffer[64];
+	typename asyncio::Read _read{};
+	typename asyncio::Write _write{};
+
+public:
+	Echo& operator ()(int fd) {
+		_fd = fd;
+		this->async_start(&Echo::read);
+		return *this;
+	}
+
+protected:
+	Async read() {
+		return *this / _read(_fd, SliceMutable{_buffer, sizeof(_buffer)}) / &Echo::write;
+	}
+
+	Async write() {
+		if (_read.get_result() == 0) {
+			return this->async_return();
+		}
+		return *this / _write(_fd, SliceConst{_buffer, (size_t)_read.get_result()}) / &Echo::read;
+	}
+};
+
+/*
+	Client side, ping-pong `rounds` messages then closes the connection.
+	Every message suspends both sides, the engine is polled for each of them.
+*/
+template<typename EventEngine>
+class Client : public AsyncRoutine {
+	typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+	posix::IOHandle* _handle{nullptr};
+	long _rounds{0};
+	char _buffer[64];
+	typename asyncio::Read _read{};
+	typename asyncio::Write _write{};
+
+public:
+	Client& operator ()(posix::IOHandle& handle, long rounds) {
+		_handle = &handle;
+		_rounds = rounds;
+		this->async_start(&Client::write);
+		return *this;
+	}
+
+protected:
+	Async write() {
+		if (_rounds-- == 0) {
+			_handle->reset();
+			return this->async_return();
+		}
+		return *this / _write(_handle->native_handle(), SliceConst{"ping", 4}) / &Client::read;
+	}
+
+	Async read() {
+		return *this / _read(_handle->native_handle(), SliceMutable{_buffer, sizeof(_buffer)}) / &Client::count;
+	}
+
+	Async count() {
+		messages += 1;
+		return write();
+	}
+};
+
+template<typename EventEngine>
+static long run(EventEngine& eve, size_t connections, long rounds)
+{
+	Loop loop(&eve);
+	std::vector<posix::IOHandle> handles{};
+	handles.reserve(connections * 2);
+
+	for (size_t i = 0; i < connections; ++i) {
+		int fds[2];
+		if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) != 0) {
+			error::fatal("socketpair failed");
+		}
+		handles.emplace_back(fds[0]);
+		handles.emplace_back(fds[1]);
+		loop.task_new<Echo<EventEngine>>(fds[0]);
+		loop.task_new<Client<EventEngine>>(handles.back(), rounds);
+	}
+
+	messages = 0;
+	auto t0 = Clock::now();
+	loop.run();
+	return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - t0).count();
+}
+
+template<typename EventEngine>
+static void bench(const char* name, size_t connections, long rounds)
+{
+	EventEngine eve(false);
+	auto ms = run(eve, connections, rounds);
+	std::cout << name
+		<< " msgs/s " << (messages * 1000 / (ms == 0 ? 1 : ms))
+		<< " elapsed " << ms << "ms"
+		<< std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+	const long rounds = 50000;
+
+	for (size_t connections : {1, 16, 256}) {
+		std::cout << "echo, " << connections << " connections" << std::endl;
+		bench<libevent::EventEngineLibevent>("  libevent", connections, rounds / connections * 4);
+		bench<epoll::EventEngineEpoll>("  epoll   ", connections, rounds / connections * 4);
+		bench<iouring::EventEngineIoUring>("  io_uring", connections, rounds / connections * 4);
+
+		// registrations are kept, only the first wait of a descriptor calls epoll_ctl
+		epoll::EventEngineEpoll eve(false);
+		run(eve, connections, 1000);
+		std::cout << "  epoll_ctl " << eve.get_control_count() << std::endl;
+
+		// reads of a tick are submitted by one io_uring_enter
+		iouring::EventEngineIoUring ring(false);
+		run(ring, connections, 1000);
+		std::cout << "  io_uring_enter " << ring.get_enter_count() 
+			<< " for " << ring.get_submit_count() << " operations" << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,146 @@
+// g++ -O2 -std=c++11 -I../../include runbudget_benchmark.cpp ../../src/*.cpp -o runbudget_benchmark -levent_core -lpthread
+#include <unistd.h>
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+
+using namespace jinx;
+
+typedef posix::AsyncIOPosix<libevent::EventEngineLibevent> asyncio;
+typedef std::chrono::steady_clock Clock;
+
+static bool stop = false;
+static std::vector<long> latency{};
+
+static long now_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+/*
+	CPU bound task, spins `work` microseconds and yields.
+*/
+class Compute : public AsyncRoutine {
+	std::chrono::microseconds _work{};
+
+public:
+	Compute& operator ()(std::chrono::microseconds work) {
+		_work = work;
+		async_start(&Compute::compute);
+		return *this;
+	}
+
+protected:
+	Async compute() {
+		auto until = Clock::now() + _work;
+		while (Clock::now() < until) { }
+		if (stop) {
+			return async_return();
+		}
+		return async_yield(&Compute::compute);
+	}
+};
+
+/*
+	I/O task, reads the timestamps written by the ticker thread.
+	Latency is the time from the write to the task.
+*/
+class Reader : public AsyncRoutine {
+	int _fd{-1};
+	size_t _samples{0};
+	long _stamp{0};
+	asyncio::Read _read{};
+
+public:
+	Reader& operator ()(int fd, size_t samples) {
+		_fd = fd;
+		_samples = samples;
+		async_start(&Reader::read);
+		return *this;
+	}
+
+protected:
+	Async read() {
+		return *this / _read(_fd, SliceMutable{&_stamp, sizeof(_stamp)}) / &Reader::record;
+	}
+
+	Async record() {
+		latency.push_back(now_ns() - _stamp);
+		if (latency.size() == _samples) {
+			stop = true;
+			return async_return();
+		}
+		return read();
+	}
+};
+
+static void bench(const char* name, size_t max_tasks, std::chrono::microseconds max_time)
+{
+	const size_t tasks = 256;
+	const size_t samples = 2000;
+	const std::chrono::microseconds work{20};
+
+	int fds[2];
+	if (::pipe(fds) == -1) {
+		return;
+	}
+	asyncio::IOHandleType rfd{fds[0]};
+	asyncio::IOHandleType wfd{fds[1]};
+	rfd.set_non_blocking(true);
+
+	stop = false;
+	latency.clear();
+	latency.reserve(samples);
+
+	libevent::EventEngineLibevent eve{false};
+	Loop loop{&eve};
+	loop.set_run_budget(max_tasks, max_time);
+
+	loop.task_new<Reader>(fds[0], samples);
+	for (size_t i = 0; i < tasks; ++i) {
+		loop.task_new<Compute>(work);
+	}
+
+	std::atomic<bool> done{false};
+	std::thread ticker{[&]() {
+		while (not done) {
+			long stamp = now_ns();
+			if (::write(fds[1], &stamp, sizeof(stamp)) != sizeof(stamp)) {
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}};
+
+	loop.run();
+	done = true;
+	ticker.join();
+
+	std::sort(latency.begin(), latency.end());
+	auto pct = [&](double p) {
+		return latency[static_cast<size_t>(p * (latency.size() - 1))] / 1000;
+	};
+	std::cout << name
+		<< " p50 " << pct(0.50) << "us"
+		<< " p99 " << pct(0.99) << "us"
+		<< " max " << latency.back() / 1000 << "us"
+		<< std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+	std::cout << "256 compute tasks, 20us each, one reader" << std::endl;
+	bench("  unlimited   ", 0, std::chrono::microseconds{0});
+	bench("  256 tasks   ", 256, std::chrono::microseconds{0});
+	bench("  32 tasks    ", 32, std::chrono::microseconds{0});
+	bench("  8 tasks     ", 8, std::chrono::microseconds{0});
+	bench("  500us       ", 0, std::chrono::microseconds{500});
+	bench("  100us       ", 0, std::chrono::microseconds{100});
+	return 0;
+}
@@ -0,0 +1,136 @@
+// g++ -O2 -std=c++11 -I../../include taskqueue_benchmark.cpp -o taskqueue_benchmark -lpthread
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+
+#include <jinx/linkedlist.hpp>
+
+typedef std::chrono::steady_clock Clock;
+
+struct Node
+: jinx::LinkedListThreadSafe<Node>::Node,
+  jinx::LinkedListMPSC<Node>::Node
+{
+	Clock::time_point _stamp{};
+};
+
+typedef jinx::LinkedListThreadSafe<Node> Stack;
+typedef jinx::LinkedListMPSC<Node> Queue;
+
+static void report(const char* name, std::vector<long>& latency, long ops, Clock::duration elapsed)
+{
+	std::sort(latency.begin(), latency.end());
+	auto pct = [&](double p) {
+		return latency[static_cast<size_t>(p * (latency.size() - 1))];
+	};
+	auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+	std::cout << name
+		<< " ops/s " << (ops * 1000 / (ms == 0 ? 1 : ms))
+		<< " p50 " << pct(0.50) << "ns"
+		<< " p99 " << pct(0.99) << "ns"
+		<< " p999 " << pct(0.999) << "ns"
+		<< " max " << latency.back() << "ns"
+		<< std::endl;
+}
+
+static long since(const Clock::time_point& t) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t).count();
+}
+
+/*
+	Single thread: a loop with `tasks` runnable tasks, each task yields (re-schedules itself) after it runs.
+	Latency is the time a task spent in the ready queue.
+*/
+template<typename List>
+void bench_yield(const char* name, size_t tasks, size_t rounds)
+{
+	List list{};
+	std::vector<Node> nodes(tasks);
+	std::vector<long> latency{};
+	latency.reserve(rounds + tasks);
+
+	for (auto& node : nodes) {
+		node._stamp = Clock::now();
+		list.push(&node);
+	}
+
+	auto t0 = Clock::now();
+	for (size_t i = 0; i < rounds; ++i) {
+		auto* node = list.pop();
+		latency.push_back(since(node->_stamp));
+		node->_stamp = Clock::now();
+		list.push(node);
+	}
+	auto elapsed = Clock::now() - t0;
+
+	// tasks that never got a chance to run
+	while (auto* node = list.pop()) {
+		latency.push_back(since(node->_stamp));
+	}
+
+	report(name, latency, rounds, elapsed);
+}
+
+/*
+	Multi-producer: `producers` threads resume tasks, the loop thread runs them.
+*/
+template<typename List>
+void bench_resume(const char* name, size_t producers, size_t count)
+{
+	List list{};
+	std::vector<Node> nodes(producers * count);
+	std::vector<long> latency{};
+	latency.reserve(nodes.size());
+	std::atomic<bool> start{false};
+	std::vector<std::thread> threads{};
+
+	for (size_t p = 0; p < producers; ++p) {
+		threads.emplace_back([&, p]() {
+			while (not start) { }
+			for (size_t i = 0; i < count; ++i) {
+				auto& node = nodes[p * count + i];
+				node._stamp = Clock::now();
+				list.push(&node);
+			}
+		});
+	}
+
+	auto t0 = Clock::now();
+	start = true;
+	while (latency.size() != nodes.size()) {
+		auto* node = list.pop();
+		if (node != nullptr) {
+			latency.push_back(since(node->_stamp));
+		}
+	}
+	auto elapsed = Clock::now() - t0;
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	report(name, latency, nodes.size(), elapsed);
+}
+
+int main(int argc, const char* argv[])
+{
+	const size_t rounds = 1000UL * 1000UL * 10;
+
+	std::cout << "yield, 64 tasks" << std::endl;
+	bench_yield<Stack>("  stack", 64, rounds);
+	bench_yield<Queue>("  mpsc ", 64, rounds);
+
+	std::cout << "yield, 4096 tasks" << std::endl;
+	bench_yield<Stack>("  stack", 4096, rounds);
+	bench_yield<Queue>("  mpsc ", 4096, rounds);
+
+	for (size_t producers : {1, 2, 4}) {
+		std::cout << "resume, " << producers << " producers" << std::endl;
+		bench_resume<Stack>("  stack", producers, 1000UL * 1000UL);
+		bench_resume<Queue>("  mpsc ", producers, 1000UL * 1000UL);
+	}
+	return 0;
+}
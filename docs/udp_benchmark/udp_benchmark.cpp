@@ -0,0 +1,168 @@
+// g++ -O2 -std=c++11 -I../../include udp_benchmark.cpp ../../src/*.cpp -o udp_benchmark -levent_core -lpthread
+#include <sys/socket.h>
+
+#include <iostream>
+#include <chrono>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/datagram.hpp>
+#include <jinx/libevent.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+typedef posix::AsyncIOPosix<libevent::EventEngineLibevent> asyncio;
+typedef std::chrono::steady_clock Clock;
+
+static const size_t PacketSize = 64;
+// queued per round, fits the default receive buffer
+static const unsigned int RoundSize = 128;
+static const unsigned int BatchSize = 32;
+static const size_t Rounds = 4000;
+
+static size_t packets = 0;
+
+/*
+	One datagram per syscall.
+*/
+class ReceiverFrom : public AsyncRoutine {
+	int _fd{-1};
+	unsigned int _left{0};
+	char _memory[PacketSize];
+	posix::SocketAddress _from{};
+	asyncio::RecvFrom _recv{};
+
+public:
+	ReceiverFrom& operator ()(int fd) {
+		_fd = fd;
+		_left = RoundSize;
+		// dropped datagrams end the round
+		_recv.set_timeout(std::chrono::milliseconds(100));
+		async_start(&ReceiverFrom::recv);
+		return *this;
+	}
+
+protected:
+	Async handle_error(const error::Error& error) override {
+		return async_return();
+	}
+
+	Async recv() {
+		return *this / _recv(_fd, SliceMutable{_memory, sizeof(_memory)}, 0, _from) / &ReceiverFrom::count;
+	}
+
+	Async count() {
+		packets += 1;
+		_left -= 1;
+		if (_left == 0) {
+			return async_return();
+		}
+		return recv();
+	}
+};
+
+/*
+	Up to BatchSize datagrams per syscall, into views.
+*/
+class ReceiverMMsg : public AsyncRoutine {
+	int _fd{-1};
+	unsigned int _left{0};
+	char _memory[BatchSize][PacketSize];
+	BufferView _views[BatchSize];
+	datagram::MessageBatchStatic<BatchSize> _batch{};
+	datagram::RecvMMsg<asyncio> _recv{};
+
+public:
+	ReceiverMMsg& operator ()(int fd) {
+		_fd = fd;
+		_left = RoundSize;
+		_recv.set_timeout(std::chrono::milliseconds(100));
+		async_start(&ReceiverMMsg::recv);
+		return *this;
+	}
+
+protected:
+	Async handle_error(const error::Error& error) override {
+		return async_return();
+	}
+
+	Async recv() {
+		_batch.clear();
+		for (unsigned int i = 0; i < BatchSize; ++i) {
+			_views[i] = BufferView{_memory[i], PacketSize, 0, 0};
+			_batch.push(&_views[i]) >> JINX_IGNORE_RESULT;
+		}
+		return *this / _recv(_fd, &_batch) / &ReceiverMMsg::count;
+	}
+
+	Async count() {
+		const auto count = static_cast<unsigned int>(_recv.get_result());
+		packets += count;
+		_left -= count;
+		if (_left == 0) {
+			return async_return();
+		}
+		return recv();
+	}
+};
+
+/*
+	Each round queues RoundSize datagrams on the receiving socket, then times 
+	the loop draining them. One core is enough, the sender is not measured.
+*/
+template<typename Receiver>
+static void bench(const char* name) {
+	packets = 0;
+
+	posix::SocketAddress addr{"127.0.0.1", 0, posix::SocketAddressAbortOnFailure};
+	posix::Socket sock{};
+	sock.create(AF_INET, SOCK_DGRAM, 0).abort_on(-1, "failed to create socket");
+	sock.bind(addr).abort_on(-1, "failed to bind address");
+	sock.get_socket_name(addr).abort_on(-1, "failed to get address");
+	sock.set_non_blocking(true);
+
+	posix::Socket sender{};
+	sender.create(AF_INET, SOCK_DGRAM, 0).abort_on(-1, "failed to create socket");
+
+	char payload[PacketSize]{};
+	struct iovec iovecs[RoundSize];
+	struct mmsghdr msgs[RoundSize]{};
+	for (unsigned int i = 0; i < RoundSize; ++i) {
+		iovecs[i] = {payload, PacketSize};
+		msgs[i].msg_hdr.msg_name = const_cast<struct sockaddr*>(addr.data());
+		msgs[i].msg_hdr.msg_namelen = addr.size();
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	libevent::EventEngineLibevent eve{false};
+	Loop loop{&eve};
+
+	Clock::duration elapsed{0};
+	for (size_t round = 0; round < Rounds; ++round) {
+		if (::sendmmsg(sender.native_handle(), msgs, RoundSize, 0) != static_cast<int>(RoundSize)) {
+			std::cout << "sendmmsg failed" << std::endl;
+			return;
+		}
+		loop.task_new<Receiver>(sock.native_handle());
+
+		const auto start = Clock::now();
+		loop.run();
+		elapsed += Clock::now() - start;
+	}
+
+	const auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+	std::cout << name 
+		<< static_cast<size_t>(packets / seconds) << " pps, " 
+		<< (Rounds * RoundSize - packets) << " dropped" 
+		<< std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+	std::cout << PacketSize << " bytes datagrams over loopback, " << RoundSize << " queued per round" << std::endl;
+	bench<ReceiverFrom>("  RecvFrom    ");
+	bench<ReceiverMMsg>("  RecvMMsg    ");
+	return 0;
+}
@@ -32,6 +32,7 @@ SOFTWARE.
 #include <jinx/linkedlist.hpp>
 #include <jinx/optional.hpp>
 #include <jinx/eventengine.hpp>
+#include <jinx/timerwheel.hpp>
 #include <jinx/pointer.hpp>
 #include <jinx/error.hpp>
 
@@ -232,6 +233,13 @@ protected:
     JINX_NO_DISCARD
     ResultGeneric task_create(TaskPtr& task);
 
+    /*
+        Hand a new task to the loop running this awaitable, callable from any thread 
+        while the awaitable is suspended. The reference is consumed on success.
+    */
+    JINX_NO_DISCARD
+    ResultGeneric task_post(TaskPtr&& task);
+
     template<typename Config, typename Allocator, typename... TArgs>
     JINX_NO_DISCARD
     ResultGeneric task_allocate(Allocator* allocator, TArgs&&... args);
@@ -432,12 +440,12 @@ protected:
 template<typename EventEngine>
 class AsyncSleep : public Awaitable, public MixinResult<void>
 {
-    typename EventEngine::EventHandleTimer _handle;
-    struct timeval _timeval{};
+    TimerWheel::Entry _entry{};
+    TimerWheel::Clock::duration _duration{};
 
 protected:
     void async_finalize() noexcept override {
-        EventEngine::remove_timer(this, _handle) >> JINX_IGNORE_RESULT;
+        _entry.cancel();
         Awaitable::async_finalize();
     }
 
@@ -450,9 +458,7 @@ public:
     AsyncSleep& operator () (const std::chrono::duration<Rep, Period>& duration)
     {
         this->reset();
-        const auto sec = std::chrono::duration_cast<std::chrono::seconds>(duration);
-        _timeval.tv_sec = sec.count();
-        _timeval.tv_usec = std::chrono::duration_cast<std::chrono::microseconds>(duration - sec).count();
+        _duration = std::chrono::duration_cast<TimerWheel::Clock::duration>(duration);
         return *this;
     }
 
@@ -460,15 +466,15 @@ public:
         if (not this->empty()) {
             return this->async_return();
         }
-        if (EventEngine::add_timer(this, _handle, &_timeval, &AsyncSleep::timer_callabck, this).is(Failed_)) {
+        auto& timer_wheel = EventEngineAbstract::get_timer_wheel<EventEngine>(this);
+        if (timer_wheel.add(_entry, _duration, &AsyncSleep::timer_callback, this).is(Failed_)) {
             return this->async_throw(ErrorEventEngine::FailedToRegisterTimerEvent);
         }
         return this->async_suspend();
     }
 
-    static void timer_callabck(const error::Error& error, void* data) {
+    static void timer_callback(void* data) {
         auto* self = reinterpret_cast<AsyncSleep*>(data);
-        EventEngine::remove_timer(self, self->_handle) >> JINX_IGNORE_RESULT;
         self->emplace_result();
         self->async_resume() >> JINX_IGNORE_RESULT;
     }
@@ -159,6 +159,15 @@ ResultGeneric Awaitable::task_create(TaskPtr& task) {
     return _task->_task_queue->spawn(task);
 }
 
+JINX_NO_DISCARD
+inline
+ResultGeneric Awaitable::task_post(TaskPtr&& task) {
+    if (_task == nullptr or _task->_task_queue == nullptr) {
+        return Failed_;
+    }
+    return _task->_task_queue->post(std::move(task));
+}
+
 template<typename Config, typename Allocator, typename... TArgs>
 JINX_NO_DISCARD
 ResultGeneric Awaitable::task_allocate(Allocator* allocator, TArgs&&... args) {
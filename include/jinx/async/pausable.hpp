@@ -143,12 +143,24 @@ private:
     bool _timeout{false};
     Stage _stage{Stage::Call};
 
-    LinkedListThreadSafe<Task> _tasks_done;
+    LinkedListMPSC<Task> _tasks_done;
 
     EventEngineAbstract* get_event_engine() override {
         return _task->_task_queue->get_event_engine();
     }
 
+    TaskQueue* get_timer_queue() noexcept override {
+        return _task->_task_queue->get_timer_queue();
+    }
+
+    JINX_NO_DISCARD
+    ResultGeneric post(TaskPtr&& task) override {
+        if (_task == nullptr) {
+            return Failed_;
+        }
+        return _task->_task_queue->post(std::move(task));
+    }
+
     typedef TaskTagged<T, TaskBound<Task>> Tagged;
 
 public:
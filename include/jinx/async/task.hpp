@@ -24,12 +24,24 @@ SOFTWARE.
 #ifndef __jinx_async_task_hpp__
 #define __jinx_async_task_hpp__
 
+#include <memory>
+#include <thread>
+
 #include <jinx/async/awaitable.hpp>
+#include <jinx/async/taskpool.hpp>
 
 namespace jinx {
 
 typedef void (*DestroyTaskFunction)(Task* task);
 
+// Lower value runs first
+enum class TaskPriority : unsigned char {
+    High = 0,
+    Normal,
+    Low,
+    Count
+};
+
 namespace detail {
 class AwaitableTaskNode : public Awaitable {
     Awaitable* _next{nullptr};
@@ -54,7 +66,7 @@ protected:
 
 class Task 
 : protected Awaitable,
-  private LinkedListThreadSafe<Task>::Node,
+  private LinkedListMPSC<Task>::Node,
   private LinkedList<Task>::Node
 {
     friend class TaskQueue;
@@ -73,7 +85,7 @@ class Task
     friend class AwaitablePausable;
     friend class EventEngineAbstract;
     friend class AsyncWait;
-    friend class LinkedListThreadSafe<Task>;
+    friend class LinkedListMPSC<Task>;
     friend class LinkedList<Task>;
 
     typedef std::true_type SharedPointerRelease;
@@ -90,6 +102,9 @@ private:
     std::exception_ptr _exception;
 #endif
     Awaitable* _exc{nullptr};
+    // the tick of the task queue in which the task yielded
+    size_t _yield_tick{0};
+    TaskPriority _priority{TaskPriority::Normal};
 
     inline ControlState run() {
         ControlState state{};
@@ -174,6 +189,14 @@ public:
     JINX_NO_DISCARD
     ResultGeneric resume(const error::Error& error) noexcept;
 
+    TaskPriority get_priority() const noexcept { return _priority; }
+
+    // Set it before the task is spawned or while it's suspended
+    void set_priority(TaskPriority priority) noexcept {
+        jinx_assert(priority < TaskPriority::Count);
+        _priority = priority;
+    }
+
     void add_hook(detail::AwaitableTaskNode* hook) noexcept {
         hook->_task = this;
         hook->_next = this->get_entry();
@@ -246,6 +269,20 @@ public:
     T* new_task() {
         return new(std::nothrow)T();
     }
+
+    // recycled in the thread, see detail::TaskPool
+    static void* operator new(std::size_t size, const std::nothrow_t& ignored) noexcept {
+        return detail::TaskPool::allocate(size);
+    }
+
+    static void operator delete(void* memory, std::size_t size) noexcept {
+        detail::TaskPool::deallocate(memory, size);
+    }
+
+    // the constructor threw
+    static void operator delete(void* memory, const std::nothrow_t& ignored) noexcept {
+        ::operator delete(memory);
+    }
 };
 
 template<typename Base, typename A>
@@ -349,9 +386,39 @@ class TaskQueue {
 
     LinkedList<Task> _tasks_all{};
 
+    // mirror of _tasks_all.size(), readable from other threads
+    std::atomic<size_t> _load{0};
+    // tasks posted from other threads, not attached yet
+    std::atomic<size_t> _posted{0};
+
+    // a tick is the tasks run between two polls of the event engine
+    size_t _tick{1};
+
+    // the timers of the tasks, created by the first one
+    std::unique_ptr<TimerWheel> _timer_wheel{};
+    TimerWheel::Clock::duration _timer_slack{std::chrono::milliseconds(1)};
+
 protected:
+    typedef std::chrono::steady_clock RunBudgetClock;
+
+    static constexpr size_t PriorityCount = static_cast<size_t>(TaskPriority::Count);
+
     Task* _running_task{};
-    LinkedListThreadSafe<Task> _tasks_ready;
+    // one ready queue per priority
+    LinkedListMPSC<Task> _tasks_ready[PriorityCount];
+
+    /*
+        Dequeue is strict: a lower priority runs only when the higher ones are empty.
+        Except after `_starvation_budget` tasks were taken over a waiting lower priority,
+        then the lower priorities get one task, in turn. 0 is strictly by priority.
+    */
+    size_t _starvation_budget{64};
+    size_t _starvation_count{0};
+    size_t _starvation_next{1};
+
+    // 0 is unlimited
+    size_t _run_budget_tasks{256};
+    RunBudgetClock::duration _run_budget_time{0};
 
     TaskQueue() = default;
     JINX_NO_COPY_NO_MOVE(TaskQueue);
@@ -364,6 +431,39 @@ protected:
 
     virtual EventEngineAbstract* get_event_engine() = 0;
 
+    // the queue holding the timers, the loop at the root of the nested queues, see Wait
+    virtual TaskQueue* get_timer_queue() noexcept {
+        return this;
+    }
+
+    template<typename EventEngine>
+    TimerWheel& get_timer_wheel() {
+        auto* queue = get_timer_queue();
+        if (JINX_UNLIKELY(queue->_timer_wheel == nullptr)) {
+            auto* event_engine = queue->get_event_engine();
+            jinx_assert(event_engine->has_type_tag(EventEngine::type_tag()));
+            queue->_timer_wheel.reset(new TimerWheelEngine<EventEngine>(
+                static_cast<EventEngine*>(event_engine), queue->_timer_slack, &queue->_tick));
+        }
+        return *queue->_timer_wheel;
+    }
+
+    /*
+        The resolution of the timers, a timer expires at most one slack late.
+        Failed while timers are pending.
+    */
+    JINX_NO_DISCARD
+    ResultGeneric set_timer_slack(std::chrono::microseconds slack) noexcept {
+        if (slack.count() <= 0) {
+            return Failed_;
+        }
+        if (_timer_wheel != nullptr and _timer_wheel->set_slack(slack).is(Failed_)) {
+            return Failed_;
+        }
+        _timer_slack = slack;
+        return Successful_;
+    }
+
     JINX_NO_DISCARD
     virtual ResultGeneric schedule(Task* task, const error::Error& error) {
         auto state = task->_state.exchange(ControlState::Ready);
@@ -378,15 +478,19 @@ protected:
 
         task->set_error(error);
 
-        _tasks_ready.push(task);
+        push_ready(task);
         return Successful_;
     }
 
     JINX_NO_DISCARD
     ResultGeneric push(TaskPtr& task) noexcept {
+        if (JINX_UNLIKELY(_tasks_all.push_front(task).is(Failed_))) {
+            return Failed_;
+        }
         task.ref();
         task->_task_queue = this;
-        return _tasks_all.push_front(task);
+        _load.store(_tasks_all.size(), std::memory_order_relaxed);
+        return Successful_;
     }
 
     JINX_NO_DISCARD
@@ -395,6 +499,7 @@ protected:
             return Failed_; 
         }
         
+        _load.store(_tasks_all.size(), std::memory_order_relaxed);
         task->_task_queue = nullptr;
         task.unref();
         return Successful_;
@@ -408,6 +513,90 @@ protected:
         return _tasks_all.size();
     }
 
+    size_t get_load() const noexcept {
+        return _load.load(std::memory_order_relaxed) + _posted.load(std::memory_order_relaxed);
+    }
+
+    /*
+        Push a detached task into the ready queue from any thread.
+        The queue takes over the reference, and attaches the task when it's popped, see pop_ready.
+    */
+    JINX_NO_DISCARD
+    ResultGeneric post_ready(TaskPtr& task) noexcept {
+        if (task->_task_queue != nullptr) {
+            return Failed_;
+        }
+
+        auto state = task->_state.exchange(ControlState::Ready);
+        if (state != ControlState::Suspended) {
+            task->_state = state;
+            return Failed_;
+        }
+        task->set_error({});
+
+        _posted.fetch_add(1, std::memory_order_relaxed);
+        // released by pop_ready
+        push_ready(task.release());
+        return Successful_;
+    }
+
+    inline void push_ready(Task* task) noexcept {
+        _tasks_ready[static_cast<size_t>(task->_priority)].push(task);
+    }
+
+    bool has_ready() const noexcept {
+        for (const auto& tasks : _tasks_ready) {
+            if (not tasks.is_empty_unsafe()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool has_ready_below(size_t priority) const noexcept {
+        for (size_t index = priority + 1; index < PriorityCount; ++index) {
+            if (not _tasks_ready[index].is_empty_unsafe()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Task* pop_ready_by_priority() noexcept {
+        if (JINX_UNLIKELY(_starvation_budget != 0 and _starvation_count >= _starvation_budget)) {
+            _starvation_count = 0;
+            for (size_t n = 1; n < PriorityCount; ++n) {
+                auto index = _starvation_next;
+                _starvation_next = index + 1 == PriorityCount ? 1 : index + 1;
+                if (auto* task = _tasks_ready[index].pop()) {
+                    return task;
+                }
+            }
+        }
+
+        for (size_t index = 0; index < PriorityCount; ++index) {
+            if (auto* task = _tasks_ready[index].pop()) {
+                if (index + 1 < PriorityCount and has_ready_below(index)) {
+                    _starvation_count += 1;
+                } else {
+                    _starvation_count = 0;
+                }
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    Task* pop_ready() noexcept {
+        auto* task = pop_ready_by_priority();
+        if (JINX_UNLIKELY(task != nullptr and task->_task_queue == nullptr)) {
+            TaskPtr ptr{task};
+            push(ptr) >> JINX_IGNORE_RESULT;
+            _posted.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
     template<typename OnIdle, typename BeforeRun, typename OnTaskExit>
     inline
     void run(
@@ -415,11 +604,39 @@ protected:
         const BeforeRun& before_run, 
         const OnTaskExit& on_task_exit) 
     {
+        size_t ran = 0;
+        RunBudgetClock::time_point deadline{};
+
+        auto next_tick = [&]() {
+            _tick += 1;
+            ran = 0;
+            if (_run_budget_time.count() != 0) {
+                deadline = RunBudgetClock::now() + _run_budget_time;
+            }
+        };
+
+        auto budget_spent = [&]() {
+            return (_run_budget_tasks != 0 and ran >= _run_budget_tasks)
+                or (_run_budget_time.count() != 0 and RunBudgetClock::now() >= deadline);
+        };
+
+        next_tick();
         while (not this->empty()) 
         {
-            auto* task = _tasks_ready.pop();
+            auto* task = pop_ready();
             while (task != nullptr) 
             {
+                /*
+                    The task yielded in this tick, or the budget is spent.
+                    Poll without blocking, so pending I/O gets a chance between CPU bound tasks.
+                    All the tasks yielded in this tick share one poll.
+                */
+                if (JINX_UNLIKELY(task->_yield_tick == _tick or budget_spent())) {
+                    get_event_engine()->poll_non_blocking();
+                    next_tick();
+                }
+                ran += 1;
+
                 task->_exc = nullptr;
                 _running_task = task;
 
@@ -437,22 +654,18 @@ protected:
                     }
 
                 } if (JINX_UNLIKELY(state == ControlState::Yield)) {
-                    get_event_engine()->poll();
-                    auto* next = _tasks_ready.pop();
-                    if (next == nullptr) {
-                        continue;
-                    }
+                    task->_yield_tick = _tick;
                     schedule(task, {}) >> JINX_IGNORE_RESULT;
-                    task = next;
-                    continue;
                 }
 
-                task = _tasks_ready.pop();
+                task = pop_ready();
             }
 
-            if (on_idle()) {
+            // nothing would wake up the idle poll
+            if (this->empty() or on_idle()) {
                 break;
             }
+            next_tick();
         }
     }
 
@@ -461,12 +674,15 @@ protected:
             error::error("Exit from a running task");
         }
 
+        // attach posted tasks, so they are cancelled with the others
+        while(pop_ready() != nullptr) {};
+
         _tasks_all.for_each([this](Task* task){
             auto ptr = TaskPtr::shared_from_this(task);
             TaskQueue::cancel(ptr) >> JINX_IGNORE_RESULT;
         });
 
-        while(_tasks_ready.pop() != nullptr) {};
+        while(pop_ready_by_priority() != nullptr) {};
         
         _tasks_all.for_each([this](Task* task){
             auto ptr = TaskPtr::shared_from_this(task);
@@ -512,6 +728,15 @@ public:
         }
         return schedule(task, {});
     }
+
+    /*
+        Submit a new task from any thread, see Loop::post.
+        Nested queues forward it to the queue they run in.
+    */
+    JINX_NO_DISCARD
+    virtual ResultGeneric post(TaskPtr&& task) {
+        return Failed_;
+    }
 };
 
 class Loop : public TaskQueue {
@@ -520,14 +745,87 @@ class Loop : public TaskQueue {
     EventEngineAbstract* _event_engine;
     ErrorHandlerType _error_handler{};
 
+    // the thread inside run(), schedules from it need no wakeup
+    std::atomic<std::thread::id> _owner_thread{};
+
+    // adaptive busy poll, 0 always blocks in the idle poll
+    RunBudgetClock::duration _busy_poll_window{0};
+    size_t _busy_poll_spin_count{0};
+    size_t _busy_poll_hit_count{0};
+    size_t _busy_poll_sleep_count{0};
+
+    /*
+        Spin on non-blocking polls until a task gets ready or the window after 
+        the last one expires, then block.
+    */
+    void busy_poll() {
+        auto* event_engine = get_event_engine();
+        const auto deadline = RunBudgetClock::now() + _busy_poll_window;
+        do {
+            event_engine->poll_non_blocking();
+            _busy_poll_spin_count += 1;
+            if (has_ready()) {
+                _busy_poll_hit_count += 1;
+                return;
+            }
+        } while (RunBudgetClock::now() < deadline);
+
+        _busy_poll_sleep_count += 1;
+        event_engine->poll();
+    }
+
+    template<typename TaskHeapType, typename... Args>
+    TaskPtr spawn_new(TaskPriority priority, Args&&... args) {
+        auto task = TaskHeapType::template new_task<TaskHeapType>();
+
+        if (task == nullptr) {
+            return TaskPtr{nullptr};
+        }
+
+        auto task_ptr = TaskPtr{task};
+
+        task_ptr->set_priority(priority);
+        (*task)(std::forward<Args>(args)...);
+
+        spawn(task_ptr) >> JINX_IGNORE_RESULT;
+        return task_ptr;
+    }
+
 public:
     explicit Loop(EventEngineAbstract* event_engine) : _event_engine(event_engine) { }
     
+    bool is_owner_thread() const noexcept {
+        return _owner_thread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+    }
+
     JINX_NO_DISCARD
     ResultGeneric schedule(Task *task, const error::Error& error) override {
         if (TaskQueue::schedule(task, error).is(Failed_)) {
             return Failed_;
         }
+        if (not is_owner_thread()) {
+            _event_engine->wakeup();
+        }
+        return Successful_;
+    }
+
+    /*
+        Submit a new task from any thread, the reference is consumed on success.
+        The caller must not touch the task afterwards, it may be running in another thread.
+        The event engine should be thread safe if the loop is running in another thread.
+    */
+    JINX_NO_DISCARD
+    ResultGeneric post(TaskPtr&& task) override {
+        if (is_owner_thread()) {
+            if (spawn(task).is(Failed_)) {
+                return Failed_;
+            }
+            task.reset();
+            return Successful_;
+        }
+        if (post_ready(task).is(Failed_)) {
+            return Failed_;
+        }
         _event_engine->wakeup();
         return Successful_;
     }
@@ -538,6 +836,46 @@ public:
         _error_handler = handler;
     }
 
+    /*
+        Limit the tasks run between two polls of the event engine, 0 is unlimited.
+        Once the budget is spent, the loop polls without blocking and goes on.
+    */
+    void set_run_budget(size_t max_tasks, std::chrono::microseconds max_time = std::chrono::microseconds{0}) noexcept {
+        _run_budget_tasks = max_tasks;
+        _run_budget_time = max_time;
+    }
+
+    /*
+        Busy poll: once idle, spin on non-blocking polls for the window before 
+        blocking in the engine. Trades a core for the wakeup latency of a 
+        blocking poll, 0 disables it.
+    */
+    void set_busy_poll(std::chrono::microseconds window) noexcept {
+        _busy_poll_window = window;
+    }
+
+    // non-blocking polls of the busy poll
+    size_t get_busy_poll_spin_count() const noexcept { return _busy_poll_spin_count; }
+    // idle periods ended by a spin, a task got ready within the window
+    size_t get_busy_poll_hit_count() const noexcept { return _busy_poll_hit_count; }
+    // idle periods outlasting the window, ended by a blocking poll
+    size_t get_busy_poll_sleep_count() const noexcept { return _busy_poll_sleep_count; }
+
+    void reset_busy_poll_counters() noexcept {
+        _busy_poll_spin_count = 0;
+        _busy_poll_hit_count = 0;
+        _busy_poll_sleep_count = 0;
+    }
+
+    using TaskQueue::get_timer_wheel;
+    using TaskQueue::set_timer_slack;
+
+    // Tasks taken over a waiting lower priority before it gets one, 0 is strictly by priority
+    void set_starvation_budget(size_t budget) noexcept {
+        _starvation_budget = budget;
+        _starvation_count = 0;
+    }
+
     virtual error::Error unhandled_error(TaskPtr& task) {
         // backtrace
         if (task->_error and task->_exc != nullptr) {
@@ -567,9 +905,14 @@ public:
 
     error::Error run() { // NOLINT(readability-function-cognitive-complexity)
         bool exit_loop = false;
+        _owner_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
         TaskQueue::run(
             [&]() {
-                get_event_engine()->poll();
+                if (_busy_poll_window.count() != 0) {
+                    busy_poll();
+                } else {
+                    get_event_engine()->poll();
+                }
                 return false;
             },
             [](...) { },
@@ -595,6 +938,7 @@ public:
         if (exit_loop) {
             exit();
         }
+        _owner_thread.store(std::thread::id{}, std::memory_order_relaxed);
         return {};
     }
 
@@ -603,18 +947,15 @@ public:
         typename TaskHeapType=typename T::template TaskHeapType<T>,
         typename... Args>
     TaskPtr task_new(Args&&... args) {
-        auto task = TaskHeapType::template new_task<TaskHeapType>();
-
-        if (task == nullptr) {
-            return TaskPtr{nullptr};
-        }
-
-        auto task_ptr = TaskPtr{task};
-
-        (*task)(std::forward<Args>(args)...);
+        return spawn_new<TaskHeapType>(TaskPriority::Normal, std::forward<Args>(args)...);
+    }
 
-        spawn(task_ptr) >> JINX_IGNORE_RESULT;
-        return task_ptr;
+    template<
+        typename T, 
+        typename TaskHeapType=typename T::template TaskHeapType<T>,
+        typename... Args>
+    TaskPtr task_new_priority(TaskPriority priority, Args&&... args) {
+        return spawn_new<TaskHeapType>(priority, std::forward<Args>(args)...);
     }
 
     template<typename T, typename... TArgs>
@@ -640,6 +981,7 @@ public:
 
     using TaskQueue::exit;
     using TaskQueue::cancel;
+    using TaskQueue::get_load;
 };
 
 } // namespace jinx
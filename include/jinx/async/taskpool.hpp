@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef __jinx_async_taskpool_hpp__
+#define __jinx_async_taskpool_hpp__
+
+#include <cstddef>
+#include <new>
+
+namespace jinx {
+namespace detail {
+
+/*
+    Free lists of task memory, one list per size class and per thread.
+    A loop runs in one thread, so the tasks of a loop are recycled in the loop.
+    Blocks freed by another thread are cached in that thread.
+*/
+class TaskPool {
+public:
+    constexpr static const size_t Granularity = 64;
+    constexpr static const size_t ClassCount = 32;
+    // cached blocks per size class
+    constexpr static const size_t Limit = 256;
+
+    struct Statistics {
+        size_t allocate_count;
+        size_t reuse_count;
+        size_t release_count;
+        size_t cached_count;
+    };
+
+private:
+    struct Block {
+        Block* _next;
+    };
+
+    struct FreeList {
+        Block* _head;
+        size_t _size;
+    };
+
+    // zero initialized, so usable before and after the thread local destructors
+    struct State {
+        FreeList _lists[ClassCount];
+        Statistics _statistics;
+        bool _guarded;
+        bool _closed;
+    };
+
+    static State& get_state() noexcept {
+        static thread_local State state{};
+        return state;
+    }
+
+    // drains the free lists on thread exit
+    struct Guard {
+        ~Guard() {
+            auto& state = get_state();
+            state._closed = true;
+            for (auto& list : state._lists) {
+                while (list._head != nullptr) {
+                    auto* block = list._head;
+                    list._head = block->_next;
+                    ::operator delete(block);
+                }
+                list._size = 0;
+            }
+            state._statistics.cached_count = 0;
+        }
+    };
+
+    static size_t size_class(size_t size) noexcept {
+        return (size + Granularity - 1) / Granularity - 1;
+    }
+
+public:
+    static void* allocate(size_t size) noexcept {
+        auto index = size_class(size);
+        auto& state = get_state();
+        if (index < ClassCount) {
+            auto& list = state._lists[index];
+            if (list._head != nullptr) {
+                auto* block = list._head;
+                list._head = block->_next;
+                list._size -= 1;
+                state._statistics.reuse_count += 1;
+                state._statistics.cached_count -= 1;
+                return block;
+            }
+            size = (index + 1) * Granularity;
+        }
+        state._statistics.allocate_count += 1;
+        return ::operator new(size, std::nothrow);
+    }
+
+    static void deallocate(void* memory, size_t size) noexcept {
+        if (memory == nullptr) {
+            return;
+        }
+        auto index = size_class(size);
+        auto& state = get_state();
+        state._statistics.release_count += 1;
+        if (index >= ClassCount or state._closed or state._lists[index]._size >= Limit) {
+            ::operator delete(memory);
+            return;
+        }
+
+        if (not state._guarded) {
+            state._guarded = true;
+            static thread_local Guard guard{};
+            (void)guard;
+        }
+
+        auto& list = state._lists[index];
+        auto* block = static_cast<Block*>(memory);
+        block->_next = list._head;
+        list._head = block;
+        list._size += 1;
+        state._statistics.cached_count += 1;
+    }
+
+    // of the calling thread
+    static Statistics get_statistics() noexcept {
+        return get_state()._statistics;
+    }
+};
+
+} // namespace detail
+} // namespace jinx
+
+#endif
@@ -28,7 +28,10 @@ SOFTWARE.
 #include <cstring>
 
 #include <atomic>
+#include <mutex>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 #include <jinx/async.hpp>
 #include <jinx/meta.hpp>
@@ -77,6 +80,64 @@ struct SumPendingRequestCount {
         _sum += val.pending_request_count();
     }
 };
+
+/*
+    The indexes of the threads using the buffer pools.
+    An index is given back when its thread exits and taken again by the next new thread,
+    the buffers left in its magazines go with it.
+*/
+class BufferThreadSlots {
+    std::mutex _mutex{};
+    std::vector<size_t> _free{};
+    // the highest index taken so far, plus one
+    std::atomic<size_t> _count{0};
+
+public:
+    size_t acquire() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_free.empty()) {
+            return _count.fetch_add(1, std::memory_order_relaxed);
+        }
+        auto slot = _free.back();
+        _free.pop_back();
+        return slot;
+    }
+
+    void release(size_t slot) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _free.push_back(slot);
+    }
+
+    size_t count() const noexcept {
+        return _count.load(std::memory_order_relaxed);
+    }
+};
+
+inline BufferThreadSlots& buffer_thread_slots() noexcept {
+    static BufferThreadSlots slots{};
+    return slots;
+}
+
+struct BufferThreadSlot {
+    size_t _slot;
+
+    BufferThreadSlot() : _slot(buffer_thread_slots().acquire()) { }
+    JINX_NO_COPY_NO_MOVE(BufferThreadSlot);
+    ~BufferThreadSlot() {
+        buffer_thread_slots().release(_slot);
+    }
+};
+
+// A small index per thread, for the magazines of the buffer pools
+inline size_t buffer_thread_slot() noexcept {
+    static thread_local BufferThreadSlot slot{};
+    return slot._slot;
+}
+
+// Indexes in use so far, the most threads that used the buffer pools at once
+inline size_t buffer_thread_count() noexcept {
+    return buffer_thread_slots().count();
+}
     
 } // namespace detail
 
@@ -187,6 +248,54 @@ public:
     }
 };
 
+/*
+    A view of a ring, memory of ring_size bytes mapped twice in a row, see posix::MirroredMemory.
+
+    The data is always contiguous and the writer never compacts.
+    rebase moves the view back into the first mapping, and gives the view the capacity left in the ring
+    after keep, the oldest byte still referenced, the begin of the view by default.
+    Call it after consuming, before producing.
+*/
+class BufferViewRing {
+    char* _memory{nullptr};
+    size_t _ring_size{0};
+    BufferView _view{};
+
+public:
+    BufferViewRing() = default;
+    BufferViewRing(void* memory, size_t ring_size)
+    : _memory(reinterpret_cast<char*>(memory)), _ring_size(ring_size), _view{memory, ring_size, 0, 0}
+    { }
+
+    BufferView& view() noexcept { return _view; }
+
+    size_t ring_size() const noexcept { return _ring_size; }
+
+    size_t rebase() noexcept {
+        return rebase(_view.begin());
+    }
+
+    // Return the bytes the view moved back, pointers at or after keep may be moved the same
+    size_t rebase(const char* keep) noexcept {
+        auto keep_offset = static_cast<size_t>(keep - _memory);
+        auto begin_offset = static_cast<size_t>(_view.begin() - _memory);
+        auto end_offset = static_cast<size_t>(_view.end() - _memory);
+        if (keep_offset > begin_offset or end_offset - keep_offset > _ring_size) {
+            error::fatal("ring out of range");
+        }
+
+        size_t moved = 0;
+        if (keep_offset >= _ring_size) {
+            moved = _ring_size;
+            keep_offset -= moved;
+            begin_offset -= moved;
+            end_offset -= moved;
+        }
+        _view = BufferView{_memory, keep_offset + _ring_size, begin_offset, end_offset};
+        return moved;
+    }
+};
+
 template<typename Pool, typename... Configs>
 class BufferMemory final : private LinkedListThreadSafe<BufferMemory<Pool, Configs...>>::Node
 {
@@ -262,6 +371,10 @@ public:
     class BufferPool;
     class Allocate;
 
+private:
+    class AllocateWake;
+
+public:
     typedef BufferMemory<BufferPool> MemoryType;
     typedef pointer::PointerShared<MemoryType> BufferType;
 
@@ -436,6 +549,21 @@ public:
 template<typename MemoryProvider, typename... Configs>
 class BufferAllocator<MemoryProvider, Configs...>::BufferPool 
 {
+    /*
+        The reserve is split in per thread magazines in front of a shared depot.
+        A thread takes and returns buffers to its own magazine, and exchanges half of it
+        with the depot under the pool lock. Threads past MagazineThreads at once use the depot only.
+        A thread out of buffers steals from the magazines of the others before it waits.
+    */
+    static constexpr size_t MagazineThreads = 64;
+    static constexpr size_t MagazineSize = 8;
+
+    struct alignas(64) Magazine {
+        std::mutex _mutex{};
+        size_t _count{0};
+        MemoryType* _memory[MagazineSize];
+    };
+
     MemoryAllocator &_memory_allocator;
 
     size_t _size{};
@@ -443,12 +571,22 @@ class BufferAllocator<MemoryProvider, Configs...>::BufferPool
     long _limit{};
 
     std::atomic<size_t> _active_buffers{0};
-    
+    // buffers in the depot and the magazines
+    std::atomic<size_t> _reserve_count{0};
+    // mirror of _pending_requests.size(), readable without the lock
+    std::atomic<size_t> _pending_count{0};
+
+    // guards the depot and the pending requests, taken before a magazine lock
+    std::mutex _mutex{};
     LinkedListThreadSafe<MemoryType> _reserve_buffers;
     LinkedList<Allocate> _pending_requests;
 
+    Magazine _magazines[MagazineThreads];
+
     friend MemoryType;
     friend BufferAllocator<MemoryProvider, Configs...>;
+    friend Allocate;
+    friend AllocateWake;
 
     explicit BufferPool(MemoryAllocator& memory_allocator, size_t size, size_t reserve, size_t limit)
     : _memory_allocator(memory_allocator), _size(size), _reserve(reserve), _limit(limit)
@@ -463,57 +601,254 @@ class BufferAllocator<MemoryProvider, Configs...>::BufferPool
        this->reconfigure();
     }
 
+    // Not thread safe, the other threads must leave the pool alone meanwhile
     void reconfigure() {
-        while (_reserve_buffers.get_size_unsafe() > _reserve) {
+        flush_magazines();
+        while (_reserve_count > _reserve) {
             auto* mem = _reserve_buffers.pop();
-            release(mem);
+            _reserve_count -= 1;
+            _memory_allocator.deallocate_memory(mem);
+            _active_buffers -= 1;
         }
-        while(_reserve_buffers.get_size_unsafe() < _reserve) {
+        while(_reserve_count < _reserve) {
             auto memory = _memory_allocator.allocate_memory(this, _size).unwrap();
             if (memory == nullptr) {
                 break;
             }
             _active_buffers += 1;
             _reserve_buffers.push(memory);
+            _reserve_count += 1;
+        }
+    }
+
+    void flush_magazines() noexcept {
+        for (auto& magazine : _magazines) {
+            std::lock_guard<std::mutex> lock(magazine._mutex);
+            while (magazine._count != 0) {
+                _reserve_buffers.push(magazine._memory[--magazine._count]);
+            }
         }
     }
 
+    // a limit of -1 is none
+    bool over_limit() const noexcept {
+        return _active_buffers.load() > static_cast<size_t>(_limit);
+    }
+
+    Magazine* local_magazine() noexcept {
+        auto slot = detail::buffer_thread_slot();
+        return slot < MagazineThreads ? &_magazines[slot] : nullptr;
+    }
+
+    /*
+        Called from any thread. The buffer goes to a pending request if any, or to the reserve.
+        The checks of _pending_count after caching or freeing pair with register_request,
+        which counts itself before looking for a buffer, so no request misses one.
+    */
     void release(MemoryType* memory) noexcept {
-        if (not _pending_requests.empty()) 
-        {
-            auto refc = memory->_refc.fetch_add(1);
-            if (refc != 0) {
-                error::fatal("buffer use after free");
+        for (;;) {
+            if (_pending_count != 0 and hand_over(memory)) {
+                return;
             }
-            memory->reset();
 
-            auto* request = _pending_requests.back();
-            _pending_requests.erase(request) >> JINX_IGNORE_RESULT;
+            if (store(memory)) {
+                if (_pending_count == 0) {
+                    return;
+                }
+                // take it back for the request, unless another thread was faster
+                memory = take();
+            } else {
+                if (_pending_count == 0) {
+                    return;
+                }
+                // the request may have seen the pool at its limit before this one was freed
+                memory = _memory_allocator.allocate_memory(this, _size).unwrap();
+                if (memory != nullptr) {
+                    _active_buffers += 1;
+                }
+            }
+
+            if (memory == nullptr) {
+                return;
+            }
+        }
+    }
+
+    /*
+        Give the memory to the last pending request. In the thread of the request it's resumed directly,
+        from another thread a wake task is posted to its loop, see AllocateWake.
+    */
+    bool hand_over(MemoryType* memory) noexcept {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_pending_requests.empty()) {
+            return false;
+        }
+
+        auto refc = memory->_refc.fetch_add(1);
+        if (refc != 0) {
+            error::fatal("buffer use after free");
+        }
+        memory->reset();
+
+        auto* request = _pending_requests.back();
+        _pending_requests.erase(request) >> JINX_IGNORE_RESULT;
+        _pending_count -= 1;
 
-            // prevent unregister_request twice on *::async_finalize
-            request->_pool = nullptr;
+        // prevent unregister_request twice on *::async_finalize
+        request->_registered = false;
+        request->emplace_result(BufferType{memory});
 
-            request->emplace_result(BufferType{memory});
+        if (request->_owner_thread == std::this_thread::get_id()) {
+            lock.unlock();
             request->async_resume() >> JINX_IGNORE_RESULT;
+            return true;
+        }
 
-        } else {
-            if (_reserve_buffers.get_size_unsafe() >= _reserve) {
-                _memory_allocator.deallocate_memory(memory);
-                _active_buffers -= 1;
-            } else {
-                _reserve_buffers.push(memory);
+        // posted under the lock, async_finalize of the request takes it too
+        typedef typename AllocateWake::template TaskHeapType<AllocateWake> TaskHeapType;
+        auto* task = TaskHeapType::template new_task<TaskHeapType>();
+        if (task == nullptr) {
+            error::fatal("BufferPool: failed to allocate the wake task");
+        }
+        auto task_ptr = TaskPtr{task};
+        (*task)(request);
+        request->_wake = task->operator->();
+        if (request->task_post(std::move(task_ptr)).is(Failed_)) {
+            error::fatal("BufferPool: failed to post the wake task");
+        }
+        return true;
+    }
+
+    // Return false if the reserve is full and the memory is freed
+    bool store(MemoryType* memory) noexcept {
+        if (_reserve_count.fetch_add(1) >= _reserve) {
+            _reserve_count -= 1;
+            _memory_allocator.deallocate_memory(memory);
+            _active_buffers -= 1;
+            return false;
+        }
+
+        auto* magazine = local_magazine();
+        if (magazine != nullptr) {
+            std::lock_guard<std::mutex> lock(magazine->_mutex);
+            if (magazine->_count < MagazineSize) {
+                magazine->_memory[magazine->_count++] = memory;
+                return true;
             }
         }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (magazine != nullptr) {
+            // half of the full magazine to the depot
+            std::lock_guard<std::mutex> magazine_lock(magazine->_mutex);
+            while (magazine->_count > MagazineSize / 2) {
+                _reserve_buffers.push(magazine->_memory[--magazine->_count]);
+            }
+        }
+        _reserve_buffers.push(memory);
+        return true;
     }
 
-    JINX_NO_DISCARD
-    ResultGeneric register_request(Allocate* result) noexcept {
-        return _pending_requests.push_back(result);
+    MemoryType* take() noexcept {
+        if (_reserve_count == 0) {
+            return nullptr;
+        }
+
+        auto* magazine = local_magazine();
+        if (magazine != nullptr) {
+            std::lock_guard<std::mutex> lock(magazine->_mutex);
+            if (magazine->_count != 0) {
+                _reserve_count -= 1;
+                return magazine->_memory[--magazine->_count];
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        return take_locked(magazine);
     }
 
+    // With the pool lock, from the depot first, then from the magazines of the others
+    MemoryType* take_locked(Magazine* magazine) noexcept {
+        auto* memory = _reserve_buffers.pop();
+        if (memory != nullptr) {
+            if (magazine != nullptr) {
+                // refill half a magazine at once
+                std::lock_guard<std::mutex> magazine_lock(magazine->_mutex);
+                while (magazine->_count < MagazineSize / 2) {
+                    auto* next = _reserve_buffers.pop();
+                    if (next == nullptr) {
+                        break;
+                    }
+                    magazine->_memory[magazine->_count++] = next;
+                }
+            }
+            _reserve_count -= 1;
+            return memory;
+        }
+
+        auto threads = detail::buffer_thread_count();
+        for (size_t i = 0; i < threads and i < MagazineThreads; ++i) {
+            auto& other = _magazines[i];
+            std::lock_guard<std::mutex> magazine_lock(other._mutex);
+            if (other._count != 0) {
+                _reserve_count -= 1;
+                return other._memory[--other._count];
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+        Queue the request, or return a buffer that showed up since it last tried.
+        The request is counted before looking, see release.
+    */
     JINX_NO_DISCARD
-    ResultGeneric unregister_request(Allocate* result) noexcept {
-        return _pending_requests.erase(result);
+    ResultGeneric register_request(Allocate* request, BufferType& buffer) noexcept {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_pending_requests.push_back(request).is(Failed_)) {
+            return Failed_;
+        }
+        _pending_count += 1;
+
+        auto* memory = take_locked(local_magazine());
+        if (memory != nullptr) {
+            memory->reset();
+        } else if (not over_limit()) {
+            memory = _memory_allocator.allocate_memory(this, _size).unwrap();
+            if (memory != nullptr) {
+                _active_buffers += 1;
+            }
+        }
+
+        if (memory == nullptr) {
+            request->_registered = true;
+            request->_owner_thread = std::this_thread::get_id();
+            return Successful_;
+        }
+
+        _pending_requests.erase(request) >> JINX_IGNORE_RESULT;
+        _pending_count -= 1;
+
+        auto refc = memory->_refc.fetch_add(1);
+        if (refc != 0) {
+            error::fatal("buffer use after free");
+        }
+        buffer.reset(memory);
+        return Successful_;
+    }
+
+    // Also disarm a wake task not run yet
+    void unregister_request(Allocate* request) noexcept {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (request->_registered) {
+            _pending_requests.erase(request) >> JINX_IGNORE_RESULT;
+            _pending_count -= 1;
+            request->_registered = false;
+        }
+        if (request->_wake != nullptr) {
+            request->_wake->_request = nullptr;
+            request->_wake = nullptr;
+        }
     }
 
     template<typename Callable>
@@ -531,6 +866,7 @@ public:
     BufferPool() = default;
     JINX_NO_COPY_NO_MOVE(BufferPool);
     ~BufferPool() {
+        flush_magazines();
         while (auto* mem = _reserve_buffers.pop()) {
             _memory_allocator.deallocate_memory(mem);
             _active_buffers -= 1;
@@ -545,17 +881,18 @@ public:
     }
 
     size_t reserve_buffer_count() const noexcept {
-        return _reserve_buffers.get_size_unsafe();
+        return _reserve_count;
     }
 
     size_t pending_request_count() const noexcept {
-        return _pending_requests.size();
+        return _pending_count;
     }
 
+    // Callable from any thread, as is the release of the buffer
     BufferType allocate() noexcept {
-        auto* memory = _reserve_buffers.pop();
+        auto* memory = take();
         if (memory == nullptr) {
-            if (_active_buffers > _limit) {
+            if (over_limit()) {
                 return BufferType{nullptr};
             }
             memory = _memory_allocator.allocate_memory(this, _size).unwrap();
@@ -584,9 +921,15 @@ class BufferAllocator<MemoryProvider, Configs...>::Allocate
     typedef BufferAllocator<MemoryProvider, Configs...> AllocatorType;
 
     friend AllocatorType;
+    friend AllocateWake;
     
     BufferPool* _pool{nullptr};
 
+    // guarded by the lock of the pool
+    bool _registered{false};
+    std::thread::id _owner_thread{};
+    AllocateWake* _wake{nullptr};
+
 public:
     Allocate() = default;
 
@@ -601,7 +944,7 @@ public:
 protected:
     void async_finalize() noexcept override {
         if (_pool != nullptr) {
-            _pool->unregister_request(this) >> JINX_IGNORE_RESULT;
+            _pool->unregister_request(this);
             _pool = nullptr;
         }
         Awaitable::async_finalize();
@@ -618,13 +961,55 @@ protected:
             return this->async_return();
         }
 
-        if (_pool->register_request(this).is(Failed_)) {
+        // once registered, the result is filled by the releasing thread
+        if (_pool->register_request(this, buffer).is(Failed_)) {
             return this->async_throw(ErrorAllocate::RegisterAllocateError);
         }
+        if (buffer) {
+            this->emplace_result(std::move(buffer));
+            return this->async_return();
+        }
         return this->async_suspend();
     }
 };
 
+// Resume an Allocate filled by another thread, in the thread of its loop
+template<typename MemoryProvider, typename... Configs>
+class BufferAllocator<MemoryProvider, Configs...>::AllocateWake : public AsyncRoutine
+{
+    friend BufferPool;
+    friend Allocate;
+
+    Allocate* _request{nullptr};
+
+public:
+    AllocateWake& operator ()(Allocate* request) {
+        _request = request;
+        this->async_start(&AllocateWake::wake);
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        // cancelled with the loop before it ran
+        if (_request != nullptr) {
+            _request->_wake = nullptr;
+            _request = nullptr;
+        }
+        AsyncRoutine::async_finalize();
+    }
+
+    Async wake() {
+        auto* request = _request;
+        if (request != nullptr) {
+            _request = nullptr;
+            request->_wake = nullptr;
+            request->async_resume() >> JINX_IGNORE_RESULT;
+        }
+        return this->async_return();
+    }
+};
+
 template<typename A>
 class TaskBufferred : public Task
 {
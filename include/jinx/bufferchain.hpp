@@ -0,0 +1,325 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef __jinx_bufferchain_hpp__
+#define __jinx_bufferchain_hpp__
+
+#include <sys/uio.h>
+
+#include <deque>
+
+#include <jinx/buffer.hpp>
+#include <jinx/pointer.hpp>
+
+namespace jinx {
+namespace buffer {
+namespace detail {
+
+struct SegmentOwnerOps {
+    void (*_retain)(void* owner);
+    void (*_release)(void* owner);
+};
+
+template<typename Memory>
+struct SegmentOwner {
+    typedef pointer::PointerShared<Memory> PointerType;
+
+    static void retain(void* owner) noexcept {
+        PointerType pointer{static_cast<Memory*>(owner)};
+        PointerType copy{pointer};
+        pointer.release();
+        copy.release();
+    }
+
+    static void release(void* owner) noexcept {
+        PointerType pointer{static_cast<Memory*>(owner)};
+    }
+
+    static const SegmentOwnerOps* ops() noexcept {
+        static const SegmentOwnerOps owner_ops{&SegmentOwner::retain, &SegmentOwner::release};
+        return &owner_ops;
+    }
+};
+
+} // namespace detail
+
+/*
+    A message as a chain of buffers, none of the bytes are copied.
+    Each segment holds a reference to its buffer and a view of a part of it, 
+    so a buffer may be shared by segments of several chains, e.g. after split().
+    The buffers of any allocator or config may be mixed.
+
+    append, prepend and splice are O(1), split and consume walk the segments
+    before the offset and cut at most one of them in two.
+*/
+class BufferChain {
+    class Segment {
+        void* _owner{nullptr};
+        const detail::SegmentOwnerOps* _ops{nullptr};
+        BufferView _view{};
+
+        friend class BufferChain;
+
+    public:
+        Segment(void* owner, const detail::SegmentOwnerOps* ops, const BufferView& view) noexcept
+        : _owner(owner), _ops(ops), _view(view)
+        { }
+
+        Segment(Segment&& other) noexcept
+        : _owner(other._owner), _ops(other._ops), _view(other._view)
+        {
+            other._owner = nullptr;
+        }
+
+        Segment& operator =(Segment&& other) noexcept {
+            if (this != &other) {
+                release();
+                _owner = other._owner;
+                _ops = other._ops;
+                _view = other._view;
+                other._owner = nullptr;
+            }
+            return *this;
+        }
+
+        JINX_NO_COPY(Segment);
+
+        ~Segment() {
+            release();
+        }
+
+        // the same buffer, another view of it
+        Segment share(const BufferView& view) const noexcept {
+            if (_owner != nullptr) {
+                _ops->_retain(_owner);
+            }
+            return Segment{_owner, _ops, view};
+        }
+
+        void release() noexcept {
+            if (_owner != nullptr) {
+                _ops->_release(_owner);
+            }
+            _owner = nullptr;
+        }
+    };
+
+    std::deque<Segment> _segments{};
+    size_t _size{0};
+
+    template<typename Memory>
+    static Segment make_segment(pointer::PointerShared<Memory>&& buffer) {
+        const BufferView view = buffer.get()->view();
+        return Segment{buffer.release(), detail::SegmentOwner<Memory>::ops(), view};
+    }
+
+public:
+    BufferChain() = default;
+    BufferChain(BufferChain&&) = default;
+    BufferChain& operator =(BufferChain&&) = default;
+    JINX_NO_COPY(BufferChain);
+    ~BufferChain() = default;
+
+    size_t size() const noexcept { return _size; }
+
+    bool empty() const noexcept { return _size == 0; }
+
+    size_t segment_count() const noexcept { return _segments.size(); }
+
+    BufferView& segment(size_t index) noexcept { return _segments[index]._view; }
+
+    const BufferView& segment(size_t index) const noexcept { return _segments[index]._view; }
+
+    void clear() noexcept {
+        _segments.clear();
+        _size = 0;
+    }
+
+    // The bytes of the buffer, its view is not changed afterwards
+    template<typename Memory>
+    void append(pointer::PointerShared<Memory> buffer) {
+        if (buffer == nullptr or buffer->size() == 0) {
+            return;
+        }
+        _size += buffer->size();
+        _segments.emplace_back(make_segment(std::move(buffer)));
+    }
+
+    template<typename Memory>
+    void prepend(pointer::PointerShared<Memory> buffer) {
+        if (buffer == nullptr or buffer->size() == 0) {
+            return;
+        }
+        _size += buffer->size();
+        _segments.emplace_front(make_segment(std::move(buffer)));
+    }
+
+    // Memory not owned by the chain, e.g. static data, kept by the caller until the chain drops it
+    void append(const BufferView& view) {
+        if (view.size() == 0) {
+            return;
+        }
+        _size += view.size();
+        _segments.emplace_back(nullptr, nullptr, view);
+    }
+
+    void prepend(const BufferView& view) {
+        if (view.size() == 0) {
+            return;
+        }
+        _size += view.size();
+        _segments.emplace_front(nullptr, nullptr, view);
+    }
+
+    // Move the segments of other to the end of this one
+    void splice(BufferChain& other) {
+        if (_segments.empty()) {
+            _segments.swap(other._segments);
+        } else {
+            for (auto& segment : other._segments) {
+                _segments.emplace_back(std::move(segment));
+            }
+            other._segments.clear();
+        }
+        _size += other._size;
+        other._size = 0;
+    }
+
+    // Drop the first n bytes, at most size()
+    void consume(size_t n) noexcept {
+        if (n > _size) {
+            n = _size;
+        }
+        _size -= n;
+        while (n > 0) {
+            auto& view = _segments.front()._view;
+            if (n < view.size()) {
+                view.consume(n) >> JINX_IGNORE_RESULT;
+                break;
+            }
+            n -= view.size();
+            _segments.pop_front();
+        }
+    }
+
+    // Return the first n bytes, at most size(), as a chain of their own
+    BufferChain split(size_t n) {
+        BufferChain head{};
+        if (n > _size) {
+            n = _size;
+        }
+        _size -= n;
+        head._size = n;
+        while (n > 0) {
+            auto& front = _segments.front();
+            auto& view = front._view;
+            if (n < view.size()) {
+                const auto offset = static_cast<size_t>(view.begin() - static_cast<char*>(view.memory()));
+                head._segments.emplace_back(front.share(BufferView{view.memory(), view.memory_size(), offset, offset + n}));
+                view.consume(n) >> JINX_IGNORE_RESULT;
+                break;
+            }
+            n -= view.size();
+            head._segments.emplace_back(std::move(front));
+            _segments.pop_front();
+        }
+        return head;
+    }
+
+    /*
+        Drop the segments emptied by a stream, see views(), and count the rest again.
+    */
+    void trim() noexcept {
+        while (not _segments.empty() and _segments.front()._view.size() == 0) {
+            _segments.pop_front();
+        }
+        _size = 0;
+        for (auto& segment : _segments) {
+            _size += segment._view.size();
+        }
+    }
+
+    /*
+        The views of the segments from the first one, for Stream::writev, return the count.
+        The stream consumes the views in place, call trim() once it's done.
+    */
+    size_t views(BufferView** views, size_t max) noexcept {
+        size_t count = 0;
+        for (auto& segment : _segments) {
+            if (count == max) {
+                break;
+            }
+            views[count++] = &segment._view;
+        }
+        return count;
+    }
+
+    /*
+        The segments from offset bytes on as iovecs, for writev and sendmsg, return the count.
+        The chain is not changed, consume() the bytes written.
+    */
+    size_t iovecs(struct iovec* iov, size_t max, size_t offset = 0) const noexcept {
+        size_t count = 0;
+        for (auto& segment : _segments) {
+            if (count == max) {
+                break;
+            }
+            const auto& view = segment._view;
+            if (offset >= view.size()) {
+                offset -= view.size();
+                continue;
+            }
+            iov[count].iov_base = view.begin() + offset;
+            iov[count].iov_len = view.size() - offset;
+            offset = 0;
+            count += 1;
+        }
+        return count;
+    }
+
+    // Copy up to size bytes from offset, return the bytes copied
+    size_t copy_to(void* destination, size_t size, size_t offset = 0) const noexcept {
+        auto* output = static_cast<char*>(destination);
+        size_t copied = 0;
+        for (auto& segment : _segments) {
+            if (copied == size) {
+                break;
+            }
+            const auto& view = segment._view;
+            if (offset >= view.size()) {
+                offset -= view.size();
+                continue;
+            }
+            const auto n = std::min(view.size() - offset, size - copied);
+            ::memcpy(output + copied, view.begin() + offset, n);
+            copied += n;
+            offset = 0;
+        }
+        return copied;
+    }
+};
+
+} // namespace buffer
+} // namespace jinx
+
+#endif
@@ -0,0 +1,432 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef __jinx_datagram_hpp__
+#define __jinx_datagram_hpp__
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include <jinx/assert.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/macros.hpp>
+#include <jinx/posix.hpp>
+
+namespace jinx {
+namespace datagram {
+
+#if defined(__linux__)
+
+/*
+    The datagrams of one recvmmsg or sendmmsg call, each one a BufferView and an address.
+    RecvMMsg fills the free space of the views, SendMMsg sends their content.
+*/
+class MessageBatch
+{
+    struct mmsghdr* _msgs;
+    struct iovec* _iovecs;
+    struct sockaddr_storage* _addresses;
+    buffer::BufferView** _views;
+    unsigned int _capacity;
+    unsigned int _size{0};
+
+protected:
+    MessageBatch(
+        struct mmsghdr* msgs, 
+        struct iovec* iovecs, 
+        struct sockaddr_storage* addresses, 
+        buffer::BufferView** views, 
+        unsigned int capacity) noexcept
+    : _msgs(msgs),
+      _iovecs(iovecs),
+      _addresses(addresses),
+      _views(views),
+      _capacity(capacity)
+    { }
+
+public:
+    JINX_NO_COPY_NO_MOVE(MessageBatch);
+    ~MessageBatch() = default;
+
+    unsigned int size() const noexcept { return _size; }
+    unsigned int capacity() const noexcept { return _capacity; }
+    bool full() const noexcept { return _size == _capacity; }
+
+    void clear() noexcept { _size = 0; }
+
+    // a datagram to receive
+    JINX_NO_DISCARD
+    ResultGeneric push(buffer::BufferView* view) noexcept {
+        return push(view, nullptr, 0);
+    }
+
+    // a datagram to send, no address on connected sockets
+    JINX_NO_DISCARD
+    ResultGeneric push(buffer::BufferView* view, const struct sockaddr* address, socklen_t address_len) noexcept {
+        if (full() or address_len > sizeof(struct sockaddr_storage)) {
+            return Failed_;
+        }
+        auto& header = _msgs[_size].msg_hdr;
+        header.msg_namelen = address_len;
+        if (address_len != 0) {
+            memcpy(&_addresses[_size], address, address_len);
+        }
+        _views[_size] = view;
+        _size += 1;
+        return Successful_;
+    }
+
+    buffer::BufferView* view(unsigned int index) const noexcept { return _views[index]; }
+
+    // the source of a received datagram, the destination of a sent one
+    const struct sockaddr* address(unsigned int index) const noexcept {
+        return reinterpret_cast<const struct sockaddr*>(&_addresses[index]);
+    }
+
+    socklen_t address_len(unsigned int index) const noexcept { return _msgs[index].msg_hdr.msg_namelen; }
+
+    // the datagram was larger than its view
+    bool truncated(unsigned int index) const noexcept { return (_msgs[index].msg_hdr.msg_flags & MSG_TRUNC) != 0; }
+
+    struct mmsghdr* headers(unsigned int first) noexcept { return &_msgs[first]; }
+
+    struct mmsghdr* prepare_recv() noexcept {
+        for (unsigned int i = 0; i < _size; ++i) {
+            auto slice = _views[i]->slice_for_producer();
+            _iovecs[i].iov_base = slice.data();
+            _iovecs[i].iov_len = slice.size();
+            set_header(i, sizeof(struct sockaddr_storage));
+        }
+        return _msgs;
+    }
+
+    struct mmsghdr* prepare_send() noexcept {
+        for (unsigned int i = 0; i < _size; ++i) {
+            auto slice = _views[i]->slice_for_consumer();
+            _iovecs[i].iov_base = const_cast<void*>(static_cast<const void*>(slice.data()));
+            _iovecs[i].iov_len = slice.size();
+            set_header(i, _msgs[i].msg_hdr.msg_namelen);
+        }
+        return _msgs;
+    }
+
+    void commit_recv(unsigned int count) noexcept {
+        for (unsigned int i = 0; i < count; ++i) {
+            if (_views[i]->commit(_msgs[i].msg_len).is(Failed_)) {
+                error::fatal("datagram buffer out of range");
+            }
+        }
+    }
+
+    // a datagram is sent whole
+    void commit_send(unsigned int first, unsigned int count) noexcept {
+        for (unsigned int i = first; i < first + count; ++i) {
+            if (_views[i]->consume(_views[i]->size()).is(Failed_)) {
+                error::fatal("datagram buffer out of range");
+            }
+        }
+    }
+
+private:
+    void set_header(unsigned int index, socklen_t address_len) noexcept {
+        auto& header = _msgs[index].msg_hdr;
+        header.msg_name = address_len != 0 ? &_addresses[index] : nullptr;
+        header.msg_namelen = address_len;
+        header.msg_iov = &_iovecs[index];
+        header.msg_iovlen = 1;
+        header.msg_control = nullptr;
+        header.msg_controllen = 0;
+        header.msg_flags = 0;
+        _msgs[index].msg_len = 0;
+    }
+};
+
+template<unsigned int Capacity>
+class MessageBatchStatic : public MessageBatch
+{
+    struct mmsghdr _msgs_storage[Capacity];
+    struct iovec _iovecs_storage[Capacity];
+    struct sockaddr_storage _addresses_storage[Capacity];
+    buffer::BufferView* _views_storage[Capacity];
+
+public:
+    MessageBatchStatic() noexcept
+    : MessageBatch(_msgs_storage, _iovecs_storage, _addresses_storage, _views_storage, Capacity)
+    { }
+};
+
+// receives up to the size of the batch, the result is the number of datagrams
+template<typename AsyncIOImpl>
+class RecvMMsg : public AsyncIOImpl::RecvMMsg
+{
+    typedef typename AsyncIOImpl::RecvMMsg BaseType;
+    typedef typename AsyncIOImpl::IOHandleNativeType IOHandleNativeType;
+
+    MessageBatch* _batch{nullptr};
+
+public:
+    RecvMMsg& operator()(IOHandleNativeType handle, MessageBatch* batch, int flags = 0) {
+        jinx_assert(batch->size() > 0);
+        BaseType::operator()(handle, batch->prepare_recv(), batch->size(), flags);
+        _batch = batch;
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        _batch = nullptr;
+        BaseType::async_finalize();
+    }
+
+    Async async_poll() override {
+        auto state = BaseType::async_poll();
+        if (state == ControlState::Ready) {
+            _batch->commit_recv(static_cast<unsigned int>(BaseType::get_result()));
+        }
+        return state;
+    }
+};
+
+// sends the whole batch
+template<typename AsyncIOImpl>
+class SendMMsg : public AsyncIOImpl::SendMMsg
+{
+    typedef typename AsyncIOImpl::SendMMsg BaseType;
+    typedef typename AsyncIOImpl::IOHandleNativeType IOHandleNativeType;
+
+    MessageBatch* _batch{nullptr};
+    unsigned int _sent{0};
+    int _flags{0};
+
+public:
+    SendMMsg& operator()(IOHandleNativeType handle, MessageBatch* batch, int flags = 0) {
+        jinx_assert(batch->size() > 0);
+        BaseType::operator()(handle, batch->prepare_send(), batch->size(), flags);
+        _batch = batch;
+        _sent = 0;
+        _flags = flags;
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        _batch = nullptr;
+        BaseType::async_finalize();
+    }
+
+    Async async_poll() override {
+        auto state = BaseType::async_poll();
+        if (state == ControlState::Ready) {
+            const auto count = static_cast<unsigned int>(BaseType::get_result());
+            _batch->commit_send(_sent, count);
+            _sent += count;
+            if (_sent < _batch->size()) {
+                BaseType::operator()(this->native_handle(), _batch->headers(_sent), _batch->size() - _sent, _flags);
+                return this->async_poll();
+            }
+        }
+        return state;
+    }
+};
+
+/*
+    A control message buffer for one int sized option, UDP_SEGMENT on send 
+    and UDP_GRO on receive.
+*/
+union SegmentControl {
+    char _buffer[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr _align;
+};
+
+/*
+    Sends the content of a view as datagrams of segment_size bytes in one sendmsg, 
+    the last one may be shorter. The kernel or the NIC splits them (UDP_SEGMENT), 
+    at most 64 segments and 64KB per call.
+*/
+template<typename AsyncIOImpl>
+class SendSegments : public AsyncIOImpl::SendMsg
+{
+    typedef typename AsyncIOImpl::SendMsg BaseType;
+    typedef typename AsyncIOImpl::IOHandleNativeType IOHandleNativeType;
+
+    buffer::BufferView* _view{nullptr};
+    struct msghdr _msg{};
+    struct iovec _iovec{};
+    struct sockaddr_storage _address{};
+    SegmentControl _control{};
+
+public:
+    // no address on connected sockets
+    SendSegments& operator()(
+        IOHandleNativeType handle, 
+        buffer::BufferView* view, 
+        uint16_t segment_size, 
+        const struct sockaddr* address = nullptr, 
+        socklen_t address_len = 0, 
+        int flags = 0) 
+    {
+        jinx_assert(address_len <= sizeof(_address));
+        auto slice = view->slice_for_consumer();
+        _iovec.iov_base = const_cast<void*>(slice.data());
+        _iovec.iov_len = slice.size();
+
+        _msg = {};
+        if (address_len != 0) {
+            memcpy(&_address, address, address_len);
+            _msg.msg_name = &_address;
+            _msg.msg_namelen = address_len;
+        }
+        _msg.msg_iov = &_iovec;
+        _msg.msg_iovlen = 1;
+        _msg.msg_control = _control._buffer;
+        _msg.msg_controllen = sizeof(_control._buffer);
+
+        auto* cmsg = CMSG_FIRSTHDR(&_msg);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+        _msg.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+
+        BaseType::operator()(handle, &_msg, flags);
+        _view = view;
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        _view = nullptr;
+        BaseType::async_finalize();
+    }
+
+    Async async_poll() override {
+        auto state = BaseType::async_poll();
+        if (state == ControlState::Ready) {
+            if (_view->consume(static_cast<size_t>(BaseType::get_result())).is(Failed_)) {
+                error::fatal("datagram buffer out of range");
+            }
+        }
+        return state;
+    }
+};
+
+/*
+    Receives one datagram into the free space of a view or, on a socket with 
+    UDP_GRO enabled, several coalesced ones of the same size. The segments are 
+    slices of the view, the view should have room for 64KB.
+*/
+template<typename AsyncIOImpl>
+class RecvSegments : public AsyncIOImpl::RecvMsg
+{
+    typedef typename AsyncIOImpl::RecvMsg BaseType;
+    typedef typename AsyncIOImpl::IOHandleNativeType IOHandleNativeType;
+
+    buffer::BufferView* _view{nullptr};
+    const char* _first{nullptr};
+    size_t _received{0};
+    size_t _segment_size{0};
+    struct msghdr _msg{};
+    struct iovec _iovec{};
+    struct sockaddr_storage _address{};
+    SegmentControl _control{};
+
+public:
+    RecvSegments& operator()(IOHandleNativeType handle, buffer::BufferView* view, int flags = 0) {
+        auto slice = view->slice_for_producer();
+        _iovec.iov_base = slice.data();
+        _iovec.iov_len = slice.size();
+        _first = static_cast<const char*>(slice.data());
+
+        _msg = {};
+        _msg.msg_name = &_address;
+        _msg.msg_namelen = sizeof(_address);
+        _msg.msg_iov = &_iovec;
+        _msg.msg_iovlen = 1;
+        _msg.msg_control = _control._buffer;
+        _msg.msg_controllen = sizeof(_control._buffer);
+
+        BaseType::operator()(handle, &_msg, flags);
+        _view = view;
+        _received = 0;
+        _segment_size = 0;
+        return *this;
+    }
+
+    // the size of the datagrams, the last one may be shorter
+    size_t segment_size() const noexcept { return _segment_size; }
+
+    size_t segment_count() const noexcept {
+        return _segment_size == 0 ? 1 : (_received + _segment_size - 1) / _segment_size;
+    }
+
+    SliceConst segment(size_t index) const noexcept {
+        const size_t offset = index * _segment_size;
+        const size_t left = _received - offset;
+        return {_first + offset, left < _segment_size ? left : _segment_size};
+    }
+
+    const struct sockaddr* address() const noexcept { return reinterpret_cast<const struct sockaddr*>(&_address); }
+    socklen_t address_len() const noexcept { return _msg.msg_namelen; }
+
+    // the datagrams were larger than the view
+    bool truncated() const noexcept { return (_msg.msg_flags & MSG_TRUNC) != 0; }
+
+protected:
+    void async_finalize() noexcept override {
+        _view = nullptr;
+        BaseType::async_finalize();
+    }
+
+    Async async_poll() override {
+        auto state = BaseType::async_poll();
+        if (state == ControlState::Ready) {
+            _received = static_cast<size_t>(BaseType::get_result());
+            if (_view->commit(_received).is(Failed_)) {
+                error::fatal("datagram buffer out of range");
+            }
+
+            // a single datagram without the control message
+            _segment_size = _received;
+            for (auto* cmsg = CMSG_FIRSTHDR(&_msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&_msg, cmsg)) {
+                if (cmsg->cmsg_level == SOL_UDP and cmsg->cmsg_type == UDP_GRO) {
+                    int gso_size = 0;
+                    memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+                    _segment_size = static_cast<size_t>(gso_size);
+                }
+            }
+        }
+        return state;
+    }
+};
+
+#endif
+
+} // namespace datagram
+} // namespace jinx
+
+#endif
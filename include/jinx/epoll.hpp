@@ -0,0 +1,423 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef __jinx_epoll_hpp__
+#define __jinx_epoll_hpp__
+
+#if defined(__linux__)
+
+#include <sys/epoll.h>
+#include <sys/time.h>
+
+#include <csignal>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include <jinx/macros.hpp>
+#include <jinx/optional.hpp>
+#include <jinx/eventengine.hpp>
+#include <jinx/posix.hpp>
+
+namespace jinx {
+namespace epoll {
+
+/*
+    Event engine on epoll.
+
+    A file descriptor is registered once, edge triggered for both directions, 
+    and stays registered until it's closed. Waiting for I/O only links the 
+    awaitable to the descriptor, readiness is dispatched straight to it.
+    A descriptor closed without posix::IOHandle must be reported with 
+    posix::notify_close, otherwise a reused number keeps the stale registration.
+*/
+class EventEngineEpoll : public EventEngineAbstract, public posix::IOOperations {
+    class EventDataBase;
+    class EventDataIO;
+    class EventDataSimple;
+    class EventDataSimpleFunctional;
+
+    struct IOEntry {
+        // waiters for read and write
+        EventDataIO* _waiters[2]{nullptr, nullptr};
+        // edges without waiters
+        unsigned int _ready{0};
+        // edges to dispatch on the next poll
+        unsigned int _pending{0};
+        // close generation of the descriptor when registered
+        uint64_t _epoch{0};
+        bool _registered{false};
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    constexpr static const int MaxEvents = 64;
+
+    int _epoll_fd{-1};
+    bool _non_blocking{false};
+    bool _additional_non_blocking{false};
+    bool _no_exit_on_empty{false};
+
+    std::vector<IOEntry> _io_entries{};
+    std::vector<int> _io_pending{};
+    std::vector<EventDataBase*> _timers{};
+    EventDataBase* _signals[NSIG]{};
+    struct epoll_event _events[MaxEvents]{};
+
+    // events added while dispatching are skipped
+    size_t _dispatch_tick{0};
+    size_t _control_count{0};
+
+    // cross thread wakeup, only for thread safe engines
+    int _notify_fd{-1};
+    std::atomic<bool> _notified{false};
+
+    // self pipe of signal handlers
+    int _signal_fd[2]{-1, -1};
+
+protected:
+    // waiters, timers, signals and operations of derived engines
+    size_t _active{0};
+    // callbacks run by the current poll
+    size_t _dispatched{0};
+    // readable when a derived engine has completions, see dispatch_completions
+    int _completion_fd{-1};
+
+    void poll(bool non_blocking);
+    virtual void dispatch_completions() { }
+
+public:
+    typedef int IOHandleNativeType;
+    typedef ::jinx::posix::IOHandle IOHandleType;
+
+    constexpr static const IOHandleNativeType IOHandleNativeInvalidValue = -1;
+
+    typedef Optional<EventDataSimple> EventHandleTimer;
+    typedef Optional<EventDataSimple> EventHandleSignal;
+    typedef Optional<EventDataSimpleFunctional> EventHandleSignalFunctional;
+    typedef Optional<EventDataIO> EventHandleIO;
+
+    constexpr static const int IOFlagRead = EPOLLIN; 
+    constexpr static const int IOFlagWrite = EPOLLOUT; 
+    constexpr static const int IOFlagReadWrite = EPOLLIN | EPOLLOUT; 
+
+    struct IOTypeRead {
+        constexpr static unsigned int Flags = IOFlagRead;
+    };
+
+    struct IOTypeWrite {
+        constexpr static unsigned int Flags = IOFlagWrite;
+    };
+
+    struct IOTypeReadWrite {
+        constexpr static unsigned int Flags = IOFlagReadWrite;
+    };
+
+    explicit EventEngineEpoll(bool thread_safe);
+    JINX_NO_COPY_NO_MOVE(EventEngineEpoll);
+
+    virtual ~EventEngineEpoll();
+
+    static const void* type_tag();
+    const void* get_type_tag() override { return type_tag(); }
+
+    int get_epoll_handle() const noexcept {
+        return _epoll_fd;
+    }
+
+    // number of epoll_ctl calls
+    size_t get_control_count() const noexcept {
+        return _control_count;
+    }
+
+    // poll
+    void poll() override;
+
+    void poll_non_blocking() override;
+
+    // see EventEngineLibevent::wakeup
+    void wakeup() override;
+
+    void set_non_blocking(bool enable);
+
+    void set_no_exit_on_empty(bool enable);
+
+    static
+    IOHandleNativeType get_native_handle(IOHandleType& handle) {
+        return handle.native_handle();
+    }
+
+    static
+    IOHandleNativeType get_native_handle(IOHandleNativeType handle) {
+        return handle;
+    }
+
+    // reactor
+    JINX_NO_DISCARD
+    static
+    inline ResultGeneric add_io(
+        Awaitable* awaitable,
+        const IOTypeRead& /*unused*/, 
+        EventHandleIO& event_handle, 
+        IOHandleNativeType io_handle, 
+        EventCallbackIO callback, 
+        void* arg) 
+    { 
+        return add_io(awaitable, IOTypeRead::Flags, event_handle, io_handle, callback, arg); 
+    }
+
+    JINX_NO_DISCARD
+    inline ResultGeneric add_io(
+        const IOTypeRead& /*unused*/, 
+        EventHandleIO& event_handle, 
+        IOHandleNativeType io_handle, 
+        EventCallbackIO callback, 
+        void* arg) 
+    { 
+        return add_io(IOTypeRead::Flags, event_handle, io_handle, callback, arg); 
+    }
+
+    JINX_NO_DISCARD
+    static
+    inline ResultGeneric add_io(
+        Awaitable* awaitable,
+        const IOTypeWrite& /*unused*/,
+        EventHandleIO& event_handle,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg) 
+    {
+        return add_io(awaitable, IOTypeWrite::Flags, event_handle, io_handle, callback, arg); 
+    }
+
+    JINX_NO_DISCARD
+    inline ResultGeneric add_io(
+        const IOTypeWrite& /*unused*/,
+        EventHandleIO& event_handle,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg) 
+    {
+        return add_io(IOTypeWrite::Flags, event_handle, io_handle, callback, arg); 
+    }
+
+    JINX_NO_DISCARD
+    static
+    inline ResultGeneric add_io(
+        Awaitable* awaitable,
+        const IOTypeReadWrite& /*unused*/,
+        EventHandleIO& event_handle,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg)
+    { 
+        return add_io(awaitable, IOTypeReadWrite::Flags, event_handle, io_handle, callback, arg); 
+    }
+
+    JINX_NO_DISCARD
+    inline ResultGeneric add_io(
+        const IOTypeReadWrite& /*unused*/,
+        EventHandleIO& event_handle,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg)
+    { 
+        return add_io(IOTypeReadWrite::Flags, event_handle, io_handle, callback, arg); 
+    }
+
+    JINX_NO_DISCARD
+    static
+    ResultGeneric add_io(
+        Awaitable* awaitable,
+        unsigned int flags,
+        EventHandleIO& handle,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg);
+
+    JINX_NO_DISCARD
+    ResultGeneric add_io(
+        unsigned int flags,
+        EventHandleIO& handle,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg);
+
+    JINX_NO_DISCARD
+    static
+    ResultGeneric remove_io(Awaitable* awaitable, EventHandleIO& handle);
+
+    JINX_NO_DISCARD
+    ResultGeneric remove_io(EventHandleIO& handle);
+
+    // signal
+
+    JINX_NO_DISCARD
+    static
+    ResultGeneric add_signal(Awaitable* awaitable, EventHandleSignal& signal, int sig, EventCallback, void* arg);
+
+    JINX_NO_DISCARD
+    ResultGeneric add_signal(EventHandleSignal& signal, int sig, EventCallback, void* arg);
+
+    JINX_NO_DISCARD
+    static
+    ResultGeneric remove_signal(Awaitable* awaitable, EventHandleSignal& signal);
+
+    JINX_NO_DISCARD
+    ResultGeneric remove_signal(EventHandleSignal& signal);
+
+    JINX_NO_DISCARD
+    ResultGeneric add_signal(EventHandleSignalFunctional& signal, int sig, std::function<void(const error::Error&)>&&);
+
+    JINX_NO_DISCARD
+    ResultGeneric remove_signal(EventHandleSignalFunctional& signal);
+
+    // timer
+
+    JINX_NO_DISCARD
+    static
+    ResultGeneric add_timer(Awaitable* awaitable, EventHandleTimer& timer, struct timeval* timeval, EventCallback, void* arg);
+
+    JINX_NO_DISCARD
+    ResultGeneric add_timer(EventHandleTimer& timer, struct timeval* timeval, EventCallback, void* arg);
+
+    JINX_NO_DISCARD
+    static
+    ResultGeneric remove_timer(Awaitable* awaitable, EventHandleTimer& timer);
+
+    JINX_NO_DISCARD
+    ResultGeneric remove_timer(EventHandleTimer& timer);
+
+private:
+    int get_timeout() const noexcept;
+    void notify_drain();
+
+    ResultGeneric register_io(IOHandleNativeType io_handle);
+    void dispatch_io(IOHandleNativeType io_handle, unsigned int ready);
+    void dispatch_io_pending();
+    void attach_io(EventDataIO* event);
+    void detach_io(EventDataIO* event);
+
+    void timer_push(EventDataBase* event);
+    void timer_remove(EventDataBase* event);
+    void timer_sift_up(size_t index);
+    void timer_sift_down(size_t index);
+    void dispatch_timers();
+
+    ResultGeneric attach_signal(EventDataBase* event, int sig);
+    void detach_signal(EventDataBase* event);
+    void dispatch_signals();
+    static void signal_handler(int sig);
+
+    template<typename Handle>
+    static ResultGeneric remove_simple(Handle& handle);
+};
+
+// Timer and signal
+class EventEngineEpoll::EventDataBase {
+    friend class EventEngineEpoll;
+
+protected:
+    EventEngineEpoll* _engine;
+    int _state;
+
+    // timer
+    Clock::time_point _deadline{};
+    size_t _index{SIZE_MAX};
+
+    // signal
+    int _signal{0};
+    size_t _tick{0};
+    EventDataBase* _next{nullptr};
+
+    explicit EventDataBase(EventEngineEpoll* engine);
+    virtual ~EventDataBase();
+
+    // the handle may be released
+    virtual void fire(const error::Error& error) = 0;
+
+public:
+    JINX_NO_COPY_NO_MOVE(EventDataBase);
+};
+
+class EventEngineEpoll::EventDataSimple : public EventEngineEpoll::EventDataBase {
+    friend class EventEngineEpoll;
+
+    EventHandleTimer* _handle;
+    EventCallback _callback;
+    void* _arg;
+
+    void fire(const error::Error& error) override;
+public:
+    EventDataSimple(EventEngineEpoll* engine, EventHandleTimer* handle, EventCallback callback, void* arg);
+    ~EventDataSimple() override = default;
+};
+
+class EventEngineEpoll::EventDataSimpleFunctional : public EventEngineEpoll::EventDataBase {
+    friend class EventEngineEpoll;
+
+    EventHandleSignalFunctional* _handle;
+    std::function<void(const error::Error&)> _callback;
+
+    void fire(const error::Error& error) override;
+public:
+    EventDataSimpleFunctional(
+        EventEngineEpoll* engine, 
+        EventHandleSignalFunctional* handle, 
+        std::function<void(const error::Error&)>&& callback);
+    ~EventDataSimpleFunctional() override = default;
+};
+
+class EventEngineEpoll::EventDataIO {
+    friend class EventEngineEpoll;
+
+    EventEngineEpoll* _engine;
+    EventHandleIO* _handle;
+    IOHandleNativeType _io_handle;
+    unsigned int _flags;
+    int _state;
+    bool _attached{false};
+    size_t _tick{0};
+    EventDataIO* _next[2]{nullptr, nullptr};
+    EventCallbackIO _callback;
+    void* _arg;
+
+public:
+    EventDataIO(
+        EventEngineEpoll* engine, 
+        EventHandleIO* handle, 
+        IOHandleNativeType io_handle, 
+        unsigned int flags, 
+        EventCallbackIO callback, 
+        void* arg);
+    JINX_NO_COPY_NO_MOVE(EventDataIO);
+    ~EventDataIO();
+};
+
+} // namespace epoll
+} // namespace jinx
+
+#endif // __linux__
+
+#endif
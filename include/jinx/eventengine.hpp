@@ -33,6 +33,7 @@ SOFTWARE.
 namespace jinx {
 
 class Awaitable;
+class TimerWheel;
 
 enum class ErrorEventEngine {
     NoError,
@@ -48,6 +49,8 @@ JINX_ERROR_DEFINE(event_engine, ErrorEventEngine);
 
 typedef void(*EventCallback)(const error::Error&, void*);
 typedef void(*EventCallbackIO)(unsigned int flags, const error::Error&, void*);
+// result of a completed operation, a negative errno on failure
+typedef void(*EventCallbackComplete)(long result, void*);
 
 struct IOResult {
     error::Error _error{}; // TODO error condition
@@ -89,13 +92,26 @@ struct EventEngineAbstract
     inline
     T* get_event_engine(A* awaitable) noexcept {
         auto* event_engine = awaitable->_task->_task_queue->get_event_engine();
-        jinx_assert(event_engine->get_type_tag() == T:: type_tag());
+        jinx_assert(event_engine->has_type_tag(T:: type_tag()));
         return static_cast<T*>(event_engine);
     }
 
+    // the timers of the task queue running the awaitable, armed on T
+    template<typename T, typename A>
+    static
+    inline
+    TimerWheel& get_timer_wheel(A* awaitable) {
+        return awaitable->_task->_task_queue->template get_timer_wheel<T>();
+    }
+
+    // may be called from any thread
     virtual void wakeup() { }
     virtual void poll() { }
+    virtual void poll_non_blocking() { poll(); }
     virtual const void* get_type_tag() = 0;
+
+    // derived engines also answer to the tags of their bases
+    virtual bool has_type_tag(const void* tag) { return get_type_tag() == tag; }
 };
 
 } // namespace jinx
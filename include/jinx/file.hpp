@@ -0,0 +1,332 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef __jinx_file_hpp__
+#define __jinx_file_hpp__
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <atomic>
+#include <new>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/offload.hpp>
+#include <jinx/pointer.hpp>
+#include <jinx/posix.hpp>
+
+namespace jinx {
+namespace file {
+
+namespace detail {
+
+// the descriptor stays open until the last read of a worker is delivered
+struct FileShared : posix::IOHandle {
+    std::atomic<long> _refc{1};
+
+    explicit FileShared(int io_handle) : posix::IOHandle(io_handle) { }
+};
+
+typedef pointer::PointerShared<FileShared> FilePtr;
+
+} // namespace detail
+
+/*
+    Sequential reader of a regular file opened with O_DIRECT, the data bypasses the page cache.
+
+    Up to depth reads are in flight in an Offload pool, the chunks are returned in file order.
+    O_DIRECT needs aligned memory, offsets and sizes: a chunk starts at the first page boundary 
+    of a buffer of Config and holds Config::Size minus one page, rounded down to pages.
+    A Config::Size of a multiple of the page plus one page wastes nothing.
+    Files of file systems without O_DIRECT, tmpfs for instance, are read through the page cache.
+
+    The result is the next chunk, an empty pointer at the end of the file.
+    The file size is taken when it's opened, appended data is not read.
+*/
+template<typename Allocator, typename Config>
+class ReadDirect : public AsyncFunction<typename Allocator::BufferType> {
+public:
+    typedef typename Allocator::BufferType BufferType;
+    static constexpr size_t MaxDepth = 16;
+
+private:
+    typedef AsyncFunction<BufferType> BaseType;
+
+    class Job;
+
+    struct Slot {
+        Job* _job{nullptr};
+        BufferType _buffer{};
+        // the size read or -errno
+        long _result{0};
+        bool _done{false};
+    };
+
+    offload::Offload& _pool;
+    Allocator& _allocator;
+    size_t _depth;
+
+    detail::FilePtr _file{};
+    bool _direct{false};
+    uintptr_t _page{0};
+    size_t _chunk{0};
+    off_t _size{0};
+    // of the next read submitted
+    off_t _offset{0};
+
+    Slot _slots[MaxDepth];
+    size_t _head{0};
+    size_t _count{0};
+    bool _waiting{false};
+
+public:
+    ReadDirect(offload::Offload& pool, Allocator& allocator, size_t depth = 4)
+    : _pool(pool), _allocator(allocator), _depth(depth)
+    {
+        if (_depth == 0 or _depth > MaxDepth) {
+            error::fatal("depth out of range");
+        }
+    }
+
+    JINX_NO_COPY_NO_MOVE(ReadDirect);
+
+    ~ReadDirect() override {
+        close();
+    }
+
+    /*
+        Return the file descriptor, -1 on failure with errno set.
+        Falls back to the page cache if the file system refuses O_DIRECT, see is_direct.
+    */
+    JINX_NO_DISCARD
+    Result<int> open(const char* path) {
+        close();
+
+        _page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+        if (Config::Size < 2 * _page) {
+            errno = EINVAL;
+            return -1;
+        }
+        _chunk = (Config::Size - _page) & ~(_page - 1);
+
+        _direct = true;
+        int io_handle = ::open(path, O_RDONLY | O_CLOEXEC | O_DIRECT);
+        if (io_handle == -1 and errno == EINVAL) {
+            _direct = false;
+            io_handle = ::open(path, O_RDONLY | O_CLOEXEC);
+        }
+        if (io_handle == -1) {
+            return -1;
+        }
+
+        struct stat st{};
+        if (::fstat(io_handle, &st) == -1) {
+            const int err = errno;
+            ::close(io_handle);
+            errno = err;
+            return -1;
+        }
+        auto* file = new(std::nothrow) detail::FileShared(io_handle);
+        if (file == nullptr) {
+            ::close(io_handle);
+            errno = ENOMEM;
+            return -1;
+        }
+        _size = st.st_size;
+        _offset = 0;
+        _file.reset(file);
+        return io_handle;
+    }
+
+    // The reads in flight are dropped, the descriptor is closed once the workers are done with it
+    void close() {
+        for (auto& slot : _slots) {
+            if (slot._job != nullptr) {
+                slot._job->detach();
+            }
+            slot = Slot{};
+        }
+        _head = 0;
+        _count = 0;
+        _waiting = false;
+        _file.reset();
+    }
+
+    bool is_direct() const noexcept {
+        return _direct;
+    }
+
+    // bytes of a chunk, the last one may be shorter
+    size_t chunk_size() const noexcept {
+        return _chunk;
+    }
+
+    size_t in_flight() const noexcept {
+        return _count;
+    }
+
+    ReadDirect& operator ()() {
+        this->reset();
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        // the reads stay in flight for the next call
+        _waiting = false;
+        BaseType::async_finalize();
+    }
+
+    Async async_poll() override {
+        if (_file == nullptr) {
+            return this->async_throw(posix::ErrorPosix::BadFileDescriptor);
+        }
+        for (;;) {
+            auto error = submit();
+            if (_count == 0) {
+                if (error != offload::ErrorOffload::NoError) {
+                    return this->async_throw(error);
+                }
+                if (_offset < _size) {
+                    return this->async_throw(buffer::ErrorBuffer::OutOfMemory);
+                }
+                this->emplace_result(BufferType{});
+                return this->async_return();
+            }
+
+            auto& slot = _slots[_head];
+            if (not slot._done) {
+                _waiting = true;
+                return this->async_suspend();
+            }
+
+            auto buffer = std::move(slot._buffer);
+            const long result = slot._result;
+            slot = Slot{};
+            _head = (_head + 1) % _depth;
+            _count -= 1;
+
+            if (result < 0) {
+                return this->async_throw(error::Error(static_cast<int>(-result), posix::category_posix()));
+            }
+            if (result == 0) {
+                // the file was truncated
+                continue;
+            }
+            buffer->commit(static_cast<size_t>(result)) >> JINX_IGNORE_RESULT;
+
+            // keep the depth, a failure is raised by the next call if nothing is left in flight
+            submit();
+            this->emplace_result(std::move(buffer));
+            return this->async_return();
+        }
+    }
+
+private:
+    offload::ErrorOffload submit() {
+        while (_count < _depth and _offset < _size) {
+            auto buffer = _allocator.allocate(Config{});
+            if (buffer == nullptr) {
+                return offload::ErrorOffload::NoError;
+            }
+
+            // move the view to the first page boundary
+            const auto address = reinterpret_cast<uintptr_t>(buffer->begin());
+            const auto pad = static_cast<size_t>(((address + _page - 1) & ~(_page - 1)) - address);
+            buffer->commit(pad) >> JINX_IGNORE_RESULT;
+            buffer->consume(pad) >> JINX_IGNORE_RESULT;
+            buffer->cut(pad) >> JINX_IGNORE_RESULT;
+
+            auto& slot = _slots[(_head + _count) % _depth];
+            auto* job = new(std::nothrow) Job(this, &slot, _file, buffer, _offset, _chunk);
+            if (job == nullptr) {
+                return offload::ErrorOffload::OutOfMemory;
+            }
+            auto error = _pool.submit(job);
+            if (error != offload::ErrorOffload::NoError) {
+                delete job;
+                return error;
+            }
+            slot._job = job;
+            slot._buffer = std::move(buffer);
+            slot._done = false;
+            _offset += static_cast<off_t>(_chunk);
+            _count += 1;
+        }
+        return offload::ErrorOffload::NoError;
+    }
+
+    void delivered(Slot* slot) {
+        if (_waiting and slot == &_slots[_head]) {
+            _waiting = false;
+            this->async_resume() >> JINX_IGNORE_RESULT;
+        }
+    }
+};
+
+template<typename Allocator, typename Config>
+class ReadDirect<Allocator, Config>::Job : public offload::detail::Job {
+    ReadDirect* _reader;
+    Slot* _slot;
+    detail::FilePtr _file;
+    // the memory outlives a detached reader
+    BufferType _buffer;
+    off_t _offset;
+    size_t _size;
+    long _result{0};
+
+public:
+    Job(ReadDirect* reader, Slot* slot, detail::FilePtr& file, BufferType& buffer, off_t offset, size_t size)
+    : _reader(reader), _slot(slot), _file(file), _buffer(buffer), _offset(offset), _size(size) { }
+
+    void run() noexcept override {
+        ssize_t result;
+        do {
+            result = ::pread(_file->native_handle(), _buffer->begin(), _size, _offset);
+        } while (result == -1 and errno == EINTR);
+        _result = result == -1 ? -errno : static_cast<long>(result);
+    }
+
+    void deliver() noexcept override {
+        if (_reader == nullptr) {
+            return;
+        }
+        _slot->_job = nullptr;
+        _slot->_result = _result;
+        _slot->_done = true;
+        _reader->delivered(_slot);
+    }
+
+    void detach() noexcept override {
+        _reader = nullptr;
+    }
+};
+
+} // namespace file
+} // namespace jinx
+
+#endif
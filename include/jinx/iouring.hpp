@@ -0,0 +1,558 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef __jinx_iouring_hpp__
+#define __jinx_iouring_hpp__
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <jinx/macros.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/stream.hpp>
+#include <jinx/epoll.hpp>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace jinx {
+namespace iouring {
+
+class BufferRing;
+
+/*
+    Event engine submitting the operations of posix::AsyncIOPosix to io_uring.
+
+    Operations are queued as SQEs while the tasks run and submitted in one 
+    io_uring_enter per poll, completions are reaped from the shared ring and 
+    handed to the awaitables with their results.
+
+    Everything else, timers, signals, readiness and the operations io_uring 
+    can not take, is served by EventEngineEpoll. If io_uring is unavailable, 
+    the ring is full, the kernel lacks an opcode or the operation can not be 
+    allocated, the operation takes the readiness path instead.
+
+    Reads and accepts are submitted right away, they would mostly block. 
+    Writes and sends are called first and only submitted if they would block. 
+    Connects always wait for readiness.
+
+    Cancelling an operation waits for the kernel to let go of its buffers 
+    (IORING_REGISTER_SYNC_CANCEL, Linux 6.0), the result is dropped and an 
+    accepted descriptor is closed. Without synchronous cancellation every 
+    operation takes the readiness path. A deadline interrupts the operation 
+    instead, the awaitable still receives a result completed before it.
+
+    Receives may also leave the buffer to the kernel, see BufferRing.
+*/
+class EventEngineIoUring : public epoll::EventEngineEpoll {
+    friend class BufferRing;
+
+    struct Operation;
+
+    int _ring_fd{-1};
+
+    // submission queue
+    void* _sq_ring{nullptr};
+    size_t _sq_ring_size{0};
+    unsigned* _sq_head{nullptr};
+    unsigned* _sq_tail{nullptr};
+    unsigned* _sq_array{nullptr};
+    unsigned _sq_mask{0};
+    unsigned _sq_entries{0};
+    struct io_uring_sqe* _sqes{nullptr};
+    size_t _sqes_size{0};
+    unsigned _sq_local_tail{0};
+    unsigned _sq_submitted{0};
+
+    // completion queue
+    void* _cq_ring{nullptr};
+    size_t _cq_ring_size{0};
+    unsigned* _cq_head{nullptr};
+    unsigned* _cq_tail{nullptr};
+    unsigned _cq_mask{0};
+    struct io_uring_cqe* _cqes{nullptr};
+
+    // supported opcodes, indexed by posix::IOOpcode
+    bool _supported[16]{};
+
+    // provided buffer rings, indexed by buffer group
+    std::vector<BufferRing*> _buffer_rings{};
+    bool _recv_multishot{false};
+    bool _sync_cancel{false};
+
+    std::vector<Operation*> _operations{};
+    Operation* _free_operations{nullptr};
+
+    size_t _enter_count{0};
+    size_t _submit_count{0};
+    size_t _complete_count{0};
+
+public:
+    /*
+        result: the received size or a negative errno
+        buffer_id: the slot of the buffer ring holding the data, -1 without data
+        more: the receive stays armed
+    */
+    typedef void(*EventCallbackBuffer)(long result, int buffer_id, bool more, void* arg);
+
+    class EventHandleCompletion {
+        friend class EventEngineIoUring;
+        Operation* _operation{nullptr};
+
+    public:
+        bool empty() const noexcept { return _operation == nullptr; }
+    };
+
+    /*
+        entries: size of the submission queue, 0 disables io_uring and every 
+        operation takes the readiness path.
+    */
+    explicit EventEngineIoUring(bool thread_safe, unsigned int entries = 256);
+    JINX_NO_COPY_NO_MOVE(EventEngineIoUring);
+
+    ~EventEngineIoUring() override;
+
+    static const void* type_tag();
+    const void* get_type_tag() override { return type_tag(); }
+    bool has_type_tag(const void* tag) override;
+
+    // false if the engine fell back to readiness
+    bool is_ring_available() const noexcept {
+        return _ring_fd != -1;
+    }
+
+    // number of io_uring_enter calls
+    size_t get_enter_count() const noexcept { return _enter_count; }
+    // number of operations submitted
+    size_t get_submit_count() const noexcept { return _submit_count; }
+    // number of operations completed
+    size_t get_complete_count() const noexcept { return _complete_count; }
+
+    void poll() override;
+
+    void poll_non_blocking() override;
+
+    template<typename A>
+    JINX_NO_DISCARD
+    static
+    ResultGeneric submit_io(
+        A* awaitable, 
+        EventHandleCompletion& handle, 
+        const posix::IORequest& request, 
+        bool would_block,
+        EventCallbackComplete callback, 
+        void* arg)
+    {
+        auto* self = get_event_engine<EventEngineIoUring>(awaitable);
+        return self->submit_io(handle, request, would_block, callback, arg);
+    }
+
+    // would_block: the call returned EAGAIN
+    JINX_NO_DISCARD
+    ResultGeneric submit_io(
+        EventHandleCompletion& handle, 
+        const posix::IORequest& request, 
+        bool would_block,
+        EventCallbackComplete callback, 
+        void* arg);
+
+    template<typename A>
+    JINX_NO_DISCARD
+    static
+    ResultGeneric cancel_io(A* awaitable, EventHandleCompletion& handle) {
+        if (handle.empty()) {
+            return Successful_;
+        }
+        auto* self = get_event_engine<EventEngineIoUring>(awaitable);
+        return self->cancel_io(handle);
+    }
+
+    // returns once the kernel is done with the buffers of the operation
+    JINX_NO_DISCARD
+    ResultGeneric cancel_io(EventHandleCompletion& handle);
+
+    template<typename A>
+    JINX_NO_DISCARD
+    static
+    ResultGeneric interrupt_io(A* awaitable, EventHandleCompletion& handle) {
+        if (handle.empty()) {
+            return Failed_;
+        }
+        auto* self = get_event_engine<EventEngineIoUring>(awaitable);
+        return self->interrupt_io(handle);
+    }
+
+    /*
+        Asks the kernel to end an operation without dropping it. The callback 
+        still receives its completion, the result if it completed first or 
+        -ECANCELED. A multishot receive delivers until more is false.
+    */
+    JINX_NO_DISCARD
+    ResultGeneric interrupt_io(EventHandleCompletion& handle);
+
+    // false if receives can not take their buffers from a BufferRing
+    bool is_recv_multishot_available() const noexcept {
+        return _recv_multishot;
+    }
+
+    /*
+        Multishot receive into the buffers of the ring, the kernel picks a 
+        buffer only when data arrives. The callback is called for every 
+        completion until it is called with more false.
+
+        Failed if the ring or multishot receive is unavailable.
+    */
+    JINX_NO_DISCARD
+    ResultGeneric submit_recv(
+        EventHandleCompletion& handle,
+        IOHandleNativeType io_handle,
+        BufferRing& ring,
+        EventCallbackBuffer callback,
+        void* arg);
+
+protected:
+    void dispatch_completions() override;
+
+private:
+    bool setup(unsigned int entries);
+    void probe();
+    void release();
+
+    struct io_uring_sqe* get_sqe();
+    void drop_sqe(struct io_uring_sqe* sqe) noexcept;
+    Operation* get_operation(EventHandleCompletion& handle, void* arg);
+    ResultGeneric submit_cancel(Operation* operation);
+    bool discard_unsubmitted(Operation* operation) noexcept;
+    void submit();
+    size_t reap();
+    size_t reap_buffer(Operation* operation, long result, unsigned int flags);
+
+    JINX_NO_DISCARD
+    ResultGeneric register_buffer_ring(BufferRing* ring);
+    void unregister_buffer_ring(BufferRing* ring);
+};
+
+/*
+    Buffers provided to the kernel, shared by the receives of an engine.
+
+    A slot is refilled as soon as the kernel picks its buffer, a slot the 
+    refill fails is retried by fill. Memory follows the traffic, an idle 
+    receive holds no buffer, only the slots of the ring do.
+*/
+class BufferRing {
+    friend class EventEngineIoUring;
+
+    EventEngineIoUring& _engine;
+    void* _ring{nullptr};
+    size_t _ring_size{0};
+    unsigned int _entries{0};
+    uint16_t _tail{0};
+    int _group{-1};
+    size_t _provided{0};
+    std::vector<uint16_t> _missing{};
+
+protected:
+    // queues the buffer of a slot, visible to the kernel after publish
+    void provide(uint16_t buffer_id, void* memory, size_t size) noexcept;
+    void publish() noexcept;
+
+    // the kernel picked the buffer of a slot
+    void picked(uint16_t buffer_id);
+
+    // the receive of a picked buffer is gone, the slot keeps its buffer
+    void drop(uint16_t buffer_id) noexcept;
+
+    // unregisters from the kernel, before the buffers are released
+    void unregister() noexcept;
+
+    // provides a new buffer for the slot, false if none is available
+    virtual bool refill(uint16_t buffer_id) = 0;
+
+    // provides the buffer of the slot again
+    virtual void recycle(uint16_t buffer_id) noexcept = 0;
+
+public:
+    // entries: number of slots, rounded up to a power of 2, at most 32768
+    BufferRing(EventEngineIoUring& engine, unsigned int entries);
+    JINX_NO_COPY_NO_MOVE(BufferRing);
+    virtual ~BufferRing();
+
+    // false if the kernel refused the ring, receives fall back to readiness
+    bool is_registered() const noexcept { return _group != -1; }
+
+    int get_group() const noexcept { return _group; }
+
+    unsigned int get_entries() const noexcept { return _entries; }
+
+    // number of buffers held by the kernel
+    size_t get_provided_count() const noexcept { return _provided; }
+
+    // refills the slots left empty
+    void fill();
+};
+
+/*
+    BufferRing filled from a pool of a buffer::BufferAllocator.
+*/
+template<typename Allocator, typename Config>
+class BufferRingPool : public BufferRing {
+public:
+    typedef typename Allocator::BufferType BufferType;
+
+private:
+    Allocator& _allocator;
+    std::vector<BufferType> _buffers;
+
+public:
+    BufferRingPool(EventEngineIoUring& engine, Allocator& allocator, unsigned int entries)
+    : BufferRing(engine, entries), _allocator(allocator), _buffers(get_entries())
+    {
+        fill();
+    }
+
+    ~BufferRingPool() override {
+        unregister();
+    }
+
+    BufferType allocate() noexcept {
+        return _allocator.allocate(Config{});
+    }
+
+    // the buffer of a slot picked by the kernel, holding size bytes
+    BufferType take(uint16_t buffer_id, size_t size) {
+        auto buffer = std::move(_buffers[buffer_id]);
+        if (buffer->commit(size).is(Failed_)) {
+            error::fatal("buffer ring out of range");
+        }
+        picked(buffer_id);
+        return buffer;
+    }
+
+protected:
+    bool refill(uint16_t buffer_id) override {
+        auto buffer = _allocator.allocate(Config{});
+        if (not buffer) {
+            return false;
+        }
+        provide(buffer_id, buffer->memory(), buffer->memory_size());
+        _buffers[buffer_id] = std::move(buffer);
+        return true;
+    }
+
+    void recycle(uint16_t buffer_id) noexcept override {
+        auto& buffer = _buffers[buffer_id];
+        provide(buffer_id, buffer->memory(), buffer->memory_size());
+    }
+};
+
+/*
+    Receives of a socket into the buffers of a BufferRingPool, returning a 
+    BufferType holding the data.
+
+    The multishot receive stays armed between the awaits, data arriving 
+    meanwhile is queued. Once queue_limit buffers are queued the receive is 
+    interrupted, so a fast peer can not drain the shared ring, and armed again 
+    when the queue is empty. Without multishot receive or without buffers left 
+    in the ring, a buffer is allocated from the pool once the socket is 
+    readable.
+*/
+template<typename Ring>
+class RecvBuffer : public AsyncFunction<typename Ring::BufferType>
+{
+public:
+    typedef AsyncFunction<typename Ring::BufferType> BaseType;
+    typedef EventEngineIoUring EventEngineType;
+    typedef typename Ring::BufferType BufferType;
+
+private:
+    Ring* _ring;
+    int _io_handle{-1};
+    EventEngineIoUring* _engine{nullptr};
+    EventEngineIoUring::EventHandleCompletion _completion{};
+    EventEngineIoUring::EventHandleIO _handle{};
+    std::deque<BufferType> _received{};
+    size_t _queue_limit;
+    error::Error _recv_error{};
+    bool _end_of_stream{false};
+    bool _waiting{false};
+    bool _stopping{false};
+
+public:
+    // queue_limit: buffers queued before the multishot receive is stopped
+    explicit RecvBuffer(Ring* ring, size_t queue_limit = 16) : _ring(ring), _queue_limit(queue_limit) { }
+    JINX_NO_COPY_NO_MOVE(RecvBuffer);
+    ~RecvBuffer() override {
+        stop();
+    }
+
+    RecvBuffer& operator()(int io_handle) {
+        if (io_handle != _io_handle) {
+            stop();
+            _io_handle = io_handle;
+        }
+        this->reset();
+        this->async_start(&RecvBuffer::receive);
+        return *this;
+    }
+
+    // cancels the armed receive and drops the queued data
+    void stop() noexcept {
+        if (_engine != nullptr) {
+            _engine->cancel_io(_completion) >> JINX_IGNORE_RESULT;
+        }
+        _received.clear();
+        _recv_error = {};
+        _end_of_stream = false;
+        _stopping = false;
+    }
+
+    bool is_armed() const noexcept {
+        return not _completion.empty();
+    }
+
+    // number of buffers received but not awaited yet
+    size_t get_queued_count() const noexcept {
+        return _received.size();
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        _waiting = false;
+        if (not _handle.empty()) {
+            EventEngineType::remove_io(this, _handle) >> JINX_IGNORE_RESULT;
+            _handle.reset();
+        }
+        BaseType::async_finalize();
+    }
+
+    Async receive() {
+        if (not this->empty()) {
+            return this->async_return();
+        }
+
+        if (not _received.empty()) {
+            this->emplace_result(std::move(_received.front()));
+            _received.pop_front();
+            return this->async_return();
+        }
+
+        if (JINX_UNLIKELY(_recv_error)) {
+            auto error = _recv_error;
+            _recv_error = {};
+            return this->async_throw(error);
+        }
+
+        if (_end_of_stream) {
+            return this->async_throw(stream::ErrorStream::EndOfStream);
+        }
+
+        if (_completion.empty() and not arm()) {
+            return receive_ready();
+        }
+        _waiting = true;
+        return this->async_suspend();
+    }
+
+    bool arm() {
+        _ring->fill();
+        if (_ring->get_provided_count() == 0) {
+            return false;
+        }
+        _engine = EventEngineAbstract::get_event_engine<EventEngineIoUring>(this);
+        return _engine->submit_recv(_completion, _io_handle, *_ring, &RecvBuffer::recv_callback, this)
+            .is(Successful_);
+    }
+
+    Async receive_ready() {
+        auto buffer = _ring->allocate();
+        if (not buffer) {
+            return this->async_throw(buffer::ErrorBuffer::OutOfMemory);
+        }
+
+        auto slice = buffer->slice_for_producer();
+        auto result = posix::IOOperations::recv(_io_handle, slice, 0);
+        if (not result._error) {
+            if (result._size == 0) {
+                return this->async_throw(stream::ErrorStream::EndOfStream);
+            }
+            buffer->commit(result._size) >> JINX_IGNORE_RESULT;
+            this->emplace_result(std::move(buffer));
+            return this->async_return();
+        }
+
+        if (result._error.category() == posix::category_again()) {
+            // the buffer goes back to the pool while waiting
+            if (EventEngineType::add_io(
+                    this,
+                    EventEngineType::IOTypeRead{},
+                    _handle,
+                    _io_handle,
+                    &RecvBuffer::io_callback,
+                    this).is(Failed_))
+            {
+                return this->async_throw(ErrorEventEngine::FailedToRegisterIOEvent);
+            }
+            return this->async_suspend();
+        }
+        return this->async_throw(result._error);
+    }
+
+    static void io_callback(unsigned int flags, const error::Error& error, void* data) {
+        auto* self = reinterpret_cast<RecvBuffer*>(data);
+        self->async_resume(error) >> JINX_IGNORE_RESULT;
+    }
+
+    static void recv_callback(long result, int buffer_id, bool more, void* data) {
+        auto* self = reinterpret_cast<RecvBuffer*>(data);
+        if (buffer_id >= 0) {
+            self->_received.push_back(self->_ring->take(static_cast<uint16_t>(buffer_id), result));
+        } else if (result == 0) {
+            self->_end_of_stream = true;
+        } else if (result != -ENOBUFS and result != -EAGAIN and result != -ECANCELED) {
+            self->_recv_error = error::Error(static_cast<int>(-result), posix::category_posix());
+        }
+        // out of buffers, unsupported or stopped, the next receive arms again or falls back
+
+        if (not more) {
+            self->_stopping = false;
+        } else if (not self->_stopping and self->_received.size() >= self->_queue_limit) {
+            self->_stopping = self->_engine->interrupt_io(self->_completion).is(Successful_);
+        }
+
+        if (self->_waiting) {
+            self->_waiting = false;
+            self->async_resume() >> JINX_IGNORE_RESULT;
+        }
+    }
+};
+
+} // namespace iouring
+} // namespace jinx
+
+#endif // __linux__
+
+#endif
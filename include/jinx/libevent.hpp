@@ -42,8 +42,9 @@ SOFTWARE.
 namespace jinx {
 namespace libevent {
 
-class EventEngineLibevent : public EventEngineAbstract {
+class EventEngineLibevent : public EventEngineAbstract, public posix::IOOperations {
     class EventDataIO;
+    class EventDataRegistration;
     class EventDataSimple;
     class EventDataSimpleFunctional;
 
@@ -54,6 +55,15 @@ class EventEngineLibevent : public EventEngineAbstract {
     int _poll_flags;
     int _additional_flags{0};
 
+    size_t _control_count{0};
+
+    // cross thread wakeup, only for thread safe engines
+    int _notify_fd[2]{-1, -1};
+    struct event _notify_event{};
+    std::atomic<bool> _notified{false};
+
+    static void notify_callback(int io_handle, short event, void* arg);
+
 public:
     typedef int IOHandleNativeType;
     typedef ::jinx::posix::IOHandle IOHandleType;
@@ -64,6 +74,7 @@ public:
     typedef Optional<EventDataSimple> EventHandleSignal;
     typedef Optional<EventDataSimpleFunctional> EventHandleSignalFunctional;
     typedef Optional<EventDataIO> EventHandleIO;
+    typedef Optional<EventDataRegistration> EventHandleRegistration;
 
     constexpr static const int IOFlagRead = EV_READ; 
     constexpr static const int IOFlagWrite = EV_WRITE; 
@@ -98,6 +109,12 @@ public:
     // poll
     void poll() override;
 
+    void poll_non_blocking() override;
+
+    /*
+        Thread safe engine: write the notify fd, at most once until the loop consumes it.
+        Otherwise: break the current poll and make the next poll non-blocking.
+    */
     void wakeup() override;
 
     // EVLOOP_NONBLOCK
@@ -108,6 +125,11 @@ public:
 
     static void set_debug(bool enable);
 
+    // number of io events added, by add_io and by new registrations
+    size_t get_control_count() const noexcept {
+        return _control_count;
+    }
+
     static
     IOHandleNativeType get_native_handle(IOHandleType& handle) {
         return handle.native_handle();
@@ -216,6 +238,63 @@ public:
     JINX_NO_DISCARD
     ResultGeneric remove_io(EventHandleIO& handle);
 
+    /*
+        Persistent registration, EV_PERSIST | EV_ET on both directions, added 
+        once and kept by its owner across the operations. Readiness goes to the 
+        awaitable waiting in that direction, an edge without a waiter is kept 
+        for the next wait.
+
+        The owner resets the registration before closing the file descriptor.
+    */
+    JINX_NO_DISCARD
+    static
+    inline ResultGeneric wait_io(
+        Awaitable* awaitable,
+        const IOTypeRead& /*unused*/,
+        EventHandleRegistration& registration,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg)
+    {
+        return wait_io(awaitable, IOTypeRead::Flags, registration, io_handle, callback, arg);
+    }
+
+    JINX_NO_DISCARD
+    static
+    inline ResultGeneric wait_io(
+        Awaitable* awaitable,
+        const IOTypeWrite& /*unused*/,
+        EventHandleRegistration& registration,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg)
+    {
+        return wait_io(awaitable, IOTypeWrite::Flags, registration, io_handle, callback, arg);
+    }
+
+    JINX_NO_DISCARD
+    static
+    ResultGeneric wait_io(
+        Awaitable* awaitable,
+        unsigned int flags,
+        EventHandleRegistration& registration,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg);
+
+    JINX_NO_DISCARD
+    ResultGeneric wait_io(
+        unsigned int flags,
+        EventHandleRegistration& registration,
+        IOHandleNativeType io_handle,
+        EventCallbackIO callback,
+        void* arg);
+
+    // the registration stays, only the waits of arg are dropped
+    JINX_NO_DISCARD
+    static
+    ResultGeneric cancel_wait_io(Awaitable* awaitable, EventHandleRegistration& registration, void* arg) noexcept;
+
     // signal
 
     JINX_NO_DISCARD
@@ -254,98 +333,6 @@ public:
 
     JINX_NO_DISCARD
     ResultGeneric remove_timer(EventHandleTimer& timer);
-
-    // posix io
-    inline static IOResult connect(IOHandleNativeType io_handle, const struct sockaddr* addr, socklen_t len) noexcept {
-        IOResult result;
-        int err = 0;
-        do {
-            result._int = ::connect(io_handle, addr, len);
-            if (JINX_UNLIKELY(result._int == -1)) {
-                err = errno;
-                if (err == EINPROGRESS) {
-                    result._error = error::Error(err, posix::category_again());
-                } else {
-                    result._error = error::Error(err, posix::category_posix());
-                }
-            }
-        } while(err == EINTR);
-        return result;
-    }
-
-    inline static IOResult accept(IOHandleNativeType io_handle, struct sockaddr* addr, socklen_t* addrlen) noexcept {
-        return convert_to_asyncio_error_code(::accept(io_handle, addr, addrlen));
-    }
-
-    inline static IOResult read(IOHandleNativeType io_handle, SliceMutable& buffer) noexcept {
-        return convert_to_asyncio_error_code(::read(io_handle, buffer.data(), buffer.size()));
-    }
-
-    inline static IOResult write(IOHandleNativeType io_handle, SliceConst& buffer) noexcept {
-        return convert_to_asyncio_error_code(::write(io_handle, buffer.data(), buffer.size()));
-    }
-
-    inline static IOResult recv(IOHandleNativeType io_handle, SliceMutable& buffer, int flags) noexcept {
-        return convert_to_asyncio_error_code(::recv(io_handle, buffer.data(), buffer.size(), flags));
-    }
-
-    inline static IOResult send(IOHandleNativeType io_handle, SliceConst& buffer, int flags) noexcept {
-        return convert_to_asyncio_error_code(::send(io_handle, buffer.data(), buffer.size(), flags));
-    }
-
-    inline static IOResult recvfrom(IOHandleNativeType io_handle, SliceMutable& buffer, int flags,
-        struct sockaddr* address, socklen_t* address_len) 
-    {
-        return convert_to_asyncio_error_code(::recvfrom(io_handle, buffer.data(), buffer.size(), flags,
-            address, address_len));
-    }
-
-    inline static IOResult sendto(IOHandleNativeType io_handle, SliceConst& buffer, int flags,
-        const struct sockaddr* address, socklen_t address_len) noexcept
-    {
-        return convert_to_asyncio_error_code(::sendto(io_handle, buffer.data(), buffer.size(), flags,
-            address, address_len));
-    }
-
-    inline static IOResult readv(IOHandleNativeType io_handle, SliceMutable* buffers, int count) noexcept {
-        return convert_to_asyncio_error_code(::readv(io_handle, reinterpret_cast<struct iovec*>(buffers), count));
-    }
-
-    inline static IOResult writev(IOHandleNativeType io_handle, SliceConst* buffers, int count) noexcept {
-        return convert_to_asyncio_error_code(::writev(io_handle, reinterpret_cast<struct iovec*>(buffers), count));
-    }
-    
-    inline static IOResult recvmsg(IOHandleNativeType io_handle, struct msghdr* msg, int flags) noexcept {
-        return convert_to_asyncio_error_code(::recvmsg(io_handle, msg, flags));
-    }
-
-    inline static IOResult sendmsg(IOHandleNativeType io_handle, struct msghdr* msg, int flags) noexcept {
-        return convert_to_asyncio_error_code(::sendmsg(io_handle, msg, flags));
-    }
-
-    inline static IOResult shutdown(IOHandleNativeType io_handle, int how) noexcept {
-        return convert_to_asyncio_error_code(::shutdown(io_handle, how));
-    }
-
-private:
-
-    template<typename T>
-    inline static IOResult convert_to_asyncio_error_code(T res) noexcept {
-        IOResult result;
-        int err = 0;
-        do {
-            result.set_result(res);
-            if (JINX_UNLIKELY(res == -1)) {
-                err = errno;
-                if (err == EAGAIN or err == EWOULDBLOCK) {
-                    result._error = error::Error(err, posix::category_again());
-                } else {
-                    result._error = error::Error(err, posix::category_posix());
-                }
-            }
-        } while(err == EINTR);
-        return result;
-    }
 };
 
 class EventEngineLibevent::EventDataSimpleFunctional {
@@ -392,6 +379,23 @@ public:
     ~EventDataIO();
 };
 
+class EventEngineLibevent::EventDataRegistration {
+    friend class EventEngineLibevent;
+
+    struct event _event{};
+    IOHandleNativeType _io_handle;
+    // waiters and pending edges, read and write
+    EventCallbackIO _callbacks[2]{};
+    void* _args[2]{};
+    bool _ready[2]{};
+
+    static void callback(int io_handle, short event, void* arg);
+public:
+    explicit EventDataRegistration(IOHandleNativeType io_handle);
+    JINX_NO_COPY_NO_MOVE(EventDataRegistration);
+    ~EventDataRegistration();
+};
+
 struct EventEngineLibevent::EventRead : public EventEngineLibevent::EventDataIO {
     using EventEngineLibevent::EventDataIO::EventDataIO;
 };
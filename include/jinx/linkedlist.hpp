@@ -77,6 +77,8 @@ struct LinkedList {
         node->_next = &_end;
         if (node->_prev) {
             node->_prev->_next = node;
+        } else {
+            _head = node;
         }
         _end._prev = node;
 
@@ -164,7 +166,7 @@ public:
     };
 private:
     std::atomic<Node*> _head{nullptr};
-    size_t _size{0};
+    std::atomic<size_t> _size{0};
 public:
     LinkedListThreadSafe() = default;
 
@@ -208,6 +210,89 @@ public:
     }
 };
 
+/*
+    Intrusive multi-producer single-consumer FIFO queue (Dmitry Vyukov's algorithm).
+
+    `push` is wait-free and may be called from any thread.
+    `pop` must be called from a single consumer thread. It never compares pointers
+    for a CAS, so there is no ABA hazard when nodes are reused.
+
+    `pop` returns nullptr while a producer is between its exchange and its link store.
+    The producer always finishes by waking the consumer, so the node is picked up later.
+*/
+template<typename T>
+class LinkedListMPSC {
+public:
+    struct Node {
+        std::atomic<Node*> _next{nullptr};
+        Node() = default;
+    };
+private:
+    std::atomic<Node*> _back;
+    Node* _front;
+    Node _stub{};
+    std::atomic<size_t> _size{0};
+
+    void push_node(Node* node) noexcept {
+        node->_next.store(nullptr, std::memory_order_relaxed);
+        auto* prev = _back.exchange(node, std::memory_order_acq_rel);
+        prev->_next.store(node, std::memory_order_release);
+    }
+
+public:
+    LinkedListMPSC() : _back(&_stub), _front(&_stub) { }
+    ~LinkedListMPSC() = default;
+    JINX_NO_COPY_NO_MOVE(LinkedListMPSC);
+
+    void push(T* value) noexcept {
+        _size.fetch_add(1, std::memory_order_relaxed);
+        push_node(static_cast<Node*>(value));
+    }
+
+    T* pop() noexcept {
+        auto* front = _front;
+        auto* next = front->_next.load(std::memory_order_acquire);
+
+        if (front == &_stub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            _front = next;
+            front = next;
+            next = next->_next.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr) {
+            _front = next;
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            return static_cast<T*>(front);
+        }
+
+        if (front != _back.load(std::memory_order_acquire)) {
+            // a producer is linking a new node
+            return nullptr;
+        }
+
+        push_node(&_stub);
+
+        next = front->_next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            _front = next;
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            return static_cast<T*>(front);
+        }
+        return nullptr;
+    }
+
+    size_t get_size_unsafe() const noexcept {
+        return _size.load(std::memory_order_relaxed);
+    }
+
+    bool is_empty_unsafe() const noexcept {
+        return get_size_unsafe() == 0;
+    }
+};
+
 }
 
 #endif
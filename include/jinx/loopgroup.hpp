@@ -0,0 +1,305 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef __jinx_loopgroup_hpp__
+#define __jinx_loopgroup_hpp__
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <jinx/async.hpp>
+
+namespace jinx {
+
+/*
+    A group of loops, one thread, one event engine and one Loop per CPU.
+
+    Tasks are created on the calling thread and posted to the loop thread, see Loop::post.
+    A task must only touch its own loop after it was spawned.
+*/
+template<typename EventEngine>
+class LoopGroup {
+    class Worker;
+    class Keeper;
+    class Stopper;
+
+    std::vector<std::unique_ptr<Worker>> _workers{};
+    std::atomic<size_t> _next{0};
+    bool _pin_cpu{true};
+
+public:
+    explicit LoopGroup(size_t size = 0, bool pin_cpu = true)
+    : _pin_cpu(pin_cpu)
+    {
+        if (size == 0) {
+            size = std::thread::hardware_concurrency();
+        }
+        if (size == 0) {
+            size = 1;
+        }
+        for (size_t index = 0; index < size; ++index) {
+            _workers.emplace_back(new Worker(index));
+        }
+    }
+
+    ~LoopGroup() {
+        stop(true);
+        join();
+    }
+
+    JINX_NO_COPY_NO_MOVE(LoopGroup);
+
+    size_t size() const noexcept {
+        return _workers.size();
+    }
+
+    void start() {
+        for (auto& worker : _workers) {
+            worker->start(_pin_cpu);
+        }
+    }
+
+    // Stop accepting tasks. Loops exit after the remaining tasks are done or cancelled.
+    void stop(bool cancel_tasks = false) {
+        for (auto& worker : _workers) {
+            worker->stop(cancel_tasks);
+        }
+    }
+
+    void join() {
+        for (auto& worker : _workers) {
+            worker->join();
+        }
+    }
+
+    // Number of tasks attached to or pending on the loop
+    size_t get_load(size_t index) const noexcept {
+        return _workers[index]->get_load();
+    }
+
+    // The task is handed over to the loop thread, see Loop::post
+    JINX_NO_DISCARD
+    ResultGeneric task_create(size_t index, TaskPtr&& task) {
+        return _workers[index % _workers.size()]->post(std::move(task));
+    }
+
+    template<
+        typename T, 
+        typename TaskHeapType=typename T::template TaskHeapType<T>,
+        typename... Args>
+    JINX_NO_DISCARD
+    ResultGeneric task_new(size_t index, Args&&... args) {
+        auto task = TaskHeapType::template new_task<TaskHeapType>();
+
+        if (task == nullptr) {
+            return Failed_;
+        }
+
+        auto task_ptr = TaskPtr{task};
+
+        (*task)(std::forward<Args>(args)...);
+
+        return task_create(index, std::move(task_ptr));
+    }
+
+    template<
+        typename T, 
+        typename TaskHeapType=typename T::template TaskHeapType<T>,
+        typename... Args>
+    JINX_NO_DISCARD
+    ResultGeneric task_new_round_robin(Args&&... args) {
+        auto index = _next.fetch_add(1, std::memory_order_relaxed);
+        return task_new<T, TaskHeapType>(index, std::forward<Args>(args)...);
+    }
+
+    template<
+        typename T, 
+        typename TaskHeapType=typename T::template TaskHeapType<T>,
+        typename... Args>
+    JINX_NO_DISCARD
+    ResultGeneric task_new_least_loaded(Args&&... args) {
+        return task_new<T, TaskHeapType>(least_loaded(), std::forward<Args>(args)...);
+    }
+
+    size_t least_loaded() const noexcept {
+        size_t index = 0;
+        size_t load = SIZE_MAX;
+        for (size_t i = 0; i < _workers.size(); ++i) {
+            auto current = _workers[i]->get_load();
+            if (current < load) {
+                load = current;
+                index = i;
+            }
+        }
+        return index;
+    }
+};
+
+template<typename EventEngine>
+class LoopGroup<EventEngine>::Worker {
+    size_t _index;
+    EventEngine _event_engine{true};
+    Loop _loop{&_event_engine};
+    std::thread _thread{};
+
+    TaskPtr _keeper{};
+    std::mutex _mutex{};
+    bool _stop{false};
+    bool _started{false};
+
+public:
+    explicit Worker(size_t index) 
+    : _index(index) 
+    {
+        _keeper = _loop.task_new<Keeper>();
+    }
+
+    JINX_NO_COPY_NO_MOVE(Worker);
+
+    ~Worker() {
+        join();
+        if (not _started) {
+            _loop.exit();
+        }
+    }
+
+    // without the keeper
+    size_t get_load() const noexcept {
+        auto load = _loop.get_load();
+        return load > 0 ? load - 1 : 0;
+    }
+
+    void start(bool pin_cpu) {
+        _started = true;
+        _thread = std::thread{[this, pin_cpu]() {
+#ifdef __linux__
+            if (pin_cpu) {
+                pin(_index);
+            }
+#endif
+            _loop.run();
+        }};
+    }
+
+    void stop(bool cancel_tasks) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stop) {
+            return;
+        }
+        _stop = true;
+        typedef typename Stopper::template TaskHeapType<Stopper> TaskHeapType;
+        // without the Stopper the loop never ends, join would wait forever
+        auto* task = TaskHeapType::template new_task<TaskHeapType>();
+        if (task == nullptr) {
+            error::fatal("LoopGroup: failed to allocate the stopper task");
+        }
+        auto task_ptr = TaskPtr{task};
+        (*task)(_keeper, cancel_tasks);
+        if (_loop.post(std::move(task_ptr)).is(Failed_)) {
+            error::fatal("LoopGroup: failed to post the stopper task");
+        }
+    }
+
+    void join() {
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    JINX_NO_DISCARD
+    ResultGeneric post(TaskPtr&& task) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stop) {
+            return Failed_;
+        }
+        return _loop.post(std::move(task));
+    }
+
+private:
+#ifdef __linux__
+    static void pin(size_t index) {
+        auto cpus = std::thread::hardware_concurrency();
+        if (cpus == 0) {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cpus, &set);
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    }
+#endif
+};
+
+// Keeps the loop alive until the group stops
+template<typename EventEngine>
+class LoopGroup<EventEngine>::Keeper : public AsyncRoutine {
+public:
+    Keeper& operator ()() {
+        async_start(&Keeper::wait);
+        return *this;
+    }
+
+protected:
+    Async wait() {
+        return this->async_suspend();
+    }
+};
+
+template<typename EventEngine>
+class LoopGroup<EventEngine>::Stopper : public AsyncRoutine {
+    TaskPtr _keeper{};
+    bool _cancel{false};
+
+public:
+    Stopper& operator ()(TaskPtr& keeper, bool cancel) {
+        _keeper = keeper;
+        _cancel = cancel;
+        async_start(&Stopper::stop);
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        _keeper.reset();
+        AsyncRoutine::async_finalize();
+    }
+
+    Async stop() {
+        if (_cancel) {
+            return this->async_throw(ErrorAwaitable::ExitLoop);
+        }
+        async_cancel(_keeper) >> JINX_IGNORE_RESULT;
+        return this->async_return();
+    }
+};
+
+} // namespace jinx
+
+#endif
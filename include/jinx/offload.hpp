@@ -0,0 +1,294 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef __jinx_offload_hpp__
+#define __jinx_offload_hpp__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <jinx/async.hpp>
+#include <jinx/linkedlist.hpp>
+
+namespace jinx {
+namespace offload {
+
+enum class ErrorOffload {
+    NoError,
+    QueueFull,
+    Stopped,
+    WorkFailed,
+    OutOfMemory
+};
+
+JINX_ERROR_DEFINE(offload, ErrorOffload);
+
+namespace detail {
+
+struct Job : LinkedListMPSC<Job>::Node {
+    Job() = default;
+    JINX_NO_COPY_NO_MOVE(Job);
+    virtual ~Job() = default;
+
+    // in a worker thread
+    virtual void run() noexcept = 0;
+
+    // in the loop thread, resumes the waiting awaitable if any
+    virtual void deliver() noexcept = 0;
+
+    // in the loop thread, the awaitable is gone, the result is dropped
+    virtual void detach() noexcept = 0;
+};
+
+template<typename T>
+struct JobResult {
+    static void emplace(Optional<T>& result, std::function<T()>& work) {
+        result.emplace(work());
+    }
+};
+
+template<>
+struct JobResult<void> {
+    static void emplace(Optional<void>& result, std::function<void()>& work) {
+        work();
+        result.emplace();
+    }
+};
+
+} // namespace detail
+
+/*
+    A bounded pool of worker threads for blocking work: file reads, name resolution, compression.
+
+    The work runs in a worker, the result is delivered back in the loop thread, see AsyncOffload.
+    Completions are collected and posted to the loop as one task per batch, see Loop::post,
+    so the event engine of the loop must be thread safe.
+    The pool must be stopped or destroyed in the loop thread, before the loop.
+*/
+class Offload {
+    class Deliver;
+
+    Loop& _loop;
+    std::vector<std::thread> _workers{};
+
+    std::mutex _mutex{};
+    std::condition_variable _cond{};
+    std::deque<detail::Job*> _queue{};
+    // 0 is unlimited
+    size_t _queue_limit;
+    size_t _queue_peak{0};
+    bool _stopped{false};
+
+    LinkedListMPSC<detail::Job> _completions{};
+    // completions not delivered, the worker taking it from 0 posts a Deliver task
+    std::atomic<size_t> _pending{0};
+    // the last Deliver task posted, still in the loop while _pending is not 0
+    Deliver* _deliver{nullptr};
+
+    std::atomic<size_t> _running{0};
+    std::atomic<size_t> _completed{0};
+    size_t _delivered{0};
+    size_t _batches{0};
+
+public:
+    Offload(Loop& loop, size_t concurrency, size_t queue_limit = 0);
+    JINX_NO_COPY_NO_MOVE(Offload);
+    ~Offload();
+
+    /*
+        Finish the queued work, join the workers and deliver every result not delivered yet,
+        the waiting awaitables are resumed. Call it in the loop thread.
+    */
+    void stop();
+
+    /*
+        Queue a job, the pool owns it on success.
+        Failed when the queue is full or the pool is stopped, see ErrorOffload.
+    */
+    JINX_NO_DISCARD
+    ErrorOffload submit(detail::Job* job);
+
+    size_t concurrency() const noexcept {
+        return _workers.size();
+    }
+
+    size_t queue_limit() const noexcept {
+        return _queue_limit;
+    }
+
+    // jobs waiting for a worker
+    size_t queued() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _queue.size();
+    }
+
+    // the deepest the queue has been
+    size_t queue_peak() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _queue_peak;
+    }
+
+    // jobs in a worker
+    size_t running() const noexcept {
+        return _running.load(std::memory_order_relaxed);
+    }
+
+    // jobs done by the workers
+    size_t completed() const noexcept {
+        return _completed.load(std::memory_order_relaxed);
+    }
+
+    // jobs handed back in the loop thread, and the number of batches they took
+    size_t delivered() const noexcept {
+        return _delivered;
+    }
+
+    size_t batches() const noexcept {
+        return _batches;
+    }
+
+private:
+    void work();
+    void complete(detail::Job* job);
+    void deliver();
+};
+
+/*
+    Run work in an Offload pool, the result is taken with get_result in the loop thread.
+    Raises ErrorOffload::QueueFull, ErrorOffload::Stopped or ErrorOffload::OutOfMemory if the work is not accepted,
+    and ErrorOffload::WorkFailed if it threw.
+    Cancelling the waiting task drops the result, the work already queued still runs.
+*/
+template<typename T>
+class AsyncOffload : public AsyncFuture<T> {
+    typedef AsyncFuture<T> BaseType;
+
+    class Job : public detail::Job {
+        AsyncOffload* _future;
+        std::function<T()> _work;
+        Optional<T> _result{};
+
+    public:
+        Job(AsyncOffload* future, std::function<T()>&& work)
+        : _future(future), _work(std::move(work)) { }
+
+        void run() noexcept override {
+#if defined(__cpp_exceptions) && __cpp_exceptions
+try {
+#endif
+            detail::JobResult<T>::emplace(_result, _work);
+#if defined(__cpp_exceptions) && __cpp_exceptions
+} catch (...) {
+            _result.reset();
+}
+#endif
+            // captures are released in the worker
+            _work = nullptr;
+        }
+
+        void deliver() noexcept override {
+            if (_future == nullptr) {
+                return;
+            }
+            auto* future = _future;
+            future->_job = nullptr;
+            if (_result.empty()) {
+                // raised in the next poll
+                future->_failed = true;
+                future->async_resume() >> JINX_IGNORE_RESULT;
+                return;
+            }
+            future->emplace_result(_result.release()) >> JINX_IGNORE_RESULT;
+        }
+
+        void detach() noexcept override {
+            _future = nullptr;
+        }
+    };
+
+    Offload* _pool{nullptr};
+    std::function<T()> _work{};
+    // submitted and not delivered
+    Job* _job{nullptr};
+    // delivered without a result
+    bool _failed{false};
+
+public:
+    AsyncOffload() = default;
+    JINX_NO_COPY_NO_MOVE(AsyncOffload);
+    ~AsyncOffload() override {
+        if (_job != nullptr) {
+            _job->detach();
+        }
+    }
+
+    AsyncOffload& operator ()(Offload& pool, std::function<T()> work) {
+        this->reset();
+        _failed = false;
+        _pool = &pool;
+        _work = std::move(work);
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        if (_job != nullptr) {
+            _job->detach();
+            _job = nullptr;
+        }
+        _work = nullptr;
+        BaseType::async_finalize();
+    }
+
+    Async async_poll() override {
+        if (_work) {
+            auto* job = new(std::nothrow) Job(this, std::move(_work));
+            _work = nullptr;
+            if (job == nullptr) {
+                return this->async_throw(ErrorOffload::OutOfMemory);
+            }
+            auto error = _pool->submit(job);
+            if (error != ErrorOffload::NoError) {
+                delete job;
+                return this->async_throw(error);
+            }
+            _job = job;
+        }
+        if (_failed) {
+            _failed = false;
+            return this->async_throw(ErrorOffload::WorkFailed);
+        }
+        return BaseType::async_poll();
+    }
+};
+
+} // namespace offload
+} // namespace jinx
+
+#endif
@@ -25,12 +25,26 @@ SOFTWARE.
 #define __posix_hpp__
 
 #include <cerrno>
+#include <cstdint>
 #include <cstring>
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
+#if defined(__linux__)
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/sendfile.h>
+#endif
 
 #include <jinx/slice.hpp>
 #include <jinx/macros.hpp>
@@ -137,6 +151,15 @@ enum class AddressStatus {
     UnsupportedAddressFamily
 };
 
+/*
+    Counts the closes of a file descriptor number, IOHandle counts its own.
+    Event engines keeping registrations across operations compare it to find reused descriptors,
+    closing one descriptor leaves the registrations of the others valid.
+    Call notify_close(fd) after closing a registered descriptor without IOHandle.
+*/
+uint64_t get_close_epoch(int filedesc) noexcept;
+void notify_close(int filedesc) noexcept;
+
 struct IOHandle {
     typedef int NativeHandleType;
 protected:
@@ -177,6 +200,263 @@ public:
     bool is_valid() const { return _io_handle != -1; }
 };
 
+enum class IOOpcode : unsigned char {
+    None,
+    Read,
+    Write,
+    ReadV,
+    WriteV,
+    Recv,
+    Send,
+    RecvMsg,
+    SendMsg,
+    Accept
+};
+
+/*
+    An I/O operation described for completion based engines.
+    _data is the buffer, the iovec array, the msghdr or the address, 
+    _size is the number of bytes, of iovecs or the address length.
+*/
+struct IORequest {
+    IOOpcode _opcode{IOOpcode::None};
+    int _io_handle{-1};
+    const void* _data{nullptr};
+    unsigned long _size{0};
+    int _flags{0};
+    socklen_t* _address_len{nullptr};
+
+    IORequest() = default;
+    IORequest(IOOpcode opcode, int io_handle, const void* data, unsigned long size, 
+        int flags = 0, socklen_t* address_len = nullptr) noexcept
+    : _opcode(opcode),
+      _io_handle(io_handle),
+      _data(data),
+      _size(size),
+      _flags(flags),
+      _address_len(address_len)
+    { }
+};
+
+#if defined(__linux__)
+/*
+    Runs a call writing to a socket or a pipe that has no MSG_NOSIGNAL, e.g. sendfile.
+    SIGPIPE is blocked in the thread meanwhile and the one raised by the call is taken back,
+    a closed peer fails the call with EPIPE alone.
+*/
+template<typename Call>
+inline long call_without_sigpipe(Call&& call) noexcept {
+    sigset_t pipe_set{};
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    sigset_t saved{};
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &saved);
+
+    // raised before, left to its owner
+    sigset_t pending{};
+    sigpending(&pending);
+    const bool was_pending = sigismember(&pending, SIGPIPE) == 1;
+
+    const long result = call();
+    if (result == -1 and errno == EPIPE and not was_pending) {
+        struct timespec zero{};
+        while (sigtimedwait(&pipe_set, nullptr, &zero) == -1 and errno == EINTR) { }
+        errno = EPIPE;
+    }
+    pthread_sigmask(SIG_SETMASK, &saved, nullptr);
+    return result;
+}
+#endif
+
+// Non-blocking I/O calls of the posix event engines, errors of EAGAIN are in category_again
+struct IOOperations {
+    typedef int NativeHandleType;
+
+    // readiness engines have no completion path, AsyncIOCommon waits for readiness
+    struct EventHandleCompletion { };
+
+    template<typename A>
+    JINX_NO_DISCARD
+    inline static ResultGeneric submit_io(
+        A* /*unused*/, 
+        EventHandleCompletion& /*unused*/, 
+        const IORequest& /*unused*/, 
+        bool /*unused*/, 
+        EventCallbackComplete /*unused*/, 
+        void* /*unused*/) noexcept 
+    {
+        return Failed_;
+    }
+
+    template<typename A>
+    JINX_NO_DISCARD
+    inline static ResultGeneric cancel_io(A* /*unused*/, EventHandleCompletion& /*unused*/) noexcept {
+        return Successful_;
+    }
+
+    template<typename A>
+    JINX_NO_DISCARD
+    inline static ResultGeneric interrupt_io(A* /*unused*/, EventHandleCompletion& /*unused*/) noexcept {
+        return Failed_;
+    }
+
+    // engines without persistent registrations, AsyncIOCommon adds an event per wait
+    struct EventHandleRegistration { 
+        void reset() noexcept { }
+    };
+
+    template<typename A, typename IOType>
+    JINX_NO_DISCARD
+    inline static ResultGeneric wait_io(
+        A* /*unused*/, 
+        const IOType& /*unused*/, 
+        EventHandleRegistration& /*unused*/, 
+        NativeHandleType /*unused*/, 
+        EventCallbackIO /*unused*/, 
+        void* /*unused*/) noexcept 
+    {
+        return Failed_;
+    }
+
+    template<typename A>
+    JINX_NO_DISCARD
+    inline static ResultGeneric cancel_wait_io(A* /*unused*/, EventHandleRegistration& /*unused*/, void* /*unused*/) noexcept {
+        return Successful_;
+    }
+
+    inline static IOResult connect(NativeHandleType io_handle, const struct sockaddr* addr, socklen_t len) noexcept {
+        IOResult result;
+        int err = 0;
+        do {
+            result._int = ::connect(io_handle, addr, len);
+            if (JINX_UNLIKELY(result._int == -1)) {
+                err = errno;
+                if (err == EINPROGRESS) {
+                    result._error = error::Error(err, category_again());
+                } else {
+                    result._error = error::Error(err, category_posix());
+                }
+            }
+        } while(err == EINTR);
+        return result;
+    }
+
+    inline static IOResult accept(NativeHandleType io_handle, struct sockaddr* addr, socklen_t* addrlen) noexcept {
+        return convert_to_asyncio_error_code(::accept(io_handle, addr, addrlen));
+    }
+
+    // the accepted socket is non-blocking and close-on-exec
+    inline static IOResult accept_non_blocking(NativeHandleType io_handle, struct sockaddr* addr, socklen_t* addrlen) noexcept {
+#if defined(__linux__)
+        return convert_to_asyncio_error_code(::accept4(io_handle, addr, addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC));
+#else
+        auto result = convert_to_asyncio_error_code(::accept(io_handle, addr, addrlen));
+        if (not result._error) {
+            ::fcntl(result._fd, F_SETFL, ::fcntl(result._fd, F_GETFL) | O_NONBLOCK);
+            ::fcntl(result._fd, F_SETFD, FD_CLOEXEC);
+        }
+        return result;
+#endif
+    }
+
+    inline static IOResult read(NativeHandleType io_handle, SliceMutable& buffer) noexcept {
+        return convert_to_asyncio_error_code(::read(io_handle, buffer.data(), buffer.size()));
+    }
+
+    inline static IOResult write(NativeHandleType io_handle, SliceConst& buffer) noexcept {
+        return convert_to_asyncio_error_code(::write(io_handle, buffer.data(), buffer.size()));
+    }
+
+    inline static IOResult recv(NativeHandleType io_handle, SliceMutable& buffer, int flags) noexcept {
+        return convert_to_asyncio_error_code(::recv(io_handle, buffer.data(), buffer.size(), flags));
+    }
+
+    inline static IOResult send(NativeHandleType io_handle, SliceConst& buffer, int flags) noexcept {
+        return convert_to_asyncio_error_code(::send(io_handle, buffer.data(), buffer.size(), flags));
+    }
+
+    inline static IOResult recvfrom(NativeHandleType io_handle, SliceMutable& buffer, int flags,
+        struct sockaddr* address, socklen_t* address_len) 
+    {
+        return convert_to_asyncio_error_code(::recvfrom(io_handle, buffer.data(), buffer.size(), flags,
+            address, address_len));
+    }
+
+    inline static IOResult sendto(NativeHandleType io_handle, SliceConst& buffer, int flags,
+        const struct sockaddr* address, socklen_t address_len) noexcept
+    {
+        return convert_to_asyncio_error_code(::sendto(io_handle, buffer.data(), buffer.size(), flags,
+            address, address_len));
+    }
+
+    inline static IOResult readv(NativeHandleType io_handle, SliceMutable* buffers, int count) noexcept {
+        return convert_to_asyncio_error_code(::readv(io_handle, reinterpret_cast<struct iovec*>(buffers), count));
+    }
+
+    inline static IOResult writev(NativeHandleType io_handle, SliceConst* buffers, int count) noexcept {
+        return convert_to_asyncio_error_code(::writev(io_handle, reinterpret_cast<struct iovec*>(buffers), count));
+    }
+    
+    inline static IOResult recvmsg(NativeHandleType io_handle, struct msghdr* msg, int flags) noexcept {
+        return convert_to_asyncio_error_code(::recvmsg(io_handle, msg, flags));
+    }
+
+    inline static IOResult sendmsg(NativeHandleType io_handle, struct msghdr* msg, int flags) noexcept {
+        return convert_to_asyncio_error_code(::sendmsg(io_handle, msg, flags));
+    }
+
+#if defined(__linux__)
+    // the number of messages, msg_len of each is set
+    inline static IOResult recvmmsg(NativeHandleType io_handle, struct mmsghdr* msgs, unsigned int count, int flags) noexcept {
+        return convert_to_asyncio_error_code(static_cast<long>(::recvmmsg(io_handle, msgs, count, flags, nullptr)));
+    }
+
+    inline static IOResult sendmmsg(NativeHandleType io_handle, struct mmsghdr* msgs, unsigned int count, int flags) noexcept {
+        return convert_to_asyncio_error_code(static_cast<long>(::sendmmsg(io_handle, msgs, count, flags)));
+    }
+
+    // from offset of the file or its position if offset is nullptr, the offset is moved
+    inline static IOResult sendfile(NativeHandleType io_handle, NativeHandleType file_handle, off_t* offset, size_t count) noexcept {
+        return convert_to_asyncio_error_code(call_without_sigpipe([&]() {
+            return static_cast<long>(::sendfile(io_handle, file_handle, offset, count));
+        }));
+    }
+
+    // one of the handles is a pipe
+    inline static IOResult splice(NativeHandleType in_handle, loff_t* in_offset, 
+        NativeHandleType io_handle, loff_t* offset, size_t count, unsigned int flags) noexcept 
+    {
+        return convert_to_asyncio_error_code(call_without_sigpipe([&]() {
+            return static_cast<long>(::splice(in_handle, in_offset, io_handle, offset, count, flags));
+        }));
+    }
+#endif
+
+    inline static IOResult shutdown(NativeHandleType io_handle, int how) noexcept {
+        return convert_to_asyncio_error_code(::shutdown(io_handle, how));
+    }
+
+private:
+
+    template<typename T>
+    inline static IOResult convert_to_asyncio_error_code(T res) noexcept {
+        IOResult result;
+        int err = 0;
+        do {
+            result.set_result(res);
+            if (JINX_UNLIKELY(res == -1)) {
+                err = errno;
+                if (err == EAGAIN or err == EWOULDBLOCK) {
+                    result._error = error::Error(err, category_again());
+                } else {
+                    result._error = error::Error(err, category_posix());
+                }
+            }
+        } while(err == EINTR);
+        return result;
+    }
+};
+
 template<typename Family>
 class AddressChecker
 {
@@ -502,6 +782,11 @@ public:
 
     int set_keep_alive(bool enable);
 
+    // UDP segmentation offload, datagrams of size bytes for every send, 0 disables it
+    int set_udp_segment(int size);
+    // UDP receive offload, coalesced datagrams, see datagram::RecvSegments
+    int set_udp_gro(bool enable);
+
     Result<int> get_socket_name(SocketAddress& addr);
     Result<int> get_peer_name(SocketAddress& addr);
 
@@ -554,6 +839,9 @@ public:
         *this = PosixConnect{};
     }
 
+    // connects always wait for readiness, the first call starts them
+    IORequest get_request() const noexcept { return {}; }
+
     inline IOResult do_io() {
         if (_connected) {
             int err = 0;
@@ -605,11 +893,72 @@ public:
         *this = PosixAccept{};
     }
 
+    IORequest get_request() const noexcept {
+        return {IOOpcode::Accept, _io_handle, _address, 0, 0, _address_len};
+    }
+
     inline IOResult do_io() {
         return EventEngine::accept(_io_handle, _address, _address_len);
     }
 };
 
+/*
+    Accept up to capacity pending connections per readiness event, the result 
+    is the number of sockets stored in handles. The sockets are non-blocking 
+    and close-on-exec, owned by the caller.
+*/
+template<typename EventEngine>
+class PosixAcceptBatch
+{
+public:
+    typedef EventEngine EventEngineType;
+    typedef typename EventEngine::IOHandleNativeType IOHandleNativeType;
+
+private:
+    IOHandleNativeType _io_handle{-1};
+    IOHandleNativeType* _handles{nullptr};
+    size_t _capacity{0};
+
+public:
+    typedef long IOResultType;
+    typedef typename EventEngine::IOTypeRead IOType;
+    constexpr static const char* IOTypeName = "accept_batch";
+
+    PosixAcceptBatch() = default;
+    PosixAcceptBatch(IOHandleNativeType io_handle, IOHandleNativeType* handles, size_t capacity)
+    : _io_handle(io_handle),
+      _handles(handles),
+      _capacity(capacity)
+    { }
+
+    IOHandleNativeType native_handle() const { return _io_handle; }
+
+    void reset() noexcept {
+        *this = PosixAcceptBatch{};
+    }
+
+    // never submitted, a batch is always drained on readiness
+    IORequest get_request() const noexcept {
+        return {};
+    }
+
+    inline IOResult do_io() {
+        long count = 0;
+        while (static_cast<size_t>(count) < _capacity) {
+            auto result = EventEngine::accept_non_blocking(_io_handle, nullptr, nullptr);
+            if (result._error) {
+                // the error is raised by the next batch
+                if (count == 0) {
+                    return result;
+                }
+                break;
+            }
+            _handles[count++] = result._fd;
+        }
+        return IOResult{{}, count};
+    }
+};
+
 template<typename EventEngine>
 class PosixSendTo
 {
@@ -644,6 +993,11 @@ public:
         *this = PosixSendTo{};
     }
 
+    // no completion path, the address would have to outlive the call
+    IORequest get_request() const noexcept {
+        return {};
+    }
+
     inline IOResult do_io() {
         return EventEngine::sendto(_io_handle, _buffer, _flags, _address, _len);
     }
@@ -688,6 +1042,11 @@ public:
         *this = PosixRecvFrom{};
     }
 
+    // no completion path, the address is committed after the call
+    IORequest get_request() const noexcept {
+        return {};
+    }
+
     inline IOResult do_io() {
         auto result = EventEngine::recvfrom(_io_handle, _buffer, _flags, _address.data(), _address.capcity());
         if (not result._error) {
@@ -727,6 +1086,10 @@ public:
         *this = PosixRecv{};
     }
 
+    IORequest get_request() const noexcept {
+        return {IOOpcode::Recv, _io_handle, _buffer.data(), _buffer.size(), _flags};
+    }
+
     inline IOResult do_io() {
         return EventEngine::recv(_io_handle, _buffer, _flags);
     }
@@ -762,6 +1125,10 @@ public:
         *this = PosixSend{};
     }
 
+    IORequest get_request() const noexcept {
+        return {IOOpcode::Send, _io_handle, _buffer.data(), _buffer.size(), _flags};
+    }
+
     inline IOResult do_io() {
         return EventEngine::send(_io_handle, _buffer, _flags);
     }
@@ -795,6 +1162,10 @@ public:
         *this = PosixRead{};
     }
 
+    IORequest get_request() const noexcept {
+        return {IOOpcode::Read, _io_handle, _buffer.data(), _buffer.size()};
+    }
+
     inline IOResult do_io() {
         return EventEngine::read(_io_handle, _buffer);
     }
@@ -828,6 +1199,10 @@ public:
         *this = PosixWrite{};
     }
 
+    IORequest get_request() const noexcept {
+        return {IOOpcode::Write, _io_handle, _buffer.data(), _buffer.size()};
+    }
+
     inline IOResult do_io() {
         return EventEngine::write(_io_handle, _buffer);
     }
@@ -867,6 +1242,10 @@ public:
         *this = PosixReadV{};
     }
 
+    IORequest get_request() const noexcept {
+        return {IOOpcode::ReadV, io_handle, _buffers, static_cast<unsigned long>(_count)};
+    }
+
     inline IOResult do_io() {
         return EventEngine::readv(io_handle, _buffers, _count);
     }
@@ -906,6 +1285,10 @@ public:
         *this = PosixWriteV{};
     }
 
+    IORequest get_request() const noexcept {
+        return {IOOpcode::WriteV, _io_handle, _buffers, static_cast<unsigned long>(_count)};
+    }
+
     inline IOResult do_io() {
         return EventEngine::writev(_io_handle, _buffers, _count);
     }
@@ -941,6 +1324,10 @@ public:
         *this = PosixRecvMsg{};
     }
 
+    IORequest get_request() const noexcept {
+        return {IOOpcode::RecvMsg, _io_handle, _msg, 0, _flags};
+    }
+
     inline IOResult do_io() {
         return EventEngine::recvmsg(_io_handle, _msg, _flags);
     }
@@ -976,11 +1363,241 @@ public:
         *this = PosixSendMsg{};
     }
 
+    IORequest get_request() const noexcept {
+        return {IOOpcode::SendMsg, _io_handle, _msg, 0, _flags};
+    }
+
     inline IOResult do_io() {
         return EventEngine::sendmsg(_io_handle, _msg, _flags);
     }
 };
 
+#if defined(__linux__)
+template<typename EventEngine>
+class PosixRecvMMsg
+{
+public:
+    typedef EventEngine EventEngineType;
+    typedef typename EventEngine::IOHandleNativeType IOHandleNativeType;
+
+private:
+    IOHandleNativeType _io_handle{-1};
+    struct mmsghdr* _msgs{nullptr};
+    unsigned int _count{0};
+    int _flags{0};
+
+public:
+    typedef long IOResultType;
+    typedef typename EventEngine::IOTypeRead IOType;
+    constexpr static const char* IOTypeName = "recvmmsg";
+
+    PosixRecvMMsg() = default;
+    PosixRecvMMsg(IOHandleNativeType io_handle, struct mmsghdr* msgs, unsigned int count, int flags)
+    : _io_handle(io_handle),
+      _msgs(msgs),
+      _count(count),
+      _flags(flags)
+    { }
+
+    IOHandleNativeType native_handle() const { return _io_handle; }
+
+    void reset() noexcept {
+        *this = PosixRecvMMsg{};
+    }
+
+    // no batched opcode for completion based engines
+    IORequest get_request() const noexcept {
+        return {};
+    }
+
+    inline IOResult do_io() {
+        return EventEngine::recvmmsg(_io_handle, _msgs, _count, _flags);
+    }
+};
+
+template<typename EventEngine>
+class PosixSendMMsg
+{
+public:
+    typedef EventEngine EventEngineType;
+    typedef typename EventEngine::IOHandleNativeType IOHandleNativeType;
+
+private:
+    IOHandleNativeType _io_handle{-1};
+    struct mmsghdr* _msgs{nullptr};
+    unsigned int _count{0};
+    int _flags{0};
+
+public:
+    typedef long IOResultType;
+    typedef typename EventEngine::IOTypeWrite IOType;
+    constexpr static const char* IOTypeName = "sendmmsg";
+
+    PosixSendMMsg() = default;
+    PosixSendMMsg(IOHandleNativeType io_handle, struct mmsghdr* msgs, unsigned int count, int flags)
+    : _io_handle(io_handle),
+      _msgs(msgs),
+      _count(count),
+      _flags(flags)
+    { }
+
+    IOHandleNativeType native_handle() const { return _io_handle; }
+
+    void reset() noexcept {
+        *this = PosixSendMMsg{};
+    }
+
+    // no batched opcode for completion based engines
+    IORequest get_request() const noexcept {
+        return {};
+    }
+
+    inline IOResult do_io() {
+        return EventEngine::sendmmsg(_io_handle, _msgs, _count, _flags);
+    }
+};
+
+template<typename EventEngine>
+class PosixSendFile
+{
+public:
+    typedef EventEngine EventEngineType;
+    typedef typename EventEngine::IOHandleNativeType IOHandleNativeType;
+
+private:
+    IOHandleNativeType _io_handle{-1};
+    IOHandleNativeType _file_handle{-1};
+    off_t* _offset{nullptr};
+    size_t _count{0};
+
+public:
+    typedef long IOResultType;
+    typedef typename EventEngine::IOTypeWrite IOType;
+    constexpr static const char* IOTypeName = "sendfile";
+
+    PosixSendFile() = default;
+    PosixSendFile(IOHandleNativeType io_handle, IOHandleNativeType file_handle, off_t* offset, size_t count)
+    : _io_handle(io_handle),
+      _file_handle(file_handle),
+      _offset(offset),
+      _count(count)
+    { }
+
+    IOHandleNativeType native_handle() const { return _io_handle; }
+
+    size_t size() const noexcept { return _count; }
+
+    // the rest of a partial transfer, the kernel moved the offset
+    PosixSendFile advance(size_t size) const noexcept {
+        auto rest = *this;
+        rest._count -= size;
+        return rest;
+    }
+
+    void reset() noexcept {
+        *this = PosixSendFile{};
+    }
+
+    // no sendfile opcode for completion based engines
+    IORequest get_request() const noexcept {
+        return {};
+    }
+
+    inline IOResult do_io() {
+        return EventEngine::sendfile(_io_handle, _file_handle, _offset, _count);
+    }
+};
+
+/*
+    Waits for the side that blocked: the input to be readable if it has nothing to read, 
+    e.g. a socket or a pipe not filled yet, otherwise the output to be writable.
+*/
+template<typename EventEngine>
+class PosixSplice
+{
+public:
+    typedef EventEngine EventEngineType;
+    typedef typename EventEngine::IOHandleNativeType IOHandleNativeType;
+
+private:
+    IOHandleNativeType _in_handle{-1};
+    loff_t* _in_offset{nullptr};
+    IOHandleNativeType _io_handle{-1};
+    loff_t* _offset{nullptr};
+    size_t _count{0};
+    unsigned int _flags{0};
+
+public:
+    typedef long IOResultType;
+    typedef typename EventEngine::IOTypeWrite IOType;
+    constexpr static const char* IOTypeName = "splice";
+
+    PosixSplice() = default;
+    PosixSplice(IOHandleNativeType in_handle, loff_t* in_offset, 
+        IOHandleNativeType io_handle, loff_t* offset, size_t count, unsigned int flags)
+    : _in_handle(in_handle),
+      _in_offset(in_offset),
+      _io_handle(io_handle),
+      _offset(offset),
+      _count(count),
+      _flags(flags | SPLICE_F_NONBLOCK)
+    { }
+
+    IOHandleNativeType native_handle() const { return _io_handle; }
+
+    size_t size() const noexcept { return _count; }
+
+    // the rest of a partial transfer, the kernel moved the offsets
+    PosixSplice advance(size_t size) const noexcept {
+        auto rest = *this;
+        rest._count -= size;
+        return rest;
+    }
+
+    void reset() noexcept {
+        *this = PosixSplice{};
+    }
+
+    // no splice opcode for completion based engines
+    IORequest get_request() const noexcept {
+        return {};
+    }
+
+    inline IOResult do_io() {
+        return EventEngine::splice(_in_handle, _in_offset, _io_handle, _offset, _count, _flags);
+    }
+
+    IOHandleNativeType input_handle() const { return _in_handle; }
+
+    // after EAGAIN, files are always readable
+    bool input_empty() const noexcept {
+        struct pollfd fds{_in_handle, POLLIN, 0};
+        return ::poll(&fds, 1, 0) == 0;
+    }
+};
+
+template<typename EventEngine>
+inline bool io_waits_for_input(const PosixSplice<EventEngine>& io_impl) noexcept {
+    return io_impl.input_empty();
+}
+
+template<typename EventEngine>
+inline typename EventEngine::IOHandleNativeType io_input_handle(const PosixSplice<EventEngine>& io_impl) noexcept {
+    return io_impl.input_handle();
+}
+#endif
+
+// the operations with two handles wait on the input when it's the side that blocked, see PosixSplice
+template<typename IOImpl>
+inline bool io_waits_for_input(const IOImpl& /*unused*/) noexcept {
+    return false;
+}
+
+template<typename IOImpl>
+inline typename IOImpl::IOHandleNativeType io_input_handle(const IOImpl& io_impl) noexcept {
+    return io_impl.native_handle();
+}
+
 template<typename IOImpl>
 class AsyncIOCommon
 : public AsyncFunction<typename IOImpl::IOResultType>
@@ -992,12 +1609,38 @@ public:
 private:
     IOImpl _io_impl{};
     typename EventEngineType::EventHandleIO _handle{};
+    typename EventEngineType::EventHandleCompletion _completion{};
+    typename EventEngineType::EventHandleRegistration* _registration{nullptr};
+    error::Error _completion_error{};
+
+    // armed on the first wait of the operation, 0 is no deadline
+    TimerWheel::Entry _deadline{};
+    TimerWheel::Clock::duration _timeout{0};
+    // the deadline interrupted a submitted operation, its completion is awaited
+    bool _interrupted{false};
 
 public:
     AsyncIOCommon() = default;
     JINX_NO_COPY_NO_MOVE(AsyncIOCommon);
     ~AsyncIOCommon() override = default;
 
+    // persistent registration of the file descriptor, owned by its socket or stream
+    void set_registration(typename EventEngineType::EventHandleRegistration* registration) noexcept {
+        _registration = registration;
+    }
+
+    /*
+        Raise posix::ErrorPosix::TimedOut once an operation waited for the timeout.
+        An operation submitted to a completion engine is interrupted first and 
+        returns its result if it completed meanwhile.
+        Kept for the next operations, 0 disables it.
+    */
+    template<typename Rep, typename Period>
+    AsyncIOCommon& set_timeout(const std::chrono::duration<Rep, Period>& timeout) noexcept {
+        _timeout = std::chrono::duration_cast<TimerWheel::Clock::duration>(timeout);
+        return *this;
+    }
+
     template<typename... Args>
     AsyncIOCommon& operator()(Args&&... args) 
     {
@@ -1010,11 +1653,24 @@ public:
     typename IOImpl::IOHandleNativeType native_handle() const { return _io_impl.native_handle(); }
 
 protected:
-    void async_finalize() noexcept override {
+    const IOImpl& io_impl() const noexcept { return _io_impl; }
+
+    void cancel_wait() noexcept {
         if (not _handle.empty()) {
             EventEngineType::remove_io(this, _handle) >> JINX_IGNORE_RESULT;
             _handle.reset();
         }
+        if (_registration != nullptr) {
+            EventEngineType::cancel_wait_io(this, *_registration, this) >> JINX_IGNORE_RESULT;
+        }
+        EventEngineType::cancel_io(this, _completion) >> JINX_IGNORE_RESULT;
+    }
+
+    void async_finalize() noexcept override {
+        _deadline.cancel();
+        cancel_wait();
+        _completion_error = {};
+        _interrupted = false;
         _io_impl.reset();
         BaseType::async_finalize();
     }
@@ -1035,6 +1691,17 @@ protected:
             return this->async_return();
         }
 
+        if (JINX_UNLIKELY(_completion_error)) {
+            auto error = _completion_error;
+            _completion_error = {};
+            return BaseType::async_throw(error);
+        }
+
+        // completion based engines may take the operation before the call
+        if (submit(false)) {
+            return async_wait();
+        }
+
         auto result = _io_impl.do_io();
         if (not result._error) {
             this->emplace_result((typename IOImpl::IOResultType)result);
@@ -1042,6 +1709,32 @@ protected:
         }
         
         if (result._error.category() == category_again()) {
+            if (submit(true)) {
+                return async_wait();
+            }
+            if (io_waits_for_input(_io_impl)) {
+                if (EventEngineType::add_io(
+                        this,
+                        typename EventEngineType::IOTypeRead{}, 
+                        _handle, 
+                        io_input_handle(_io_impl), 
+                        &AsyncIOCommon<IOImpl>::io_callback, 
+                        this).is(Failed_))
+                {
+                    return this->async_throw(ErrorEventEngine::FailedToRegisterIOEvent);
+                }
+                return async_wait();
+            }
+            if (_registration != nullptr and EventEngineType::wait_io(
+                    this,
+                    typename IOImpl::IOType{},
+                    *_registration,
+                    _io_impl.native_handle(),
+                    &AsyncIOCommon<IOImpl>::io_callback,
+                    this).is(Successful_))
+            {
+                return async_wait();
+            }
             if (EventEngineType::add_io(
                     this,
                     typename IOImpl::IOType{}, 
@@ -1052,15 +1745,106 @@ protected:
             {
                 return this->async_throw(ErrorEventEngine::FailedToRegisterIOEvent);
             }
-            return this->async_suspend();
+            return async_wait();
         }
         return BaseType::async_throw(result._error);
     }
 
+    Async async_wait() {
+        if (_timeout.count() != 0 and not _deadline.is_pending()) {
+            auto& timer_wheel = EventEngineAbstract::get_timer_wheel<EventEngineType>(this);
+            if (timer_wheel.add(_deadline, _timeout, &AsyncIOCommon<IOImpl>::deadline_callback, this).is(Failed_)) {
+                return this->async_throw(ErrorEventEngine::FailedToRegisterTimerEvent);
+            }
+        }
+        return this->async_suspend();
+    }
+
+    static void deadline_callback(void* data) {
+        auto* self = reinterpret_cast<AsyncIOCommon<IOImpl>*>(data);
+        // completed, waiting for its task
+        if (not self->empty() or self->_completion_error or self->_interrupted) {
+            return;
+        }
+        // the kernel may be using the buffers, io_complete resumes with the result or the timeout
+        if (EventEngineType::interrupt_io(self, self->_completion).is(Successful_)) {
+            self->_interrupted = true;
+            return;
+        }
+        self->cancel_wait();
+        self->_completion_error = make_error(ErrorPosix::TimedOut);
+        self->async_resume() >> JINX_IGNORE_RESULT;
+    }
+
     static void io_callback(unsigned int flags, const error::Error& error, void* data) {
         auto* self = reinterpret_cast<AsyncIOCommon<IOImpl>*>(data);
         self->async_resume(error) >> JINX_IGNORE_RESULT;
     }
+
+    // falls back to readiness if the operation is not submitted
+    bool submit(bool would_block) {
+        return EventEngineType::submit_io(
+            this, 
+            _completion, 
+            _io_impl.get_request(), 
+            would_block, 
+            &AsyncIOCommon<IOImpl>::io_complete, 
+            this).is(Successful_);
+    }
+
+    static void io_complete(long result, void* data) {
+        auto* self = reinterpret_cast<AsyncIOCommon<IOImpl>*>(data);
+        if (result == -ECANCELED and self->_interrupted) {
+            self->_completion_error = make_error(ErrorPosix::TimedOut);
+        } else if (result < 0) {
+            self->_completion_error = error::Error(static_cast<int>(-result), category_posix());
+        } else {
+            self->emplace_result(static_cast<typename IOImpl::IOResultType>(result));
+        }
+        self->async_resume() >> JINX_IGNORE_RESULT;
+    }
+};
+
+/*
+    Repeats a partial transfer until all of it is done or the input is drained,
+    the result is the number of bytes transferred.
+*/
+template<typename IOImpl>
+class AsyncIOTransfer : public AsyncIOCommon<IOImpl>
+{
+    typedef AsyncIOCommon<IOImpl> CommonType;
+
+    long _transferred{0};
+
+public:
+    template<typename... Args>
+    AsyncIOTransfer& operator()(Args&&... args) 
+    {
+        CommonType::operator()(std::forward<Args>(args)...);
+        _transferred = 0;
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        _transferred = 0;
+        CommonType::async_finalize();
+    }
+
+    Async async_poll() override {
+        auto state = CommonType::async_poll();
+        if (state == ControlState::Ready) {
+            const long size = this->get_result();
+            _transferred += size;
+            // 0 is the end of the input
+            if (size > 0 and static_cast<size_t>(size) < this->io_impl().size()) {
+                CommonType::operator()(this->io_impl().advance(static_cast<size_t>(size)));
+                return this->async_poll();
+            }
+            this->emplace_result(_transferred);
+        }
+        return state;
+    }
 };
 
 } // namespace detail
@@ -1078,12 +1862,19 @@ struct AsyncIOPosix
     using WriteV = detail::AsyncIOCommon<detail::PosixWriteV<EventEngine>>;
     using SendMsg = detail::AsyncIOCommon<detail::PosixSendMsg<EventEngine>>;
     using RecvMsg = detail::AsyncIOCommon<detail::PosixRecvMsg<EventEngine>>;
+#if defined(__linux__)
+    using SendMMsg = detail::AsyncIOCommon<detail::PosixSendMMsg<EventEngine>>;
+    using RecvMMsg = detail::AsyncIOCommon<detail::PosixRecvMMsg<EventEngine>>;
+    using SendFile = detail::AsyncIOTransfer<detail::PosixSendFile<EventEngine>>;
+    using Splice = detail::AsyncIOTransfer<detail::PosixSplice<EventEngine>>;
+#endif
 
     using Send = detail::AsyncIOCommon<detail::PosixSend<EventEngine>>;
     using Recv = detail::AsyncIOCommon<detail::PosixRecv<EventEngine>>;
     using SendTo = detail::AsyncIOCommon<detail::PosixSendTo<EventEngine>>;
     using RecvFrom = detail::AsyncIOCommon<detail::PosixRecvFrom<EventEngine>>;
     using Accept = detail::AsyncIOCommon<detail::PosixAccept<EventEngine>>;
+    using AcceptBatch = detail::AsyncIOCommon<detail::PosixAcceptBatch<EventEngine>>;
     using Connect = detail::AsyncIOCommon<detail::PosixConnect<EventEngine>>;
 };
 
@@ -1099,6 +1890,95 @@ struct MemoryProvider {
     }
 };
 
+/*
+    Carves the memory from large mmap regions, in fixed size slots, one size class per allocation size.
+    A buffer pool always asks for the same size, so each BufferConfig gets regions of its own.
+    A region left without any slot in use is given back to the OS with MADV_DONTNEED,
+    its address range stays mapped and is faulted in again on demand. One idle region
+    per size class keeps its pages, for the load going up and down around a region boundary.
+    Thread safe, the buffer pools allocate and free on any thread.
+*/
+class SlabMemoryProvider : public MemoryProvider {
+public:
+    enum Flags {
+        // MAP_HUGETLB, or transparent huge pages if the system has none reserved
+        SlabHugePages = 1,
+        // MAP_POPULATE, prefault the new regions
+        SlabPopulate = 2,
+    };
+
+    static constexpr size_t HugePageSize = 2 * 1024 * 1024;
+
+    // a region holds at least this many slots, larger sizes get larger regions
+    static constexpr size_t MinSlots = 8;
+
+    // the sizes past the classes are served by malloc
+    static constexpr size_t MaxClasses = 16;
+
+private:
+    struct Region;
+    struct SizeClass;
+
+    size_t _region_size;
+    int _flags;
+
+    std::mutex _mutex{};
+    std::vector<std::unique_ptr<SizeClass>> _classes{};
+    std::vector<std::unique_ptr<Region>> _regions{};
+
+    size_t _resident_regions{0};
+    size_t _huge_regions{0};
+    size_t _used_slots{0};
+
+    SizeClass* get_class(size_t slot_size) noexcept;
+    Region* map_region(SizeClass* size_class) noexcept;
+    void region_idle(Region* region) noexcept;
+
+public:
+    explicit SlabMemoryProvider(size_t region_size = HugePageSize, int flags = 0);
+    ~SlabMemoryProvider();
+    JINX_NO_COPY_NO_MOVE(SlabMemoryProvider);
+
+    void* alloc(size_t size) noexcept override;
+
+    void free(void* mem) noexcept override;
+
+    size_t region_count() noexcept;
+
+    // regions with pages, the others were given back to the OS
+    size_t resident_region_count() noexcept;
+
+    size_t huge_region_count() noexcept;
+
+    size_t used_slot_count() noexcept;
+};
+
+/*
+    Memory mapped twice in a row, the byte at size() + n is the byte at n.
+    The size is rounded up to the page, see buffer::BufferViewRing.
+*/
+class MirroredMemory {
+    void* _memory{nullptr};
+    size_t _size{0};
+
+public:
+    MirroredMemory() = default;
+    JINX_NO_COPY_NO_MOVE(MirroredMemory);
+
+    ~MirroredMemory() {
+        release();
+    }
+
+    JINX_NO_DISCARD
+    ResultGeneric create(size_t size);
+
+    void release() noexcept;
+
+    void* data() const noexcept { return _memory; }
+
+    size_t size() const noexcept { return _size; }
+};
+
 } // namespace posix
 } // namespace jinx
 
@@ -24,6 +24,8 @@ SOFTWARE.
 #ifndef __jinx_stream_hpp__
 #define __jinx_stream_hpp__
 
+#include <sys/types.h>
+
 #include <jinx/buffer.hpp>
 #include <jinx/macros.hpp>
 #include <jinx/error.hpp>
@@ -41,6 +43,35 @@ JINX_ERROR_DEFINE(stream, ErrorStream);
 
 class Stream
 {    
+    // writes the views one after another through write()
+    class AsyncWriteEach : public AsyncRoutine {
+        Stream* _stream{nullptr};
+        buffer::BufferView* const* _views{nullptr};
+        size_t _count{0};
+        size_t _index{0};
+
+    public:
+        AsyncWriteEach& operator ()(Stream* stream, buffer::BufferView* const* views, size_t count) {
+            _stream = stream;
+            _views = views;
+            _count = count;
+            _index = 0;
+            async_start(&AsyncWriteEach::write_next);
+            return *this;
+        }
+
+    protected:
+        Async write_next() {
+            if (_index == _count) {
+                return this->async_return();
+            }
+            auto* view = _views[_index++];
+            return this->async_await(_stream->write(view), &AsyncWriteEach::write_next);
+        }
+    };
+
+    AsyncWriteEach _write_each{};
+
 public:
     Stream() = default;
     JINX_NO_COPY_NO_MOVE(Stream);
@@ -49,7 +80,22 @@ public:
     virtual Awaitable& shutdown() = 0;
     virtual void reset() noexcept = 0;
     virtual Awaitable& write(buffer::BufferView* view) = 0;
+
+    /*
+        Writes the views in order as one, the array is kept by the caller until it is done.
+        By default each view is written in turn, streams override it to gather the views.
+    */
+    virtual Awaitable& writev(buffer::BufferView* const* views, size_t count) {
+        return _write_each(this, views, count);
+    }
+
     virtual Awaitable& read(buffer::BufferView* view) = 0;
+
+    /*
+        Writes count bytes of a file from offset, or from its position if offset is nullptr,
+        without copying them to user space. nullptr if the stream has to see the bytes, e.g. TLS.
+    */
+    virtual Awaitable* send_file(int file_handle, off_t* offset, size_t count) { return nullptr; }
 };
 
 } // namespace stream
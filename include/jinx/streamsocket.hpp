@@ -25,15 +25,183 @@ SOFTWARE.
 #define __jinx_streamsocket_hpp__
 
 #include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 
 #include <jinx/buffer.hpp>
 #include <jinx/macros.hpp>
+#include <jinx/pointer.hpp>
+#include <jinx/result.hpp>
 #include <jinx/stream.hpp>
 
 namespace jinx {
 namespace stream {
 namespace detail {
 
+#if defined(__linux__)
+/*
+    Buffers the kernel still reads from after sends of MSG_ZEROCOPY.
+    Every successful send takes the next sequence number of the socket,
+    the error queue reports ranges of finished ones.
+*/
+class ZeroCopyReferences
+{
+public:
+    constexpr static const uint32_t Capacity = 64;
+
+    // a shared buffer, type erased
+    struct Reference {
+        void* _memory{nullptr};
+        void (*_ref)(void*){nullptr};
+        void (*_unref)(void*){nullptr};
+
+        template<typename T>
+        explicit Reference(pointer::PointerShared<T>& buffer) noexcept
+        : _memory(buffer.get()),
+          _ref([](void* memory) { pointer::PointerShared<T>::shared_from_this(static_cast<T*>(memory)).release(); }),
+          _unref([](void* memory) { pointer::PointerShared<T>{static_cast<T*>(memory)}; })
+        { }
+
+        Reference() = default;
+    };
+
+private:
+    struct Entry {
+        Reference _reference{};
+        bool _done{false};
+    };
+
+    Entry _entries[Capacity];
+    uint32_t _first{0};
+    uint32_t _next{0};
+
+    void complete(uint32_t first, uint32_t last) noexcept;
+
+public:
+    ZeroCopyReferences() = default;
+    JINX_NO_COPY_NO_MOVE(ZeroCopyReferences);
+    ~ZeroCopyReferences() { release(); }
+
+    uint32_t size() const noexcept { return _next - _first; }
+
+    // false if it is still full after reaping, the send is copied
+    bool reserve(int io_handle) noexcept;
+
+    // after a successful send of MSG_ZEROCOPY
+    void hold(const Reference& reference) noexcept;
+
+    // reads the error queue without blocking
+    void reap(int io_handle) noexcept;
+
+    // drops the rest and restarts the numbering for a new socket
+    void release() noexcept;
+
+    // takes the references and the numbering of other, which restarts empty
+    void take(ZeroCopyReferences& other) noexcept;
+};
+
+/*
+    Keeps a socket closed with sends in flight until the kernel is done with them.
+    The descriptor is shut down and stays open for its error queue, the buffers 
+    go back to their pools once it reported every send. Sockets are parked per 
+    thread and reaped by the next release of a socket on the thread.
+*/
+void park_zero_copy(int io_handle, ZeroCopyReferences& references);
+
+// reaps the sockets parked by the thread, returns the number left
+size_t reap_zero_copy_parked() noexcept;
+
+// reads the error queue on every poll, it keeps a level triggered engine waking up
+template<typename Operation>
+class StreamReapZeroCopy : public Operation
+{
+    ZeroCopyReferences* _references{nullptr};
+
+public:
+    using Operation::operator();
+
+    void set_zero_copy_references(ZeroCopyReferences* references) noexcept {
+        _references = references;
+    }
+
+protected:
+    Async async_poll() override {
+        if (_references != nullptr) {
+            _references->reap(this->native_handle());
+        }
+        return Operation::async_poll();
+    }
+};
+
+/*
+    Sends with MSG_ZEROCOPY while the rest is no smaller than the threshold,
+    a reference of the buffer is held for each of these sends.
+*/
+template<typename Send>
+class StreamSendZeroCopy : public Send
+{
+    typedef typename Send::EventEngineType EventEngineType;
+
+    buffer::BufferView* _view{nullptr};
+    ZeroCopyReferences::Reference _reference{};
+    ZeroCopyReferences* _references{nullptr};
+    size_t _threshold{0};
+    bool _zero_copy{false};
+
+    void send(typename EventEngineType::IOHandleNativeType handle) {
+        _zero_copy = _view->size() >= _threshold and _references->reserve(handle);
+        Send::operator()(handle, _view->slice_for_consumer(), _zero_copy ? MSG_NOSIGNAL | MSG_ZEROCOPY : MSG_NOSIGNAL);
+    }
+
+public:
+    StreamSendZeroCopy& operator()(
+        typename EventEngineType::IOHandleNativeType handle, 
+        buffer::BufferView* view,
+        const ZeroCopyReferences::Reference& reference,
+        ZeroCopyReferences* references,
+        size_t threshold)
+    {
+        _view = view;
+        _reference = reference;
+        _references = references;
+        _threshold = threshold;
+        send(handle);
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        _view = nullptr;
+        _reference = {};
+        _references = nullptr;
+        _zero_copy = false;
+        Send::async_finalize();
+    }
+
+    Async async_poll() override {
+        _references->reap(this->native_handle());
+        auto state = Send::async_poll();
+        if (state == ControlState::Ready) {
+            if (_zero_copy) {
+                _references->hold(_reference);
+            }
+            if(_view->consume(Send::get_result()).is(Successful_)) {
+                if (_view->size() > 0) {
+                    send(this->native_handle());
+                    return this->async_poll();
+                }
+            } else {
+                    error::fatal("stream buffer out of range");
+            }
+        }
+        return state;
+    }
+};
+#endif
+
 template<typename Send>
 class StreamSend : public Send
 {
@@ -83,6 +251,81 @@ protected:
     }
 };
 
+template<typename SendMsg>
+class StreamSendV : public SendMsg
+{
+    typedef typename SendMsg::EventEngineType EventEngineType;
+
+    // more views are sent by the next sendmsg
+    constexpr static const size_t MaxIOVecs = 16;
+
+    buffer::BufferView* const* _views{nullptr};
+    size_t _count{0};
+    struct iovec _iovecs[MaxIOVecs];
+    struct msghdr _msg{};
+
+    void send(typename EventEngineType::IOHandleNativeType handle) {
+#if __linux__
+        const int SendFlags = MSG_NOSIGNAL;
+#else
+        const int SendFlags = 0;
+#endif
+        while (_count > 0 and _views[0]->size() == 0) {
+            ++_views;
+            --_count;
+        }
+        size_t iovec_count = 0;
+        for (; iovec_count < _count and iovec_count < MaxIOVecs; ++iovec_count) {
+            _iovecs[iovec_count].iov_base = _views[iovec_count]->begin();
+            _iovecs[iovec_count].iov_len = _views[iovec_count]->size();
+        }
+        _msg = {};
+        _msg.msg_iov = _iovecs;
+        _msg.msg_iovlen = iovec_count;
+        SendMsg::operator()(handle, &_msg, SendFlags);
+    }
+
+public:
+    StreamSendV& operator()(
+        typename EventEngineType::IOHandleNativeType handle, 
+        buffer::BufferView* const* views,
+        size_t count)
+    {
+        _views = views;
+        _count = count;
+        send(handle);
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        _views = nullptr;
+        _count = 0;
+        SendMsg::async_finalize();
+    }
+
+    Async async_poll() override {
+        auto state = SendMsg::async_poll();
+        if (state == ControlState::Ready) {
+            auto size = static_cast<size_t>(SendMsg::get_result());
+            for (size_t i = 0; i < _count and size > 0; ++i) {
+                const auto consumed = std::min(size, _views[i]->size());
+                if (_views[i]->consume(consumed).is(Failed_)) {
+                    error::fatal("stream buffer out of range");
+                }
+                size -= consumed;
+            }
+            for (size_t i = 0; i < _count; ++i) {
+                if (_views[i]->size() > 0) {
+                    send(this->native_handle());
+                    return this->async_poll();
+                }
+            }
+        }
+        return state;
+    }
+};
+
 template<typename Recv>
 class StreamRecv : public Recv
 {
@@ -122,6 +365,39 @@ protected:
     }
 };
 
+#if defined(__linux__)
+template<typename SendFile>
+class StreamSendFile : public SendFile
+{
+    size_t _count{0};
+
+public:
+    StreamSendFile& operator()(
+        typename SendFile::EventEngineType::IOHandleNativeType handle, 
+        int file_handle, off_t* offset, size_t count) 
+    {
+        SendFile::operator()(handle, file_handle, offset, count);
+        _count = count;
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        _count = 0;
+        SendFile::async_finalize();
+    }
+
+    Async async_poll() override {
+        auto state = SendFile::async_poll();
+        // the file is shorter than promised to the peer
+        if (state == ControlState::Ready and static_cast<size_t>(SendFile::get_result()) != _count) {
+            return this->async_throw(ErrorStream::EndOfStream);
+        }
+        return state;
+    }
+};
+#endif
+
 template<typename AsyncIOImpl>
 class StreamSocket : public Stream
 {
@@ -133,22 +409,83 @@ public:
 
 private:
     IOHandleType _io_handle{-1};
+    // removed before the handle is closed
+    typename EventEngineType::EventHandleRegistration _registration{};
     char _buf{0};
 
+#if defined(__linux__)
+    StreamReapZeroCopy<StreamSend<typename asyncio::Send>> _send{};
+    StreamReapZeroCopy<StreamSendV<typename asyncio::SendMsg>> _send_v{};
+    StreamReapZeroCopy<StreamRecv<typename asyncio::Recv>> _recv{};
+
+    StreamReapZeroCopy<typename asyncio::Recv> _socket_recv{};
+    StreamReapZeroCopy<StreamSendFile<typename asyncio::SendFile>> _send_file{};
+
+    // opt-in by set_zero_copy, 0 is disabled
+    StreamSendZeroCopy<typename asyncio::Send> _send_zero_copy{};
+    ZeroCopyReferences _zero_copy_references{};
+    size_t _zero_copy_threshold{0};
+#else
     StreamSend<typename asyncio::Send> _send{};
+    StreamSendV<typename asyncio::SendMsg> _send_v{};
     StreamRecv<typename asyncio::Recv> _recv{};
 
     typename asyncio::Recv _socket_recv{};
+#endif
+
+    // the operations share one persistent registration of the socket
+    void set_registration() noexcept {
+        _send.set_registration(&_registration);
+        _send_v.set_registration(&_registration);
+        _recv.set_registration(&_registration);
+        _socket_recv.set_registration(&_registration);
+#if defined(__linux__)
+        _send_file.set_registration(&_registration);
+        _send_zero_copy.set_registration(&_registration);
+#endif
+    }
+
+#if defined(__linux__)
+    void set_zero_copy_references(ZeroCopyReferences* references) noexcept {
+        _send.set_zero_copy_references(references);
+        _send_v.set_zero_copy_references(references);
+        _recv.set_zero_copy_references(references);
+        _socket_recv.set_zero_copy_references(references);
+        _send_file.set_zero_copy_references(references);
+    }
+
+    // the buffers are back to their pools once the kernel is done, parked with the socket meanwhile
+    void release_zero_copy() noexcept {
+        if (_zero_copy_references.size() != 0) {
+            _zero_copy_references.reap(_io_handle.native_handle());
+        }
+        if (_zero_copy_references.size() != 0 and _io_handle.is_valid()) {
+            park_zero_copy(_io_handle.release(), _zero_copy_references);
+        }
+        reap_zero_copy_parked();
+        _zero_copy_references.release();
+        _zero_copy_threshold = 0;
+        set_zero_copy_references(nullptr);
+    }
+#endif
 
 public:
-    StreamSocket() = default;
-    ~StreamSocket() override = default;
-    explicit StreamSocket(IOHandleType&& io_handle) : _io_handle(std::move(io_handle)) { }
-    explicit StreamSocket(IOHandleNativeType native_handle) : _io_handle(native_handle) { }
+    StreamSocket() { set_registration(); }
+    ~StreamSocket() override {
+#if defined(__linux__)
+        release_zero_copy();
+#endif
+    }
+    explicit StreamSocket(IOHandleType&& io_handle) : _io_handle(std::move(io_handle)) { set_registration(); }
+    explicit StreamSocket(IOHandleNativeType native_handle) : _io_handle(native_handle) { set_registration(); }
     JINX_NO_COPY_NO_MOVE(StreamSocket);
 
     void initialize(IOHandleType&& io_handle) 
     {
+        _registration.reset();
+#if defined(__linux__)
+        release_zero_copy();
+#endif
         _io_handle = std::move(io_handle);
 #ifdef __APPLE__
         int b = 1;
@@ -160,12 +497,59 @@ public:
         return _io_handle;
     }
 
+    // a read waiting longer raises posix::ErrorPosix::TimedOut, 0 disables it
+    template<typename Rep, typename Period>
+    void set_read_timeout(const std::chrono::duration<Rep, Period>& timeout) noexcept {
+        _recv.set_timeout(timeout);
+        _socket_recv.set_timeout(timeout);
+    }
+
+    // a write waiting longer raises posix::ErrorPosix::TimedOut, 0 disables it
+    template<typename Rep, typename Period>
+    void set_write_timeout(const std::chrono::duration<Rep, Period>& timeout) noexcept {
+        _send.set_timeout(timeout);
+        _send_v.set_timeout(timeout);
+#if defined(__linux__)
+        _send_file.set_timeout(timeout);
+        _send_zero_copy.set_timeout(timeout);
+#endif
+    }
+
+#if defined(__linux__)
+    /*
+        Writes of pooled buffers at least threshold bytes long are sent with MSG_ZEROCOPY,
+        smaller ones are copied. 0 disables it.
+        A socket reset with sends in flight is parked until the kernel reported them, 
+        see reap_zero_copy_parked.
+    */
+    JINX_NO_DISCARD
+    ResultGeneric set_zero_copy(size_t threshold) noexcept {
+        if (threshold != 0) {
+            int enable = 1;
+            if (::setsockopt(_io_handle.native_handle(), SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) != 0) {
+                return Failed_;
+            }
+        }
+        _zero_copy_threshold = threshold;
+        set_zero_copy_references(threshold != 0 ? &_zero_copy_references : nullptr);
+        return Successful_;
+    }
+
+    ZeroCopyReferences& zero_copy_references() noexcept {
+        return _zero_copy_references;
+    }
+#endif
+
     Awaitable& shutdown() override {
         EventEngineType::shutdown(_io_handle.native_handle(), SHUT_WR);
         return _socket_recv(_io_handle.native_handle(), SliceMutable{&_buf, 1}, MSG_PEEK);
     }
 
     void reset() noexcept override {
+        _registration.reset();
+#if defined(__linux__)
+        release_zero_copy();
+#endif
         _io_handle.reset();
     }
 
@@ -176,6 +560,39 @@ public:
     Awaitable& write(buffer::BufferView* view) override {
         return _send(_io_handle.native_handle(), view);
     }
+
+    Awaitable& writev(buffer::BufferView* const* views, size_t count) override {
+        return _send_v(_io_handle.native_handle(), views, count);
+    }
+
+    // holds a reference of the buffer while the kernel reads from it, see set_zero_copy
+    template<typename T>
+    Awaitable& write(pointer::PointerShared<T>& buffer) {
+#if defined(__linux__)
+        if (_zero_copy_threshold != 0) {
+            return _send_zero_copy(
+                _io_handle.native_handle(), 
+                &buffer.get()->view(), 
+                ZeroCopyReferences::Reference{buffer}, 
+                &_zero_copy_references, 
+                _zero_copy_threshold);
+        }
+#endif
+        return _send(_io_handle.native_handle(), &buffer.get()->view());
+    }
+
+#if defined(__linux__)
+    // a closed peer fails it with EPIPE, SIGPIPE is blocked for the call, see posix::call_without_sigpipe
+    Awaitable* send_file(int file_handle, off_t* offset, size_t count) override {
+        return &_send_file(_io_handle.native_handle(), file_handle, offset, count);
+    }
+#endif
+
+    // receivers returning their own buffers, e.g. iouring::RecvBuffer
+    template<typename Receiver>
+    Awaitable& read(Receiver& receiver) {
+        return receiver(_io_handle.native_handle());
+    }
 };
 
 } // namespace detail
@@ -183,6 +600,11 @@ public:
 template<typename AsyncIOImpl>
 using StreamSocket = detail::StreamSocket<AsyncIOImpl>;
 
+#if defined(__linux__)
+// call before destroying the allocators of buffers sent with MSG_ZEROCOPY, see set_zero_copy
+using detail::reap_zero_copy_parked;
+#endif
+
 } // namespace stream
 } // namespace jinx
 
@@ -0,0 +1,238 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef __jinx_timerwheel_hpp__
+#define __jinx_timerwheel_hpp__
+
+#include <sys/time.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include <jinx/macros.hpp>
+#include <jinx/error.hpp>
+#include <jinx/result.hpp>
+
+namespace jinx {
+
+typedef void(*TimerCallback)(void* arg);
+
+/*
+    Hierarchical timing wheel, the timers of a loop.
+
+    Levels of 64 slots, a slot of level l spans 64^l ticks of the slack, the 
+    resolution. Adding and cancelling are O(1), an expiry moves a timer down 
+    the levels at most once per level. Timers expire at the first tick after 
+    their deadline, at most one slack late.
+
+    A timeout counts from the clock read when the timer is added, a timer never 
+    fires before its timeout passed. now() is cached per loop tick, a deadline 
+    computed from it starts up to the time the tick took so far early.
+
+    Only the nearest expiry is armed as a timer of the event engine.
+*/
+class TimerWheel {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr const unsigned int SlotBits = 6;
+    static constexpr const unsigned int SlotCount = 1U << SlotBits;
+    static constexpr const unsigned int LevelCount = 5;
+
+    class Entry {
+        friend class TimerWheel;
+
+        Entry* _prev{nullptr};
+        Entry* _next{nullptr};
+        TimerWheel* _wheel{nullptr};
+        uint64_t _tick{0};
+        unsigned int _level{0};
+        TimerCallback _callback{nullptr};
+        void* _arg{nullptr};
+
+    public:
+        Entry() = default;
+        JINX_NO_COPY_NO_MOVE(Entry);
+        ~Entry() {
+            cancel();
+        }
+
+        bool is_pending() const noexcept {
+            return _wheel != nullptr;
+        }
+
+        void cancel() noexcept {
+            if (_wheel != nullptr) {
+                _wheel->remove(*this);
+            }
+        }
+    };
+
+private:
+    // circular lists, the sentinel of a slot is its own head
+    struct Slot {
+        Entry* _prev;
+        Entry* _next;
+    };
+
+    Slot _slots[LevelCount][SlotCount];
+    size_t _level_size[LevelCount]{};
+    size_t _size{0};
+
+    Clock::time_point _epoch;
+    Clock::duration _resolution;
+    uint64_t _current{0};
+
+    // the clock cached for a tick of the loop
+    const size_t* _loop_tick;
+    size_t _clock_tick{0};
+    Clock::time_point _clock{};
+
+    static constexpr const uint64_t NotArmed = UINT64_MAX;
+    uint64_t _armed{NotArmed};
+    size_t _arm_count{0};
+    // armed once after the expired timers ran
+    bool _expiring{false};
+
+    Entry* head(unsigned int level, unsigned int slot) noexcept {
+        return reinterpret_cast<Entry*>(&_slots[level][slot]);
+    }
+
+    uint64_t to_tick(Clock::time_point time_point) const noexcept {
+        if (time_point <= _epoch) {
+            return 0;
+        }
+        return static_cast<uint64_t>((time_point - _epoch) / _resolution);
+    }
+
+    void place(Entry& entry) noexcept;
+    void remove(Entry& entry) noexcept;
+    void advance(uint64_t tick);
+    uint64_t next_expiry() noexcept;
+    void rearm(uint64_t tick);
+
+protected:
+    // arms the engine timer, replacing the armed one
+    JINX_NO_DISCARD
+    virtual ResultGeneric arm(Clock::duration timeout) = 0;
+    virtual void disarm() noexcept = 0;
+
+    // the engine timer expired
+    void expire();
+
+public:
+    /*
+        slack: the resolution of the wheel
+        loop_tick: the tick of the loop, the clock is read once per tick
+    */
+    TimerWheel(Clock::duration slack, const size_t* loop_tick);
+    JINX_NO_COPY_NO_MOVE(TimerWheel);
+    virtual ~TimerWheel();
+
+    // monotonic clock, cached for the current tick of the loop
+    Clock::time_point now() noexcept {
+        if (_clock_tick != *_loop_tick) {
+            _clock_tick = *_loop_tick;
+            _clock = Clock::now();
+        }
+        return _clock;
+    }
+
+    JINX_NO_DISCARD
+    ResultGeneric add(Entry& entry, Clock::time_point deadline, TimerCallback callback, void* arg);
+
+    template<typename Rep, typename Period>
+    JINX_NO_DISCARD
+    ResultGeneric add(Entry& entry, const std::chrono::duration<Rep, Period>& timeout, TimerCallback callback, void* arg) {
+        // a fresh clock, the cached one may be a long tick behind
+        return add(entry, Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout), callback, arg);
+    }
+
+    Clock::duration get_slack() const noexcept { return _resolution; }
+
+    // Failed if timers are pending
+    JINX_NO_DISCARD
+    ResultGeneric set_slack(Clock::duration slack) noexcept;
+
+    size_t size() const noexcept { return _size; }
+
+    // number of times the engine timer was armed
+    size_t get_arm_count() const noexcept { return _arm_count; }
+};
+
+/*
+    TimerWheel armed by a timer of EventEngine.
+
+    Two handles take turns, the next expiry is armed from the callback of 
+    the expired one.
+*/
+template<typename EventEngine>
+class TimerWheelEngine final : public TimerWheel {
+    EventEngine* _event_engine;
+    typename EventEngine::EventHandleTimer _handles[2]{};
+    unsigned int _index{0};
+    bool _armed{false};
+
+    static void timer_callback(const error::Error& error, void* arg) {
+        auto* self = static_cast<TimerWheelEngine*>(arg);
+        self->_event_engine->remove_timer(self->_handles[self->_index]) >> JINX_IGNORE_RESULT;
+        self->_armed = false;
+        self->expire();
+    }
+
+protected:
+    ResultGeneric arm(Clock::duration timeout) override {
+        disarm();
+        _index ^= 1;
+
+        const auto usec = std::chrono::duration_cast<std::chrono::microseconds>(timeout).count();
+        struct timeval timeval{};
+        timeval.tv_sec = static_cast<decltype(timeval.tv_sec)>(usec / 1000000);
+        timeval.tv_usec = static_cast<decltype(timeval.tv_usec)>(usec % 1000000);
+        if (_event_engine->add_timer(_handles[_index], &timeval, &TimerWheelEngine::timer_callback, this).is(Failed_)) {
+            return Failed_;
+        }
+        _armed = true;
+        return Successful_;
+    }
+
+    void disarm() noexcept override {
+        if (_armed) {
+            _event_engine->remove_timer(_handles[_index]) >> JINX_IGNORE_RESULT;
+            _armed = false;
+        }
+    }
+
+public:
+    TimerWheelEngine(EventEngine* event_engine, Clock::duration slack, const size_t* loop_tick)
+    : TimerWheel(slack, loop_tick), _event_engine(event_engine)
+    { }
+
+    ~TimerWheelEngine() override {
+        disarm();
+    }
+};
+
+} // namespace jinx
+
+#endif
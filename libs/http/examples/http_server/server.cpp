@@ -26,11 +26,15 @@ protected:
     }
 };
 
+// connections accepted per readiness event
+const size_t AcceptBatchSize = 16;
+
 class Acceptor : public AsyncRoutine {
     void* _data{};
     int _fd{-1};
     AllocatorType* _allocator{};
-    asyncio::Accept _accept{};
+    asyncio::AcceptBatch _accept{};
+    int _clients[AcceptBatchSize];
 public:
     Acceptor& operator ()(void* data, int sock, AllocatorType* allocator)
     {
@@ -49,18 +53,19 @@ protected:
     }
 
     Async accept() {
-        return async_await(_accept(_fd, nullptr, nullptr), &Acceptor::spawn);
+        return async_await(_accept(_fd, _clients, AcceptBatchSize), &Acceptor::spawn);
     }
 
     Async spawn() {
-        posix::Socket client(_accept.get_result());
-        client.set_non_blocking(true);
-        this->task_allocate<buffer::TaskBufferredConfig<HandshakeSocket>>(
-            _allocator, 
-            _data,
-            std::move(client), 
-            _allocator
-        ).abort_on(Failed_, "out of memory");
+        // accepted non-blocking
+        for (long i = 0; i < _accept.get_result(); ++i) {
+            this->task_allocate<buffer::TaskBufferredConfig<HandshakeSocket>>(
+                _allocator, 
+                _data,
+                posix::Socket{_clients[i]}, 
+                _allocator
+            ).abort_on(Failed_, "out of memory");
+        }
         return accept();
     }
 };
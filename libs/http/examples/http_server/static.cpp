@@ -17,7 +17,7 @@ Async PageIndex::http_handle_request()
     write_response_field("Connection") << "close";
     write_response_field("Content-Type") << "text/html; charset=UTF-8";
     write_response_field("Content-Length") << _buffer.size();
-    return send_response(&PageIndex::send_body);
+    return send_response(&_buffer, &PageIndex::async_return);
 }
 
 Async FileAppJs::http_handle_request()
@@ -32,7 +32,7 @@ Async FileAppJs::http_handle_request()
     write_response_field("Connection") << "close";
     write_response_field("Content-Type") << "application/javascript; charset=utf-8";
     write_response_field("Content-Length") << _buffer.size();
-    return send_response(&FileAppJs::send_body);
+    return send_response(&_buffer, &FileAppJs::async_return);
 }
 
 } // namespace example
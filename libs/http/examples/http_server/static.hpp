@@ -14,11 +14,6 @@ struct PageIndex : WebPage {
     buffer::BufferView _buffer{};
 
     Async http_handle_request() override;
-
-    Async send_body() {
-        auto pair = get_stream();
-        return *this / pair.first->write(&_buffer) / &PageIndex::async_return;
-    }
 };
 
 struct FileAppJs : WebPage {
@@ -27,11 +22,6 @@ struct FileAppJs : WebPage {
     buffer::BufferView _buffer{};
 
     Async http_handle_request() override;
-
-    Async send_body() {
-        auto pair = get_stream();
-        return *this / pair.first->write(&_buffer) / &FileAppJs::async_return;
-    }
 };
 
 } // namespace example
@@ -33,12 +33,7 @@ struct PageStatus : WebPage {
         write_response_field("Connection") << "close";
         write_response_field("Content-Type") << "text/html; charset=UTF-8";
         write_response_field("Content-Length") << _buffer.size();
-        return send_response(&PageStatus::send_body);
-    }
-
-    Async send_body() {
-        auto pair = get_stream();
-        return *this / pair.first->write(&_buffer) / &PageStatus::async_return;
+        return send_response(&_buffer, &PageStatus::async_return);
     }
 };
 
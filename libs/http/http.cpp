@@ -131,6 +131,8 @@ JINX_ERROR_IMPLEMENT(webapp, {
             return "Out of memory";
         case ErrorWebApp::ResponseHeaderTooLarge:
             return "Response header too large";
+        case ErrorWebApp::SendFileNotSupported:
+            return "Send file not supported";
         default: break;
     }
     return "unkonwn error code";
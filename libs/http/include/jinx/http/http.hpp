@@ -28,9 +28,11 @@ SOFTWARE.
 #include <cctype>
 #include <algorithm>
 #include <array>
+#include <vector>
 
 #include <jinx/async.hpp>
 #include <jinx/buffer.hpp>
+#include <jinx/bufferchain.hpp>
 #include <jinx/stream.hpp>
 #include <jinx/variant.hpp>
 #include <jinx/hash.hpp>
@@ -119,6 +121,11 @@ class HTTPBuilder :
 protected:
     stream::Stream* _stream{nullptr};
     buffer::BufferView* _buffer{};
+    // the header and the body of send(body)
+    buffer::BufferView* _views[2]{};
+    // the header and the segments of send(chain)
+    buffer::BufferChain* _chain{nullptr};
+    std::vector<buffer::BufferView*> _chain_views{};
     std::ostream _output_stream;
 
     unsigned int _overflow:1;
@@ -191,6 +198,10 @@ protected:
         _use_custom_user_agent = 0;
         _connection_state = HTTPConnectionState::Unknown;
         _buffer = nullptr;
+        _views[0] = nullptr;
+        _views[1] = nullptr;
+        _chain = nullptr;
+        _chain_views.clear();
         AsyncRoutine::async_finalize();
     }
 
@@ -294,6 +305,20 @@ protected:
         return this->async_await(_stream->write(_buffer), &HTTPBuilder::_start_transfer);
     }
 
+    Async _start_transfer_with_body() {
+        return this->async_await(_stream->writev(_views, 2), &HTTPBuilder::async_return);
+    }
+
+    Async _start_transfer_with_chain() {
+        return this->async_await(_stream->writev(_chain_views.data(), _chain_views.size()), &HTTPBuilder::_finish_transfer_with_chain);
+    }
+
+    Async _finish_transfer_with_chain() {
+        // the written segments are dropped, their buffers released
+        _chain->trim();
+        return async_return();
+    }
+
 public:
     void initialize(stream::Stream* stream, buffer::BufferView* view)
     {
@@ -305,6 +330,24 @@ public:
         this->async_start(&HTTPBuilder::_start_transfer);
         return *this;
     }
+
+    // the header and the body by one write of the stream
+    Awaitable& send(buffer::BufferView* body) {
+        _views[0] = _buffer;
+        _views[1] = body;
+        this->async_start(&HTTPBuilder::_start_transfer_with_body);
+        return *this;
+    }
+
+    // the header and a body larger than a buffer by one write of the stream, the chain is consumed
+    Awaitable& send(buffer::BufferChain* body) {
+        _chain = body;
+        _chain_views.resize(1 + body->segment_count());
+        _chain_views[0] = _buffer;
+        body->views(&_chain_views[1], body->segment_count());
+        this->async_start(&HTTPBuilder::_start_transfer_with_chain);
+        return *this;
+    }
 };
 
 struct HTTPVersionDefault { };
@@ -431,6 +474,9 @@ class HTTPParser
     typedef AsyncRoutinePausable BaseType;
 
     buffer::BufferView* _buffer{};
+    // the view of _ring, the message starts at _message_begin
+    buffer::BufferViewRing* _ring{nullptr};
+    const char* _message_begin{nullptr};
     
     stream::Stream* _stream{nullptr};
 
@@ -455,6 +501,7 @@ public:
         _state = HTTPParserState::StartLine;
         _stream = stream;
         _buffer = view;
+        _ring = nullptr;
 
         if (view->size() == 0) {
             this->async_start(&HTTPParser::read_more);
@@ -463,6 +510,18 @@ public:
         }
     }
 
+    /*
+        Parse from a ring, the message may start anywhere in it.
+        EntityTooLarge only if the header is larger than the ring.
+    */
+    void initialize(stream::Stream* stream, buffer::BufferViewRing* ring) 
+    {
+        ring->rebase();
+        initialize(stream, &ring->view());
+        _ring = ring;
+        _message_begin = ring->view().begin();
+    }
+
     stream::Stream* stream() noexcept {
         return _stream;
     }
@@ -528,6 +587,10 @@ protected:
     }
 
     Async read_more() {
+        if (_ring != nullptr) {
+            // the parsed parts of the message are still referenced
+            _message_begin -= _ring->rebase(_message_begin);
+        }
         if (_buffer->capacity() == 0) {
             this->emplace_result(HTTPParserState::EntityTooLarge);
             return this->async_return();
@@ -211,7 +211,8 @@ struct Folder : ParseChildNodes<WebRoute, Slot, typename Node::ChildNodes> {
 enum class ErrorWebApp {
     NoError,
     OutOfMemory,
-    ResponseHeaderTooLarge
+    ResponseHeaderTooLarge,
+    SendFileNotSupported
 };
 
 JINX_ERROR_DEFINE(webapp, ErrorWebApp);
@@ -311,20 +312,41 @@ protected:
 
     template<typename T>
     Async send_response(Async(T::*callback)()) {
-        if (_interface->_connection_state == HTTPConnectionState::Unknown) {
-            _interface->_connection_state = HTTPConnectionState::Close;
+        if (header_done().is(Failed_)) {
+            return this->async_throw(ErrorWebApp::ResponseHeaderTooLarge);
         }
+        return this->async_await(_interface->_builder.send(), callback);
+    }
 
-        if (_interface->_builder.connection_state() != HTTPConnectionState::Unknown) {
-            _interface->_connection_state = _interface->_builder.connection_state();
+    // the header and the body in one write, the body is consumed
+    template<typename T>
+    Async send_response(buffer::BufferView* body, Async(T::*callback)()) {
+        if (header_done().is(Failed_)) {
+            return this->async_throw(ErrorWebApp::ResponseHeaderTooLarge);
         }
-        
-        if (_interface->_builder.write_header_done().is(Failed_)) {
+        return this->async_await(_interface->_builder.send(body), callback);
+    }
+
+    // the header and a body of many buffers in one write, the chain is consumed
+    template<typename T>
+    Async send_response(buffer::BufferChain* body, Async(T::*callback)()) {
+        if (header_done().is(Failed_)) {
             return this->async_throw(ErrorWebApp::ResponseHeaderTooLarge);
         }
+        return this->async_await(_interface->_builder.send(body), callback);
+    }
 
-        _interface->_flag_broken_stream = 1;
-        return this->async_await(_interface->_builder.send(), callback);
+    /*
+        Sends count bytes of a file as the body after send_response, 
+        the stream moves them without copying to user space.
+    */
+    template<typename T>
+    Async send_file(int file_handle, off_t* offset, size_t count, Async(T::*callback)()) {
+        auto* awaitable = _interface->_parser.stream()->send_file(file_handle, offset, count);
+        if (awaitable == nullptr) {
+            return this->async_throw(ErrorWebApp::SendFileNotSupported);
+        }
+        return this->async_await(*awaitable, callback);
     }
 
     template<size_t N>
@@ -340,6 +362,23 @@ protected:
     // TODO Async http_upgrade() { }
 
 private:
+    JINX_NO_DISCARD
+    ResultGeneric header_done() {
+        if (_interface->_connection_state == HTTPConnectionState::Unknown) {
+            _interface->_connection_state = HTTPConnectionState::Close;
+        }
+
+        if (_interface->_builder.connection_state() != HTTPConnectionState::Unknown) {
+            _interface->_connection_state = _interface->_builder.connection_state();
+        }
+
+        if (_interface->_builder.write_header_done().is(Failed_)) {
+            return Failed_;
+        }
+        _interface->_flag_broken_stream = 1;
+        return Successful_;
+    }
+
     Async init() {
         return http_start_line();
     }
@@ -423,12 +462,7 @@ protected:
         write_response_field("Connection") << "close";
         write_response_field("Content-Type") << "text/html; charset=UTF-8";
         write_response_field("Content-Length") << _buffer.size();
-        return send_response(&ErrorPage::send_body);
-    }
-
-    Async send_body() {
-        auto pair = get_stream();
-        return *this / pair.first->write(&_buffer) / &ErrorPage::async_return;
+        return send_response(&_buffer, &ErrorPage::async_return);
     }
 };
 
@@ -673,6 +707,7 @@ protected:
                 case ErrorWebApp::OutOfMemory:
                     return *this / _stream->shutdown() / &WebApp::async_return;
                 case ErrorWebApp::ResponseHeaderTooLarge:
+                case ErrorWebApp::SendFileNotSupported:
                     break;
             }
         } else if (error.category() == category_http()) {
@@ -0,0 +1,155 @@
+#include <jinx/async.hpp>
+#include <jinx/streamsocket.hpp>
+#include <jinx/posix.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/http/http.hpp>
+
+#include <string>
+
+using namespace jinx;
+using namespace jinx::stream;
+using namespace jinx::buffer;
+using namespace jinx::http;
+
+typedef posix::AsyncIOPosix<libevent::EventEngineLibevent> asyncio;
+
+// consumed by a previous message, most of the ring
+const size_t consumed = 3000;
+
+std::string make_request(size_t value_size) {
+    std::string request = "GET /ring/path HTTP/1.1\r\nHost: jinx\r\nTest: ";
+    for (size_t i = 0; i < value_size; ++i) {
+        request += static_cast<char>('a' + i % 26);
+    }
+    request += "\r\n\r\n";
+    return request;
+}
+
+class AsyncTest : public AsyncRoutine {
+    typedef StreamSocket<asyncio> StreamType;
+
+    int _rfd;
+    int _wfd;
+    posix::MirroredMemory* _memory{nullptr};
+    BufferViewRing _ring{};
+    StreamType _stream{};
+    HTTPParserRequest _request{};
+    asyncio::Send _send{};
+    std::string _message{};
+    size_t _value_size{0};
+    bool _path_checked{false};
+
+public:
+    AsyncTest& operator ()(int rfd, int wfd, posix::MirroredMemory* memory)
+    {
+        _rfd = rfd;
+        _wfd = wfd;
+        _memory = memory;
+        _ring = BufferViewRing{memory->data(), memory->size()};
+        _stream.initialize(posix::Socket{_rfd});
+        async_start(&AsyncTest::write_wrapped);
+        return *this;
+    }
+
+protected:
+    // larger than what is left after the consumed bytes, smaller than the ring
+    Async write_wrapped() {
+        jinx_assert(_ring.view().commit(consumed).is(Successful_));
+        jinx_assert(_ring.view().consume(consumed).is(Successful_));
+
+        _value_size = 2000;
+        _message = make_request(_value_size);
+        jinx_assert(_message.size() > _ring.ring_size() - consumed);
+        _request.initialize(&_stream, &_ring);
+        return *this / _send(_wfd, SliceConst{_message.data(), _message.size()}, 0) / &AsyncTest::parse_wrapped;
+    }
+
+    Async parse_wrapped() {
+        return *this / _request / &AsyncTest::check_wrapped;
+    }
+
+    Async check_wrapped() {
+        switch(_request.get_result()) {
+            case HTTPParserState::StartLine:
+                jinx_assert(std::string(_request.path().begin(), _request.path().end()) == "/ring/path");
+                break;
+            case HTTPParserState::Header:
+            {
+                std::string key{_request.name().begin(), _request.name().end()};
+                std::string value{_request.value().begin(), _request.value().end()};
+                if (key == "Test") {
+                    jinx_assert(value.size() == _value_size);
+                    jinx_assert(_message.find(value) != std::string::npos);
+                }
+            }
+                break;
+            case HTTPParserState::Complete:
+                // the start line is not overwritten by the reads after it
+                jinx_assert(std::string(_request.path().begin(), _request.path().end()) == "/ring/path");
+                jinx_assert(_ring.view().size() == 0);
+                return write_too_large();
+            default:
+                jinx_assert(false && "unexpected state");
+                break;
+        }
+        return parse_wrapped();
+    }
+
+    // larger than the ring
+    Async write_too_large() {
+        _value_size = _ring.ring_size();
+        _message = make_request(_value_size);
+        _request.initialize(&_stream, &_ring);
+        return *this / _send(_wfd, SliceConst{_message.data(), _message.size()}, 0) / &AsyncTest::parse_too_large;
+    }
+
+    Async parse_too_large() {
+        return *this / _request / &AsyncTest::check_too_large;
+    }
+
+    Async check_too_large() {
+        switch(_request.get_result()) {
+            case HTTPParserState::StartLine:
+            case HTTPParserState::Header:
+                return parse_too_large();
+            case HTTPParserState::EntityTooLarge:
+                jinx_assert(_ring.view().size() <= _ring.ring_size());
+                ::close(_wfd);
+                return async_return();
+            default:
+                jinx_assert(false && "unexpected state");
+                break;
+        }
+        return async_return();
+    }
+};
+
+int main(int argc, const char* argv[])
+{
+    libevent::EventEngineLibevent eve(false);
+    Loop loop(&eve);
+
+    posix::MirroredMemory memory{};
+    jinx_assert(memory.create(4000).is(Successful_));
+    jinx_assert(memory.size() % 4096 == 0);
+
+    // both halves are the same memory
+    auto* begin = static_cast<char*>(memory.data());
+    begin[0] = 'x';
+    jinx_assert(begin[memory.size()] == 'x');
+    begin[memory.size() + 1] = 'y';
+    jinx_assert(begin[1] == 'y');
+
+    int fds[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != -1);
+
+    asyncio::IOHandleType fd0(fds[0]);
+    asyncio::IOHandleType fd1(fds[1]);
+    fd0.set_non_blocking(true);
+    fd1.set_non_blocking(true);
+
+    loop.task_new<AsyncTest>(fd0.release(), fd1.release(), &memory);
+
+    loop.run();
+    return 0;
+}
@@ -121,14 +121,32 @@ class BIOWrite : public Awaitable {
     BIOEventCallback* _pending_read{};
 
     buffer::BufferView* _view{nullptr};
-
+    buffer::BufferView* const* _views{nullptr};
+    size_t _count{0};
 
 public:
     BIOWrite& operator()(buffer::BufferView* view) {
         _view = view;
+        _views = &_view;
+        _count = 1;
         return *this;
     }
 
+    BIOWrite& operator()(buffer::BufferView* const* views, size_t count) {
+        _views = views;
+        _count = count;
+        return *this;
+    }
+
+    // the first view not read yet, nullptr if there is none
+    buffer::BufferView* current() noexcept {
+        while (_count > 0 and _views[0]->size() == 0) {
+            ++_views;
+            --_count;
+        }
+        return _count > 0 ? _views[0] : nullptr;
+    }
+
     ResultGeneric add_event(BIOEventCallback* event) {
         if (_pending_read != nullptr) {
             return Failed_;
@@ -151,16 +169,20 @@ public:
             _pending_read = nullptr;
         }
         _view = nullptr;
+        _views = nullptr;
+        _count = 0;
     }
 
 protected:
     void async_finalize() noexcept override {
         _view = nullptr;
+        _views = nullptr;
+        _count = 0;
         Awaitable::async_finalize();
     }
 
     Async async_poll() override {
-        if (_view->size() == 0) {
+        if (current() == nullptr) {
             return async_return();
         }
 
@@ -214,6 +236,10 @@ public:
     Awaitable& write(buffer::BufferView* view) override {
         return _write(view);
     }
+
+    Awaitable& writev(buffer::BufferView* const* views, size_t count) override {
+        return _write(views, count);
+    }
 private:
     ResultGeneric add_io(detail::BIOEventCallback* event) {
         if ((event->flags() & detail::IOFlagRead) != 0) {
@@ -234,17 +260,23 @@ private:
         BIO_clear_flags(bio, BIO_FLAGS_READ);
 
         auto* self = reinterpret_cast<StreamBIO*>(BIO_get_app_data(bio));
-        auto* view = self->_write._view;
+        auto* view = self->_write.current();
 
-        if (view == nullptr or view->size() == 0) {
+        if (view == nullptr) {
             BIO_set_retry_read(bio);
             return -1;
         }
 
-        auto wsz = std::min(size, view->size());
-        memcpy(buf, view->begin(), wsz);
+        // the views of a writev are read at once
+        size_t wsz = 0;
+        while (view != nullptr and wsz < size) {
+            auto n = std::min(size - wsz, view->size());
+            memcpy(buf + wsz, view->begin(), n);
+            view->consume(n) >> JINX_IGNORE_RESULT;
+            wsz += n;
+            view = self->_write.current();
+        }
         *readbytes = wsz;
-        view->consume(wsz) >> JINX_IGNORE_RESULT;
         self->_write.async_resume() >> JINX_IGNORE_RESULT;
         return 1;
     }
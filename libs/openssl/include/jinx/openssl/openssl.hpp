@@ -24,6 +24,9 @@ SOFTWARE.
 #ifndef __jinx_openssl_hpp__
 #define __jinx_openssl_hpp__
 
+#include <algorithm>
+#include <memory>
+#include <new>
 #include <system_error>
 
 #include <openssl/ssl.h>
@@ -420,6 +423,76 @@ struct TLSImplOpenSSLWrite
     }
 };
 
+/*
+    Small views are copied into records of the staging buffer, 
+    a view of a full record is written from its own memory.
+*/
+struct TLSImplOpenSSLWriteV
+{
+    typedef int TLSResultType;
+    constexpr static const char* TLSTypeName = "SSL_write";
+    constexpr static const size_t StagingSize = SSL3_RT_MAX_PLAIN_LENGTH;
+
+    SSL* _connection{};
+
+    buffer::BufferView* const* _views{};
+    size_t _count{0};
+
+    char* _staging{};
+    size_t _staged{0};
+
+    TLSImplOpenSSLWriteV() = default;
+    TLSImplOpenSSLWriteV(SSL* connection, buffer::BufferView* const* views, size_t count, char* staging) 
+    : _connection(connection), _views(views), _count(count), _staging(staging) { }
+
+    IOResult io() {
+        IOResult result{};
+        if (_staging == nullptr) {
+            result._error = make_error(buffer::ErrorBuffer::OutOfMemory);
+            return result;
+        }
+        for (;;) {
+            // a retry repeats the same SSL_write
+            if (_staged > 0) {
+                result._int = SSL_write(_connection, _staging, _staged);
+                if (result._int <= 0) {
+                    result._error = convert_to_streamtls_error_code(
+                        SSL_get_error(_connection, result._int));
+                    return result;
+                }
+                _staged = 0;
+            }
+
+            while (_count > 0 and _views[0]->size() == 0) {
+                ++_views;
+                --_count;
+            }
+            if (_count == 0) {
+                return result;
+            }
+
+            auto* view = _views[0];
+            if (view->size() >= StagingSize) {
+                result._int = SSL_write(_connection, view->begin(), view->size());
+                if (result._int <= 0) {
+                    result._error = convert_to_streamtls_error_code(
+                        SSL_get_error(_connection, result._int));
+                    return result;
+                }
+                view->consume(static_cast<size_t>(result._int)).abort_on(Failed_, "consume out of range");
+                continue;
+            }
+
+            for (size_t i = 0; i < _count and _staged < StagingSize; ++i) {
+                const size_t size = std::min(StagingSize - _staged, _views[i]->size());
+                memcpy(_staging + _staged, _views[i]->begin(), size);
+                _views[i]->consume(size).abort_on(Failed_, "consume out of range");
+                _staged += size;
+            }
+        }
+    }
+};
+
 template<typename AsyncIOImpl>
 class StreamOpenSSL : public Stream
 {
@@ -432,6 +505,9 @@ private:
 
     AsyncTLS<AsyncIOImpl, TLSImplOpenSSLRead> _recv{};
     AsyncTLS<AsyncIOImpl, TLSImplOpenSSLWrite> _send{};
+    AsyncTLS<AsyncIOImpl, TLSImplOpenSSLWriteV> _send_v{};
+
+    std::unique_ptr<char[]> _staging{};
 
 public:
     StreamOpenSSL() = default;
@@ -467,6 +543,14 @@ public:
     Awaitable& write(buffer::BufferView* buffer) override {
         return _send(_connection.get(), buffer);
     }
+
+    Awaitable& writev(buffer::BufferView* const* views, size_t count) override {
+        if (_staging == nullptr) {
+            // the write fails if it's still missing
+            _staging.reset(new(std::nothrow) char[TLSImplOpenSSLWriteV::StagingSize]);
+        }
+        return _send_v(_connection.get(), views, count, _staging.get());
+    }
 };
     
 } // namespace openssl
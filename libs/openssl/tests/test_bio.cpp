@@ -33,6 +33,15 @@ public:
     }
 
     Async write() {
+        return *this / _ssl->write(&_view) / &AsyncServer::read_again;
+    }
+
+    Async read_again() {
+        _view = {_buffer.data(), _buffer.size(), 0, 0};
+        return *this / _ssl->read(&_view) / &AsyncServer::write_again;
+    }
+
+    Async write_again() {
         return *this / _ssl->write(&_view) / &AsyncServer::async_return;
     }
 };
@@ -41,6 +50,8 @@ class AsyncClient : public AsyncRoutine {
     typedef AsyncRoutine BaseType;
 
     buffer::BufferView _view{};
+    buffer::BufferView _tail{};
+    buffer::BufferView* _views[2]{&_view, &_tail};
     std::array<char, 128> _buffer{};
     
     StreamOpenSSL<AsyncIOBIO>* _ssl{};
@@ -73,6 +84,26 @@ public:
     }
 
     Async check() {
+        jinx_assert(_view.size() == 5);
+        jinx_assert(memcmp("hello", _view.begin(), 5) == 0);
+        return writev();
+    }
+
+    Async writev() {
+        _view = {const_cast<char*>("hel"), 3, 0, 3};
+        _tail = {const_cast<char*>("lo"), 2, 0, 2};
+        // one record, read at once by the server
+        return *this / _ssl->writev(_views, 2) / &AsyncClient::read_again;
+    }
+
+    Async read_again() {
+        jinx_assert(_view.size() == 0 and _tail.size() == 0);
+        _view = {_buffer.data(), _buffer.size(), 0, 0};
+        memset(_view.begin(), 0, _view.capacity());
+        return *this / _ssl->read(&_view) / &AsyncClient::check_again;
+    }
+
+    Async check_again() {
         jinx_assert(_view.size() == 5);
         jinx_assert(memcmp("hello", _view.begin(), 5) == 0);
         return async_throw(posix::ErrorPosix::InvalidArgument);
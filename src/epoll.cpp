@@ -0,0 +1,819 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#if defined(__linux__)
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <jinx/logging.hpp>
+#include <jinx/macros.hpp>
+#include <jinx/epoll.hpp>
+
+namespace jinx {
+namespace epoll {
+
+enum EventState {
+    Pending,
+    Running,
+    Deleted
+};
+
+enum IODirection {
+    DirectionRead = 0,
+    DirectionWrite = 1
+};
+
+static const char epoll_type_tag = 0;
+
+static const unsigned int direction_flags[2] = {
+    EventEngineEpoll::IOFlagRead, 
+    EventEngineEpoll::IOFlagWrite
+};
+
+/*
+    Signals are process wide, a signal is delivered to the self pipe of 
+    the engine that registered it last. Stored as fd + 1, zero means none.
+*/
+static std::atomic<int> signal_pipe[NSIG];
+static struct sigaction signal_action_old[NSIG];
+
+// EventDataBase
+
+EventEngineEpoll::EventDataBase::EventDataBase(EventEngineEpoll* engine)
+: _engine(engine), _state(Pending)
+{}
+
+EventEngineEpoll::EventDataBase::~EventDataBase() {
+    if (_index != SIZE_MAX) {
+        _engine->timer_remove(this);
+    }
+    if (_signal != 0) {
+        _engine->detach_signal(this);
+    }
+}
+
+// EventDataSimple
+
+EventEngineEpoll::EventDataSimple::EventDataSimple(
+    EventEngineEpoll* engine, 
+    EventHandleTimer* handle, 
+    EventCallback callback, 
+    void* arg)
+: EventDataBase(engine), _handle(handle), _callback(callback), _arg(arg)
+{}
+
+void EventEngineEpoll::EventDataSimple::fire(const error::Error& error) {
+    auto* handle = _handle;
+    _state = Running;
+    _callback(error, _arg);
+    if (_state == Deleted) {
+        handle->reset();
+    } else {
+        _state = Pending;
+    }
+}
+
+// EventDataSimpleFunctional
+
+EventEngineEpoll::EventDataSimpleFunctional::EventDataSimpleFunctional(
+    EventEngineEpoll* engine, 
+    EventHandleSignalFunctional* handle, 
+    std::function<void(const error::Error&)>&& callback)
+: EventDataBase(engine), _handle(handle), _callback(std::move(callback))
+{}
+
+void EventEngineEpoll::EventDataSimpleFunctional::fire(const error::Error& error) {
+    auto* handle = _handle;
+    _state = Running;
+    _callback(error);
+    if (_state == Deleted) {
+        handle->reset();
+    } else {
+        _state = Pending;
+    }
+}
+
+// EventDataIO
+
+EventEngineEpoll::EventDataIO::EventDataIO(
+    EventEngineEpoll* engine, 
+    EventHandleIO* handle, 
+    IOHandleNativeType io_handle, 
+    unsigned int flags, 
+    EventCallbackIO callback, 
+    void* arg)
+: _engine(engine), 
+  _handle(handle), 
+  _io_handle(io_handle), 
+  _flags(flags & IOFlagReadWrite), 
+  _state(Pending), 
+  _callback(callback), 
+  _arg(arg)
+{}
+
+EventEngineEpoll::EventDataIO::~EventDataIO() {
+    if (_attached) {
+        _engine->detach_io(this);
+    }
+}
+
+// backend
+
+const void* EventEngineEpoll::type_tag() {
+    return &epoll_type_tag;
+}
+
+template<typename Handle>
+ResultGeneric EventEngineEpoll::remove_simple(Handle& handle)
+{
+    if (handle.empty()) {
+        return Failed_;
+    }
+
+    if (handle.get()._state == Running) {
+        handle.get()._state = Deleted;
+    } else {
+        handle.reset();
+    }
+    return Successful_;
+}
+
+// io
+
+ResultGeneric EventEngineEpoll::register_io(IOHandleNativeType io_handle)
+{
+    if (io_handle < 0) {
+        return Failed_;
+    }
+
+    if (static_cast<size_t>(io_handle) >= _io_entries.size()) {
+        _io_entries.resize(io_handle + 1);
+    }
+
+    auto& entry = _io_entries[io_handle];
+    const auto epoch = posix::get_close_epoch(io_handle);
+    if (entry._registered and entry._epoch == epoch) {
+        return Successful_;
+    }
+
+    struct epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = io_handle;
+    ++_control_count;
+    if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, io_handle, &event) == 0) {
+        // a new file, the edges recorded belong to the closed one
+        entry._ready = 0;
+    } else if (errno != EEXIST) {
+        return Failed_;
+    }
+
+    entry._registered = true;
+    entry._epoch = epoch;
+    return Successful_;
+}
+
+void EventEngineEpoll::attach_io(EventDataIO* event)
+{
+    auto& entry = _io_entries[event->_io_handle];
+    event->_tick = _dispatch_tick;
+    for (int direction : {DirectionRead, DirectionWrite}) {
+        const auto flag = direction_flags[direction];
+        if ((event->_flags & flag) == 0) {
+            continue;
+        }
+
+        event->_next[direction] = entry._waiters[direction];
+        entry._waiters[direction] = event;
+
+        // the edge arrived before the waiter
+        if ((entry._ready & flag) != 0) {
+            entry._ready &= ~flag;
+            if (entry._pending == 0) {
+                _io_pending.push_back(event->_io_handle);
+            }
+            entry._pending |= flag;
+        }
+    }
+    event->_attached = true;
+    ++_active;
+}
+
+void EventEngineEpoll::detach_io(EventDataIO* event)
+{
+    auto& entry = _io_entries[event->_io_handle];
+    for (int direction : {DirectionRead, DirectionWrite}) {
+        if ((event->_flags & direction_flags[direction]) == 0) {
+            continue;
+        }
+
+        auto** next = &entry._waiters[direction];
+        while (*next != nullptr) {
+            if (*next == event) {
+                *next = event->_next[direction];
+                break;
+            }
+            next = &(*next)->_next[direction];
+        }
+        event->_next[direction] = nullptr;
+    }
+    event->_attached = false;
+    --_active;
+}
+
+void EventEngineEpoll::dispatch_io(IOHandleNativeType io_handle, unsigned int ready)
+{
+    for (int direction : {DirectionRead, DirectionWrite}) {
+        const auto flag = direction_flags[direction];
+        if ((ready & flag) == 0) {
+            continue;
+        }
+
+        bool fired = false;
+        for (;;) {
+            // callbacks may add fds and grow the entries
+            auto* event = _io_entries[io_handle]._waiters[direction];
+            while (event != nullptr and event->_tick == _dispatch_tick) {
+                event = event->_next[direction];
+            }
+            if (event == nullptr) {
+                break;
+            }
+
+            detach_io(event);
+            fired = true;
+            ++_dispatched;
+
+            auto* handle = event->_handle;
+            event->_state = Running;
+            event->_callback(event->_flags & ready, error::Error{}, event->_arg);
+            if (event->_state == Deleted) {
+                handle->reset();
+            } else {
+                event->_state = Pending;
+            }
+        }
+
+        auto& entry = _io_entries[io_handle];
+        if (not fired) {
+            entry._ready |= flag;
+        } else if (entry._waiters[direction] != nullptr) {
+            // waiters added by the callbacks missed this edge
+            if (entry._pending == 0) {
+                _io_pending.push_back(io_handle);
+            }
+            entry._pending |= flag;
+        }
+    }
+}
+
+void EventEngineEpoll::dispatch_io_pending()
+{
+    if (_io_pending.empty()) {
+        return;
+    }
+
+    std::vector<int> pending{};
+    pending.swap(_io_pending);
+    for (auto io_handle : pending) {
+        auto& entry = _io_entries[io_handle];
+        const auto ready = entry._pending;
+        entry._pending = 0;
+        dispatch_io(io_handle, ready);
+    }
+}
+
+ResultGeneric EventEngineEpoll::add_io(
+    Awaitable* awaitable,
+    unsigned int flags, 
+    EventHandleIO& event_handle, 
+    IOHandleNativeType io_handle, 
+    EventCallbackIO callback, 
+    void* arg)
+{
+    auto* self = get_event_engine<EventEngineEpoll>(awaitable);
+    return self->add_io(flags, event_handle, io_handle, callback, arg);
+}
+
+ResultGeneric EventEngineEpoll::add_io(
+    unsigned int flags, 
+    EventHandleIO& event_handle, 
+    IOHandleNativeType io_handle, 
+    EventCallbackIO callback, 
+    void* arg)
+{
+    event_handle.reset();
+    if (register_io(io_handle).is(Failed_)) {
+        return Failed_;
+    }
+    event_handle.emplace(this, &event_handle, io_handle, flags, callback, arg);
+    attach_io(&event_handle.get());
+    return Successful_;
+}
+
+ResultGeneric EventEngineEpoll::remove_io(Awaitable* awaitable, EventHandleIO& handle) // NOLINT
+{
+    auto* self = get_event_engine<EventEngineEpoll>(awaitable);
+    return self->remove_io(handle);
+}
+
+ResultGeneric EventEngineEpoll::remove_io(EventHandleIO& handle) // NOLINT
+{
+    return remove_simple(handle);
+}
+
+// timer
+
+void EventEngineEpoll::timer_sift_up(size_t index)
+{
+    auto* event = _timers[index];
+    while (index > 0) {
+        const size_t parent = (index - 1) / 2;
+        if (not (event->_deadline < _timers[parent]->_deadline)) {
+            break;
+        }
+        _timers[index] = _timers[parent];
+        _timers[index]->_index = index;
+        index = parent;
+    }
+    _timers[index] = event;
+    event->_index = index;
+}
+
+void EventEngineEpoll::timer_sift_down(size_t index)
+{
+    auto* event = _timers[index];
+    const size_t size = _timers.size();
+    for (;;) {
+        size_t child = index * 2 + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size and _timers[child + 1]->_deadline < _timers[child]->_deadline) {
+            child += 1;
+        }
+        if (not (_timers[child]->_deadline < event->_deadline)) {
+            break;
+        }
+        _timers[index] = _timers[child];
+        _timers[index]->_index = index;
+        index = child;
+    }
+    _timers[index] = event;
+    event->_index = index;
+}
+
+void EventEngineEpoll::timer_push(EventDataBase* event)
+{
+    _timers.push_back(event);
+    timer_sift_up(_timers.size() - 1);
+    ++_active;
+}
+
+void EventEngineEpoll::timer_remove(EventDataBase* event)
+{
+    const size_t index = event->_index;
+    event->_index = SIZE_MAX;
+    --_active;
+
+    auto* last = _timers.back();
+    _timers.pop_back();
+    if (last == event) {
+        return;
+    }
+
+    _timers[index] = last;
+    last->_index = index;
+    if (index > 0 and last->_deadline < _timers[(index - 1) / 2]->_deadline) {
+        timer_sift_up(index);
+    } else {
+        timer_sift_down(index);
+    }
+}
+
+void EventEngineEpoll::dispatch_timers()
+{
+    if (_timers.empty()) {
+        return;
+    }
+
+    const auto now = Clock::now();
+    while (not _timers.empty() and _timers.front()->_deadline <= now) {
+        auto* event = _timers.front();
+        timer_remove(event);
+        ++_dispatched;
+        event->fire(make_error(posix::ErrorPosix::TimedOut));
+    }
+}
+
+int EventEngineEpoll::get_timeout() const noexcept
+{
+    if (_timers.empty()) {
+        return -1;
+    }
+
+    const auto wait = _timers.front()->_deadline - Clock::now();
+    if (wait <= Clock::duration::zero()) {
+        return 0;
+    }
+
+    // round up, never wake before the deadline
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        wait + std::chrono::milliseconds(1) - Clock::duration(1)).count();
+    return ms > INT_MAX ? INT_MAX : static_cast<int>(ms);
+}
+
+ResultGeneric EventEngineEpoll::add_timer(
+    Awaitable* awaitable, 
+    EventHandleTimer& timer, 
+    struct timeval* timeval, 
+    EventCallback callback, 
+    void* arg)
+{
+    auto* self = get_event_engine<EventEngineEpoll>(awaitable);
+    return self->add_timer(timer, timeval, callback, arg);
+}
+
+ResultGeneric EventEngineEpoll::add_timer(
+    EventHandleTimer& timer, 
+    struct timeval* timeval, 
+    EventCallback callback, 
+    void* arg)
+{
+    timer.reset();
+    timer.emplace(this, &timer, callback, arg);
+
+    auto& event = timer.get();
+    event._deadline = Clock::now();
+    if (timeval != nullptr) {
+        event._deadline += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::seconds(timeval->tv_sec) + std::chrono::microseconds(timeval->tv_usec));
+    }
+    timer_push(&event);
+    return Successful_;
+}
+
+ResultGeneric EventEngineEpoll::remove_timer(
+    Awaitable* awaitable, 
+    EventHandleTimer& timer) 
+{
+    auto* self = get_event_engine<EventEngineEpoll>(awaitable);
+    return self->remove_timer(timer);
+}
+
+ResultGeneric EventEngineEpoll::remove_timer(
+    EventHandleTimer& timer) 
+{
+    return remove_simple(timer);
+}
+
+// signal
+
+void EventEngineEpoll::signal_handler(int sig)
+{
+    const int saved_errno = errno;
+    const int io_handle = signal_pipe[sig].load(std::memory_order_relaxed) - 1;
+    if (io_handle >= 0) {
+        const auto value = static_cast<unsigned char>(sig);
+        while (::write(io_handle, &value, sizeof(value)) == -1 and errno == EINTR) { }
+    }
+    errno = saved_errno;
+}
+
+ResultGeneric EventEngineEpoll::attach_signal(EventDataBase* event, int sig)
+{
+    if (sig <= 0 or sig >= NSIG) {
+        return Failed_;
+    }
+
+    if (_signal_fd[0] == -1) {
+        if (::pipe2(_signal_fd, O_NONBLOCK | O_CLOEXEC) != 0) {
+            return Failed_;
+        }
+        struct epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = _signal_fd[0];
+        ++_control_count;
+        if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _signal_fd[0], &ev) != 0) {
+            error::fatal("unable to register signal pipe");
+        }
+    }
+
+    if (_signals[sig] == nullptr) {
+        struct sigaction action{};
+        action.sa_handler = &EventEngineEpoll::signal_handler;
+        action.sa_flags = SA_RESTART;
+        sigfillset(&action.sa_mask);
+
+        const int installed = signal_pipe[sig].exchange(_signal_fd[1] + 1);
+        if (installed == 0 and ::sigaction(sig, &action, &signal_action_old[sig]) != 0) {
+            signal_pipe[sig].store(0);
+            return Failed_;
+        }
+    }
+
+    event->_signal = sig;
+    event->_tick = _dispatch_tick;
+    event->_next = _signals[sig];
+    _signals[sig] = event;
+    ++_active;
+    return Successful_;
+}
+
+void EventEngineEpoll::detach_signal(EventDataBase* event)
+{
+    const int sig = event->_signal;
+    auto** next = &_signals[sig];
+    while (*next != nullptr) {
+        if (*next == event) {
+            *next = event->_next;
+            break;
+        }
+        next = &(*next)->_next;
+    }
+    event->_next = nullptr;
+    event->_signal = 0;
+    --_active;
+
+    if (_signals[sig] == nullptr) {
+        int installed = _signal_fd[1] + 1;
+        if (signal_pipe[sig].compare_exchange_strong(installed, 0)) {
+            ::sigaction(sig, &signal_action_old[sig], nullptr);
+        }
+    }
+}
+
+void EventEngineEpoll::dispatch_signals()
+{
+    bool raised[NSIG]{};
+    unsigned char buffer[64];
+    long size = 0;
+    while ((size = ::read(_signal_fd[0], buffer, sizeof(buffer))) > 0) {
+        for (long i = 0; i < size; ++i) {
+            raised[buffer[i]] = true;
+        }
+    }
+
+    for (int sig = 1; sig < NSIG; ++sig) {
+        if (not raised[sig]) {
+            continue;
+        }
+        for (;;) {
+            auto* event = _signals[sig];
+            while (event != nullptr and event->_tick == _dispatch_tick) {
+                event = event->_next;
+            }
+            if (event == nullptr) {
+                break;
+            }
+            detach_signal(event);
+            ++_dispatched;
+            event->fire(error::Error{});
+        }
+    }
+}
+
+ResultGeneric EventEngineEpoll::add_signal(
+    Awaitable* awaitable, 
+    EventHandleSignal& signal, 
+    int sig, 
+    EventCallback callback, 
+    void* arg)
+{
+    auto* self = get_event_engine<EventEngineEpoll>(awaitable);
+    return self->add_signal(signal, sig, callback, arg);
+}
+
+ResultGeneric EventEngineEpoll::add_signal(
+    EventHandleSignal& signal, 
+    int sig, 
+    EventCallback callback, 
+    void* arg)
+{
+    signal.reset();
+    signal.emplace(this, &signal, callback, arg);
+
+    static_assert(std::is_same<EventHandleTimer, EventHandleSignal>::value, 
+        "do not touch this class");
+
+    if (attach_signal(&signal.get(), sig).is(Failed_)) {
+        signal.reset();
+        return Failed_;
+    }
+    return Successful_;
+}
+
+ResultGeneric EventEngineEpoll::remove_signal(
+    Awaitable* awaitable, 
+    EventHandleSignal& signal) 
+{
+    auto* self = get_event_engine<EventEngineEpoll>(awaitable);
+    return self->remove_signal(signal);
+}
+
+ResultGeneric EventEngineEpoll::remove_signal(
+    EventHandleSignal& signal) 
+{
+    return remove_simple(signal);
+}
+
+ResultGeneric EventEngineEpoll::add_signal(
+    EventHandleSignalFunctional& signal, 
+    int sig, 
+    std::function<void(const error::Error&)>&& callback)
+{
+    signal.reset();
+    signal.emplace(this, &signal, std::move(callback));
+
+    if (attach_signal(&signal.get(), sig).is(Failed_)) {
+        signal.reset();
+        return Failed_;
+    }
+    return Successful_;
+}
+
+ResultGeneric EventEngineEpoll::remove_signal(
+    EventHandleSignalFunctional& signal) 
+{
+    return remove_simple(signal);
+}
+
+// poll
+
+void EventEngineEpoll::notify_drain()
+{
+    uint64_t value = 0;
+    while (::read(_notify_fd, &value, sizeof(value)) > 0) { }
+
+    // synchronize with the producers, the tasks they pushed are visible after this point
+    _notified.exchange(false, std::memory_order_acq_rel);
+}
+
+void EventEngineEpoll::poll(bool non_blocking)
+{
+    non_blocking = non_blocking or _non_blocking or _additional_non_blocking;
+    _additional_non_blocking = false;
+
+    for (;;) {
+        // nothing could ever wake up this poll
+        if (_active == 0 and _notify_fd == -1 and _io_pending.empty() and not _no_exit_on_empty) {
+            return;
+        }
+
+        int timeout = non_blocking or not _io_pending.empty() ? 0 : get_timeout();
+        int count = ::epoll_wait(_epoll_fd, _events, MaxEvents, timeout);
+        if (count < 0) {
+            if (errno != EINTR) {
+                error::fatal("epoll_wait failed");
+            }
+            count = 0;
+        }
+
+        _dispatched = 0;
+        ++_dispatch_tick;
+
+        dispatch_io_pending();
+
+        for (int i = 0; i < count; ++i) {
+            const auto& event = _events[i];
+            const int io_handle = event.data.fd;
+            if (io_handle == _notify_fd) {
+                notify_drain();
+                ++_dispatched;
+                continue;
+            }
+            if (io_handle == _signal_fd[0]) {
+                dispatch_signals();
+                continue;
+            }
+            if (io_handle == _completion_fd) {
+                dispatch_completions();
+                continue;
+            }
+
+            unsigned int ready = 0;
+            if ((event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0) {
+                ready |= IOFlagRead;
+            }
+            if ((event.events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0) {
+                ready |= IOFlagWrite;
+            }
+            if (static_cast<size_t>(io_handle) < _io_entries.size()) {
+                dispatch_io(io_handle, ready);
+            }
+        }
+
+        dispatch_timers();
+
+        if (non_blocking or _dispatched != 0 or _additional_non_blocking) {
+            _additional_non_blocking = false;
+            return;
+        }
+    }
+}
+
+void EventEngineEpoll::poll()
+{
+    poll(false);
+}
+
+void EventEngineEpoll::poll_non_blocking()
+{
+    poll(true);
+}
+
+void EventEngineEpoll::wakeup() {
+    if (_notify_fd == -1) {
+        _additional_non_blocking = true;
+        return;
+    }
+
+    if (_notified.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    uint64_t value = 1;
+    int err = 0;
+    do {
+        err = ::write(_notify_fd, &value, sizeof(value)) == -1 ? errno : 0;
+    } while(err == EINTR);
+}
+
+void EventEngineEpoll::set_non_blocking(bool enable)
+{
+    _non_blocking = enable;
+}
+
+void EventEngineEpoll::set_no_exit_on_empty(bool enable)
+{
+    _no_exit_on_empty = enable;
+}
+
+EventEngineEpoll::EventEngineEpoll(bool thread_safe)
+{
+    _epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+        error::fatal("unable to create epoll fd");
+    }
+
+    if (thread_safe) {
+        _notify_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_notify_fd == -1) {
+            error::fatal("unable to create notify fd");
+        }
+        struct epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = _notify_fd;
+        ++_control_count;
+        if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _notify_fd, &event) != 0) {
+            error::fatal("unable to register notify fd");
+        }
+    }
+}
+
+EventEngineEpoll::~EventEngineEpoll() {
+    for (int sig = 1; sig < NSIG; ++sig) {
+        int installed = _signal_fd[1] + 1;
+        if (_signals[sig] != nullptr and signal_pipe[sig].compare_exchange_strong(installed, 0)) {
+            ::sigaction(sig, &signal_action_old[sig], nullptr);
+        }
+    }
+
+    if (_signal_fd[0] != -1) {
+        ::close(_signal_fd[0]);
+        ::close(_signal_fd[1]);
+    }
+    if (_notify_fd != -1) {
+        ::close(_notify_fd);
+    }
+    ::close(_epoll_fd);
+}
+
+} // namespace epoll
+} // namespace jinx
+
+#endif // __linux__
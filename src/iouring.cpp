@@ -0,0 +1,794 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include <jinx/logging.hpp>
+#include <jinx/macros.hpp>
+#include <jinx/iouring.hpp>
+
+namespace jinx {
+namespace iouring {
+
+struct EventEngineIoUring::Operation {
+    EventHandleCompletion* _handle{nullptr};
+    EventCallbackComplete _callback{nullptr};
+    EventCallbackBuffer _callback_buffer{nullptr};
+    void* _arg{nullptr};
+    // multishot receive, the buffers come from the ring, null once the ring is unregistered
+    BufferRing* _ring{nullptr};
+    // kept until the completion without IORING_CQE_F_MORE
+    bool _multishot{false};
+    // io_uring opcode, a dropped accept closes its descriptor
+    unsigned char _opcode{IORING_OP_NOP};
+    Operation* _next{nullptr};
+};
+
+static const char iouring_type_tag = 0;
+
+static
+inline
+int io_uring_setup(unsigned int entries, struct io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static
+inline
+int io_uring_enter(int ring_fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static
+inline
+int io_uring_register(int ring_fd, unsigned int opcode, void* arg, unsigned int nr_args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+static
+inline
+unsigned int* ring_field(void* ring, uint32_t offset) {
+    return reinterpret_cast<unsigned int*>(static_cast<char*>(ring) + offset);
+}
+
+// opcodes of posix::IOOpcode
+static const int iouring_opcodes[] = {
+    -1,
+    IORING_OP_READ,
+    IORING_OP_WRITE,
+    IORING_OP_READV,
+    IORING_OP_WRITEV,
+    IORING_OP_RECV,
+    IORING_OP_SEND,
+    IORING_OP_RECVMSG,
+    IORING_OP_SENDMSG,
+    IORING_OP_ACCEPT,
+};
+
+// operations of posix::IOOpcode submitted without calling them first
+static const bool submit_first[] = {
+    false,
+    true,
+    false,
+    true,
+    false,
+    true,
+    false,
+    true,
+    false,
+    true,
+};
+
+const void* EventEngineIoUring::type_tag() {
+    return &iouring_type_tag;
+}
+
+bool EventEngineIoUring::has_type_tag(const void* tag) {
+    return tag == type_tag() or tag == EventEngineEpoll::type_tag();
+}
+
+// setup
+
+bool EventEngineIoUring::setup(unsigned int entries)
+{
+    struct io_uring_params params{};
+    _ring_fd = io_uring_setup(entries, &params);
+    if (_ring_fd < 0) {
+        _ring_fd = -1;
+        return false;
+    }
+
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        _sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+    }
+
+    _sq_ring = ::mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, 
+        _ring_fd, IORING_OFF_SQ_RING);
+    if (_sq_ring == MAP_FAILED) {
+        _sq_ring = nullptr;
+        return false;
+    }
+
+    if (single_mmap) {
+        _cq_ring = _sq_ring;
+    } else {
+        _cq_ring = ::mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, 
+            _ring_fd, IORING_OFF_CQ_RING);
+        if (_cq_ring == MAP_FAILED) {
+            _cq_ring = nullptr;
+            return false;
+        }
+    }
+
+    _sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = ::mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, 
+        _ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return false;
+    }
+    _sqes = static_cast<struct io_uring_sqe*>(sqes);
+
+    _sq_head = ring_field(_sq_ring, params.sq_off.head);
+    _sq_tail = ring_field(_sq_ring, params.sq_off.tail);
+    _sq_array = ring_field(_sq_ring, params.sq_off.array);
+    _sq_mask = *ring_field(_sq_ring, params.sq_off.ring_mask);
+    _sq_entries = *ring_field(_sq_ring, params.sq_off.ring_entries);
+
+    _cq_head = ring_field(_cq_ring, params.cq_off.head);
+    _cq_tail = ring_field(_cq_ring, params.cq_off.tail);
+    _cq_mask = *ring_field(_cq_ring, params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<struct io_uring_cqe*>(static_cast<char*>(_cq_ring) + params.cq_off.cqes);
+
+    // the sqe of a slot is always the one with the same index
+    for (unsigned i = 0; i < _sq_entries; ++i) {
+        _sq_array[i] = i;
+    }
+    _sq_local_tail = _sq_submitted = *_sq_tail;
+
+    probe();
+
+    // the ring is readable when there are completions
+    struct epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = _ring_fd;
+    if (::epoll_ctl(get_epoll_handle(), EPOLL_CTL_ADD, _ring_fd, &event) != 0) {
+        return false;
+    }
+    _completion_fd = _ring_fd;
+    return true;
+}
+
+void EventEngineIoUring::probe()
+{
+    const unsigned int count = 256;
+    std::vector<char> buffer(sizeof(struct io_uring_probe) + count * sizeof(struct io_uring_probe_op), 0);
+    auto* probe = reinterpret_cast<struct io_uring_probe*>(buffer.data());
+
+    // no probe before 5.6, neither recv nor send, keep the readiness path
+    if (io_uring_register(_ring_fd, IORING_REGISTER_PROBE, probe, count) < 0) {
+        return;
+    }
+
+    for (size_t i = 1; i < sizeof(iouring_opcodes) / sizeof(iouring_opcodes[0]); ++i) {
+        const int opcode = iouring_opcodes[i];
+        _supported[i] = opcode <= probe->last_op 
+            and (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+
+    // a kernel without multishot receive fails the first completion with EINVAL
+    _recv_multishot = _supported[static_cast<size_t>(posix::IOOpcode::Recv)];
+
+    // no operation has the user data 0, ENOENT if the kernel cancels synchronously
+    struct io_uring_sync_cancel_reg reg{};
+    reg.timeout.tv_sec = -1;
+    reg.timeout.tv_nsec = -1;
+    _sync_cancel = io_uring_register(_ring_fd, IORING_REGISTER_SYNC_CANCEL, &reg, 1) == 0 or errno == ENOENT;
+}
+
+void EventEngineIoUring::release()
+{
+    if (_ring_fd != -1) {
+        ::close(_ring_fd);
+        _ring_fd = -1;
+    }
+    _completion_fd = -1;
+
+    if (_sqes != nullptr) {
+        ::munmap(_sqes, _sqes_size);
+        _sqes = nullptr;
+    }
+    if (_cq_ring != nullptr and _cq_ring != _sq_ring) {
+        ::munmap(_cq_ring, _cq_ring_size);
+    }
+    _cq_ring = nullptr;
+    if (_sq_ring != nullptr) {
+        ::munmap(_sq_ring, _sq_ring_size);
+        _sq_ring = nullptr;
+    }
+}
+
+EventEngineIoUring::EventEngineIoUring(bool thread_safe, unsigned int entries)
+: EventEngineEpoll(thread_safe)
+{
+    if (entries != 0 and not setup(entries)) {
+        release();
+    }
+}
+
+EventEngineIoUring::~EventEngineIoUring()
+{
+    // the rings outliving the engine are left alone
+    for (auto* ring : _buffer_rings) {
+        if (ring != nullptr) {
+            ring->_group = -1;
+        }
+    }
+    release();
+    for (auto* operation : _operations) {
+        delete operation;
+    }
+}
+
+// rings
+
+struct io_uring_sqe* EventEngineIoUring::get_sqe()
+{
+    unsigned head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+    if (_sq_local_tail - head >= _sq_entries) {
+        submit();
+        head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+        if (_sq_local_tail - head >= _sq_entries) {
+            return nullptr;
+        }
+    }
+
+    auto* sqe = &_sqes[_sq_local_tail & _sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    ++_sq_local_tail;
+    return sqe;
+}
+
+void EventEngineIoUring::submit()
+{
+    const unsigned to_submit = _sq_local_tail - _sq_submitted;
+    if (to_submit == 0) {
+        return;
+    }
+
+    __atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+
+    int submitted = 0;
+    do {
+        ++_enter_count;
+        submitted = io_uring_enter(_ring_fd, to_submit, 0, 0);
+    } while (submitted < 0 and errno == EINTR);
+
+    // EAGAIN or EBUSY, the rest is submitted by the next poll
+    if (submitted > 0) {
+        _sq_submitted += submitted;
+    }
+}
+
+size_t EventEngineIoUring::reap()
+{
+    size_t count = 0;
+    unsigned head = *_cq_head;
+    for (;;) {
+        const unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            break;
+        }
+
+        while (head != tail) {
+            const auto& cqe = _cqes[head & _cq_mask];
+            auto* operation = reinterpret_cast<Operation*>(static_cast<uintptr_t>(cqe.user_data));
+            const long result = cqe.res;
+            const unsigned int flags = cqe.flags;
+            ++head;
+            __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+
+            // completion of a cancellation
+            if (operation == nullptr) {
+                continue;
+            }
+
+            if (operation->_multishot) {
+                count += reap_buffer(operation, result, flags);
+                continue;
+            }
+
+            auto* handle = operation->_handle;
+            auto callback = operation->_callback;
+            auto* arg = operation->_arg;
+
+            operation->_next = _free_operations;
+            _free_operations = operation;
+            --_active;
+            ++_complete_count;
+
+            // cancelled, the awaitable is gone
+            if (callback == nullptr) {
+                if (operation->_opcode == IORING_OP_ACCEPT and result >= 0) {
+                    ::close(static_cast<int>(result));
+                }
+                continue;
+            }
+
+            handle->_operation = nullptr;
+            ++_dispatched;
+            ++count;
+            callback(result, arg);
+        }
+    }
+    return count;
+}
+
+size_t EventEngineIoUring::reap_buffer(Operation* operation, long result, unsigned int flags)
+{
+    auto* ring = operation->_ring;
+    auto* handle = operation->_handle;
+    auto callback = operation->_callback_buffer;
+    auto* arg = operation->_arg;
+
+    const bool more = (flags & IORING_CQE_F_MORE) != 0;
+    const int buffer_id = (flags & IORING_CQE_F_BUFFER) != 0 
+        ? static_cast<int>(flags >> IORING_CQE_BUFFER_SHIFT) : -1;
+
+    if (not more) {
+        operation->_ring = nullptr;
+        operation->_multishot = false;
+        operation->_next = _free_operations;
+        _free_operations = operation;
+        --_active;
+        ++_complete_count;
+
+        if (result == -EINVAL and buffer_id == -1) {
+            _recv_multishot = false;
+            result = -EAGAIN;
+        }
+    }
+
+    // cancelled, the awaitable is gone
+    if (callback == nullptr) {
+        if (buffer_id != -1 and ring != nullptr and ring->is_registered()) {
+            ring->drop(static_cast<uint16_t>(buffer_id));
+        }
+        return 0;
+    }
+
+    if (not more) {
+        handle->_operation = nullptr;
+    }
+    if (buffer_id != -1) {
+        ring->_provided -= 1;
+    }
+    ++_dispatched;
+    callback(result, buffer_id, more, arg);
+    return 1;
+}
+
+// operations
+
+EventEngineIoUring::Operation* EventEngineIoUring::get_operation(EventHandleCompletion& handle, void* arg)
+{
+    Operation* operation = _free_operations;
+    if (operation != nullptr) {
+        _free_operations = operation->_next;
+    } else {
+        operation = new(std::nothrow) Operation{};
+        if (operation == nullptr) {
+            return nullptr;
+        }
+        _operations.push_back(operation);
+    }
+    operation->_handle = &handle;
+    operation->_callback = nullptr;
+    operation->_callback_buffer = nullptr;
+    operation->_arg = arg;
+    operation->_ring = nullptr;
+    operation->_multishot = false;
+    operation->_opcode = IORING_OP_NOP;
+    operation->_next = nullptr;
+    handle._operation = operation;
+
+    ++_active;
+    ++_submit_count;
+    return operation;
+}
+
+ResultGeneric EventEngineIoUring::submit_io(
+    EventHandleCompletion& handle, 
+    const posix::IORequest& request, 
+    bool would_block,
+    EventCallbackComplete callback, 
+    void* arg)
+{
+    // the buffers of the operation can be released only after a synchronous cancellation
+    if (_ring_fd == -1 or not _sync_cancel or not _supported[static_cast<size_t>(request._opcode)]) {
+        return Failed_;
+    }
+
+    if (not would_block and not submit_first[static_cast<size_t>(request._opcode)]) {
+        return Failed_;
+    }
+
+    jinx_assert(handle.empty());
+
+    auto* sqe = get_sqe();
+    if (sqe == nullptr) {
+        return Failed_;
+    }
+
+    sqe->opcode = static_cast<__u8>(iouring_opcodes[static_cast<size_t>(request._opcode)]);
+    sqe->fd = request._io_handle;
+    sqe->addr = reinterpret_cast<uintptr_t>(request._data);
+    switch (request._opcode) {
+    case posix::IOOpcode::Read:
+    case posix::IOOpcode::Write:
+    case posix::IOOpcode::ReadV:
+    case posix::IOOpcode::WriteV:
+        sqe->len = static_cast<__u32>(request._size);
+        // the current file position
+        sqe->off = static_cast<__u64>(-1);
+        break;
+    case posix::IOOpcode::Recv:
+    case posix::IOOpcode::Send:
+        sqe->len = static_cast<__u32>(request._size);
+        sqe->msg_flags = static_cast<__u32>(request._flags);
+        break;
+    case posix::IOOpcode::RecvMsg:
+    case posix::IOOpcode::SendMsg:
+        sqe->len = 1;
+        sqe->msg_flags = static_cast<__u32>(request._flags);
+        break;
+    case posix::IOOpcode::Accept:
+        sqe->addr2 = reinterpret_cast<uintptr_t>(request._address_len);
+        break;
+    case posix::IOOpcode::None:
+        break;
+    }
+
+    auto* operation = get_operation(handle, arg);
+    if (operation == nullptr) {
+        drop_sqe(sqe);
+        return Failed_;
+    }
+    operation->_callback = callback;
+    operation->_opcode = sqe->opcode;
+    sqe->user_data = reinterpret_cast<uintptr_t>(operation);
+    return Successful_;
+}
+
+ResultGeneric EventEngineIoUring::cancel_io(EventHandleCompletion& handle)
+{
+    auto* operation = handle._operation;
+    if (operation == nullptr) {
+        return Successful_;
+    }
+
+    // the completion is dropped, the operation is recycled when it arrives
+    handle._operation = nullptr;
+    operation->_handle = nullptr;
+    operation->_callback = nullptr;
+    operation->_callback_buffer = nullptr;
+    operation->_arg = nullptr;
+
+    // not seen by the kernel yet
+    if (discard_unsubmitted(operation)) {
+        return Successful_;
+    }
+
+    // the buffers of a multishot receive belong to its ring
+    if (operation->_multishot) {
+        return submit_cancel(operation);
+    }
+
+    // the caller releases the buffers next, wait for the kernel to let go of them
+    struct io_uring_sync_cancel_reg reg{};
+    reg.addr = reinterpret_cast<uintptr_t>(operation);
+    reg.timeout.tv_sec = -1;
+    reg.timeout.tv_nsec = -1;
+    int ret = 0;
+    do {
+        ret = io_uring_register(_ring_fd, IORING_REGISTER_SYNC_CANCEL, &reg, 1);
+    } while (ret < 0 and errno == EINTR);
+
+    // ENOENT, it completed before
+    if (ret == 0 or errno == ENOENT) {
+        return Successful_;
+    }
+    return Failed_;
+}
+
+ResultGeneric EventEngineIoUring::interrupt_io(EventHandleCompletion& handle)
+{
+    auto* operation = handle._operation;
+    if (operation == nullptr) {
+        return Failed_;
+    }
+    return submit_cancel(operation);
+}
+
+void EventEngineIoUring::drop_sqe(struct io_uring_sqe* sqe) noexcept
+{
+    // already queued, it completes as a NOP that nobody waits for
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = 0;
+}
+
+bool EventEngineIoUring::discard_unsubmitted(Operation* operation) noexcept
+{
+    const auto user_data = reinterpret_cast<uintptr_t>(operation);
+    for (unsigned index = _sq_submitted; index != _sq_local_tail; ++index) {
+        auto* sqe = &_sqes[index & _sq_mask];
+        if (sqe->user_data == user_data) {
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_NOP;
+            sqe->user_data = user_data;
+            operation->_opcode = IORING_OP_NOP;
+            return true;
+        }
+    }
+    return false;
+}
+
+ResultGeneric EventEngineIoUring::submit_cancel(Operation* operation)
+{
+    auto* sqe = get_sqe();
+    if (sqe == nullptr) {
+        return Failed_;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uintptr_t>(operation);
+    sqe->user_data = 0;
+    return Successful_;
+}
+
+ResultGeneric EventEngineIoUring::submit_recv(
+    EventHandleCompletion& handle,
+    IOHandleNativeType io_handle,
+    BufferRing& ring,
+    EventCallbackBuffer callback,
+    void* arg)
+{
+    if (_ring_fd == -1 or not _recv_multishot or not ring.is_registered()) {
+        return Failed_;
+    }
+
+    jinx_assert(handle.empty());
+
+    auto* sqe = get_sqe();
+    if (sqe == nullptr) {
+        return Failed_;
+    }
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = io_handle;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = static_cast<__u16>(ring._group);
+
+    auto* operation = get_operation(handle, arg);
+    if (operation == nullptr) {
+        drop_sqe(sqe);
+        return Failed_;
+    }
+    operation->_callback_buffer = callback;
+    operation->_ring = &ring;
+    operation->_multishot = true;
+    sqe->user_data = reinterpret_cast<uintptr_t>(operation);
+    return Successful_;
+}
+
+// buffer rings
+
+ResultGeneric EventEngineIoUring::register_buffer_ring(BufferRing* ring)
+{
+    if (_ring_fd == -1) {
+        return Failed_;
+    }
+
+    size_t group = 0;
+    while (group < _buffer_rings.size() and _buffer_rings[group] != nullptr) {
+        ++group;
+    }
+
+    struct io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uintptr_t>(ring->_ring);
+    reg.ring_entries = ring->_entries;
+    reg.bgid = static_cast<__u16>(group);
+    if (io_uring_register(_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        return Failed_;
+    }
+
+    if (group == _buffer_rings.size()) {
+        _buffer_rings.push_back(ring);
+    } else {
+        _buffer_rings[group] = ring;
+    }
+    ring->_group = static_cast<int>(group);
+    return Successful_;
+}
+
+void EventEngineIoUring::unregister_buffer_ring(BufferRing* ring)
+{
+    struct io_uring_buf_reg reg{};
+    reg.bgid = static_cast<__u16>(ring->_group);
+    io_uring_register(_ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+
+    // the receives of the ring are dropped and cancelled, each is recycled on its last completion
+    for (auto* operation : _operations) {
+        if (operation->_ring == ring) {
+            if (operation->_handle != nullptr) {
+                operation->_handle->_operation = nullptr;
+            }
+            operation->_handle = nullptr;
+            operation->_callback_buffer = nullptr;
+            operation->_arg = nullptr;
+            operation->_ring = nullptr;
+            submit_cancel(operation) >> JINX_IGNORE_RESULT;
+        }
+    }
+    _buffer_rings[static_cast<size_t>(ring->_group)] = nullptr;
+    ring->_group = -1;
+}
+
+BufferRing::BufferRing(EventEngineIoUring& engine, unsigned int entries)
+: _engine(engine)
+{
+    _entries = 1;
+    while (_entries < entries and _entries < 32768) {
+        _entries <<= 1;
+    }
+
+    _ring_size = _entries * sizeof(struct io_uring_buf);
+    void* ring = ::mmap(nullptr, _ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        return;
+    }
+    _ring = ring;
+    _tail = 0;
+
+    if (_engine.register_buffer_ring(this).is(Failed_)) {
+        ::munmap(_ring, _ring_size);
+        _ring = nullptr;
+        return;
+    }
+
+    for (unsigned int i = 0; i < _entries; ++i) {
+        _missing.push_back(static_cast<uint16_t>(_entries - 1 - i));
+    }
+}
+
+BufferRing::~BufferRing()
+{
+    unregister();
+    if (_ring != nullptr) {
+        ::munmap(_ring, _ring_size);
+        _ring = nullptr;
+    }
+}
+
+void BufferRing::unregister() noexcept
+{
+    if (_group != -1) {
+        _engine.unregister_buffer_ring(this);
+    }
+    _provided = 0;
+    _missing.clear();
+}
+
+void BufferRing::provide(uint16_t buffer_id, void* memory, size_t size) noexcept
+{
+    auto* buf = &static_cast<struct io_uring_buf*>(_ring)[_tail & (_entries - 1)];
+    buf->addr = reinterpret_cast<uintptr_t>(memory);
+    buf->len = static_cast<__u32>(size);
+    buf->bid = buffer_id;
+    ++_tail;
+    ++_provided;
+}
+
+void BufferRing::publish() noexcept
+{
+    // the tail overlays resv of the first entry, io_uring_buf_ring::bufs is off by the 
+    // empty struct of __DECLARE_FLEX_ARRAY in c++
+    __atomic_store_n(&static_cast<struct io_uring_buf*>(_ring)->resv, _tail, __ATOMIC_RELEASE);
+}
+
+void BufferRing::picked(uint16_t buffer_id)
+{
+    if (_group == -1) {
+        return;
+    }
+    if (refill(buffer_id)) {
+        publish();
+    } else {
+        _missing.push_back(buffer_id);
+    }
+}
+
+void BufferRing::drop(uint16_t buffer_id) noexcept
+{
+    _provided -= 1;
+    recycle(buffer_id);
+    publish();
+}
+
+void BufferRing::fill()
+{
+    if (_group == -1 or _missing.empty()) {
+        return;
+    }
+    while (not _missing.empty() and refill(_missing.back())) {
+        _missing.pop_back();
+    }
+    publish();
+}
+
+// poll
+
+void EventEngineIoUring::dispatch_completions()
+{
+    submit();
+    reap();
+}
+
+void EventEngineIoUring::poll()
+{
+    if (_ring_fd == -1) {
+        EventEngineEpoll::poll(false);
+        return;
+    }
+
+    submit();
+    EventEngineEpoll::poll(reap() != 0);
+}
+
+void EventEngineIoUring::poll_non_blocking()
+{
+    if (_ring_fd == -1) {
+        EventEngineEpoll::poll(true);
+        return;
+    }
+
+    submit();
+    reap();
+    EventEngineEpoll::poll(true);
+}
+
+} // namespace iouring
+} // namespace jinx
+
+#endif // __linux__
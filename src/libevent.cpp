@@ -28,6 +28,10 @@ SOFTWARE.
 #include <unistd.h>
 #include <event2/event.h>
 
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
 #include <jinx/logging.hpp>
 #include <jinx/macros.hpp>
 #include <jinx/libevent.hpp>
@@ -71,6 +75,37 @@ EventEngineLibevent::EventDataIO::~EventDataIO() {
     event_del(&_event);
 }
 
+// EventDataRegistration
+
+static const short registration_flags[2] = { EV_READ, EV_WRITE };
+
+void EventEngineLibevent::EventDataRegistration::callback(int io_handle, short event, void* args) {
+    auto* handle = static_cast<Optional<EventDataRegistration>*>(args);
+    auto& self = handle->get();
+    for (int i = 0; i < 2; ++i) {
+        if ((event & registration_flags[i]) == 0) {
+            continue;
+        }
+        auto callback = self._callbacks[i];
+        if (callback == nullptr) {
+            self._ready[i] = true;
+            continue;
+        }
+        auto* arg = self._args[i];
+        self._callbacks[i] = nullptr;
+        self._args[i] = nullptr;
+        callback(registration_flags[i], {}, arg);
+    }
+}
+
+EventEngineLibevent::EventDataRegistration::EventDataRegistration(IOHandleNativeType io_handle)
+: _io_handle(io_handle)
+{}
+
+EventEngineLibevent::EventDataRegistration::~EventDataRegistration() {
+    event_del(&_event);
+}
+
 // EventDataSimple
 
 void EventEngineLibevent::EventDataSimple::callback(int io_handle, short event, void* args) {
@@ -335,6 +370,7 @@ ResultGeneric EventEngineLibevent::add_io(
         &EventEngineLibevent::EventDataIO::callback, 
         &event_handle);
     event_add(&event_handle.get()._event, nullptr);
+    ++_control_count;
     return Successful_;
 }
 
@@ -354,6 +390,81 @@ ResultGeneric EventEngineLibevent::remove_io(EventHandleIO& handle) // NOLINT
     return Successful_;
 }
 
+ResultGeneric EventEngineLibevent::wait_io(
+    Awaitable* awaitable,
+    unsigned int flags,
+    EventHandleRegistration& registration,
+    IOHandleNativeType io_handle,
+    EventCallbackIO callback,
+    void* arg)
+{
+    auto* self = get_event_engine<EventEngineLibevent>(awaitable);
+    return self->wait_io(flags, registration, io_handle, callback, arg);
+}
+
+ResultGeneric EventEngineLibevent::wait_io(
+    unsigned int flags,
+    EventHandleRegistration& registration,
+    IOHandleNativeType io_handle,
+    EventCallbackIO callback,
+    void* arg)
+{
+    if (registration.empty() or registration.get()._io_handle != io_handle) {
+        registration.reset();
+        registration.emplace(io_handle);
+        event_assign(
+            &registration.get()._event,
+            _base,
+            io_handle,
+            EV_READ | EV_WRITE | EV_PERSIST | EV_ET,
+            &EventEngineLibevent::EventDataRegistration::callback,
+            &registration);
+        if (event_add(&registration.get()._event, nullptr) != 0) {
+            registration.reset();
+            return Failed_;
+        }
+        ++_control_count;
+    }
+
+    auto& self = registration.get();
+    short ready = 0;
+    for (int i = 0; i < 2; ++i) {
+        if ((flags & registration_flags[i]) == 0) {
+            continue;
+        }
+        jinx_assert(self._callbacks[i] == nullptr);
+        self._callbacks[i] = callback;
+        self._args[i] = arg;
+        if (self._ready[i]) {
+            self._ready[i] = false;
+            ready |= registration_flags[i];
+        }
+    }
+
+    // the edge came before the wait, the operation retries on the next poll
+    if (ready != 0) {
+        event_active(&self._event, ready, 0);
+    }
+    return Successful_;
+}
+
+ResultGeneric EventEngineLibevent::cancel_wait_io(
+    Awaitable* /*unused*/, 
+    EventHandleRegistration& registration, 
+    void* arg) noexcept
+{
+    if (registration.empty()) {
+        return Successful_;
+    }
+    auto& self = registration.get();
+    for (int i = 0; i < 2; ++i) {
+        if (self._args[i] == arg) {
+            self._callbacks[i] = nullptr;
+            self._args[i] = nullptr;
+        }
+    }
+    return Successful_;
+}
 
 #if 0
 error::Error EventEngineLibevent::read(IONativeHandle fd, SliceMutable buffer, IOOption& opt, PreactorCallback callback, void* arg)
@@ -385,9 +496,38 @@ void EventEngineLibevent::poll()
     // std::cout << add << " " << act << " " << vir << std::endl;
 }
 
+void EventEngineLibevent::poll_non_blocking()
+{
+    event_base_loop(_base, _poll_flags | EVLOOP_NONBLOCK);
+    _additional_flags = 0;
+}
+
 void EventEngineLibevent::wakeup() {
-    _additional_flags = EVLOOP_NONBLOCK;
-    event_base_loopbreak(_base);
+    if (_notify_fd[1] == -1) {
+        _additional_flags = EVLOOP_NONBLOCK;
+        event_base_loopbreak(_base);
+        return;
+    }
+
+    if (_notified.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    uint64_t value = 1;
+    int err = 0;
+    do {
+        err = ::write(_notify_fd[1], &value, sizeof(value)) == -1 ? errno : 0;
+    } while(err == EINTR);
+}
+
+void EventEngineLibevent::notify_callback(int io_handle, short event, void* arg)
+{
+    auto* self = static_cast<EventEngineLibevent*>(arg);
+    uint64_t value = 0;
+    while (::read(io_handle, &value, sizeof(value)) > 0) { }
+
+    // synchronize with the producers, the tasks they pushed are visible after this point
+    self->_notified.exchange(false, std::memory_order_acq_rel);
 }
 
 void EventEngineLibevent::set_non_blocking(bool enable)
@@ -429,9 +569,37 @@ EventEngineLibevent::EventEngineLibevent(bool thread_safe)
     _base = event_base_new_with_config(config);
 
     event_config_free(config);
+
+    if (thread_safe) {
+#ifdef __linux__
+        _notify_fd[0] = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        _notify_fd[1] = _notify_fd[0];
+#else
+        if (::pipe(_notify_fd) == 0) {
+            ::fcntl(_notify_fd[0], F_SETFL, O_NONBLOCK);
+            ::fcntl(_notify_fd[1], F_SETFL, O_NONBLOCK);
+            ::fcntl(_notify_fd[0], F_SETFD, FD_CLOEXEC);
+            ::fcntl(_notify_fd[1], F_SETFD, FD_CLOEXEC);
+        }
+#endif
+        if (_notify_fd[0] == -1) {
+            error::fatal("unable to create notify fd");
+        }
+        event_assign(&_notify_event, _base, _notify_fd[0], EV_READ | EV_PERSIST, 
+            &EventEngineLibevent::notify_callback, this);
+        event_add(&_notify_event, nullptr);
+    }
 }
 
 EventEngineLibevent::~EventEngineLibevent() {
+    if (_notify_fd[0] != -1) {
+        event_del(&_notify_event);
+        ::close(_notify_fd[0]);
+        if (_notify_fd[1] != _notify_fd[0]) {
+            ::close(_notify_fd[1]);
+        }
+    }
+
     if (_base != nullptr) {
         event_base_free(_base);
         _base = nullptr;
@@ -0,0 +1,191 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <jinx/offload.hpp>
+
+namespace jinx {
+namespace offload {
+
+JINX_ERROR_IMPLEMENT(offload, {
+    switch(code.as<ErrorOffload>()) {
+        case ErrorOffload::NoError:
+            return "No error";
+        case ErrorOffload::QueueFull:
+            return "Offload queue full";
+        case ErrorOffload::Stopped:
+            return "Offload pool stopped";
+        case ErrorOffload::WorkFailed:
+            return "Offloaded work failed";
+        case ErrorOffload::OutOfMemory:
+            return "Offload out of memory";
+    }
+    return "unknown error value";
+});
+
+// Drains the completions in the loop thread, one task per batch
+class Offload::Deliver : public AsyncRoutine {
+    Offload* _pool{nullptr};
+
+public:
+    Deliver& operator ()(Offload* pool) {
+        _pool = pool;
+        async_start(&Deliver::deliver);
+        return *this;
+    }
+
+    // the pool stopped and delivered the batch itself
+    void detach() noexcept {
+        _pool = nullptr;
+    }
+
+protected:
+    Async deliver() {
+        if (_pool != nullptr) {
+            _pool->deliver();
+        }
+        return async_return();
+    }
+};
+
+Offload::Offload(Loop& loop, size_t concurrency, size_t queue_limit)
+: _loop(loop), _queue_limit(queue_limit)
+{
+    if (concurrency == 0) {
+        concurrency = 1;
+    }
+    for (size_t index = 0; index < concurrency; ++index) {
+        _workers.emplace_back([this]() { work(); });
+    }
+}
+
+Offload::~Offload() {
+    stop();
+}
+
+void Offload::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+    }
+    _cond.notify_all();
+    for (auto& worker : _workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    // no worker posts anymore, the Deliver task in the loop must not touch the pool
+    if (_pending.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    _deliver->detach();
+    _deliver = nullptr;
+    deliver();
+}
+
+ErrorOffload Offload::submit(detail::Job* job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopped) {
+            return ErrorOffload::Stopped;
+        }
+        if (_queue_limit != 0 and _queue.size() >= _queue_limit) {
+            return ErrorOffload::QueueFull;
+        }
+        _queue.push_back(job);
+        if (_queue.size() > _queue_peak) {
+            _queue_peak = _queue.size();
+        }
+    }
+    _cond.notify_one();
+    return ErrorOffload::NoError;
+}
+
+void Offload::work() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _cond.wait(lock, [this]() { return _stopped or not _queue.empty(); });
+        if (_queue.empty()) {
+            return;
+        }
+        auto* job = _queue.front();
+        _queue.pop_front();
+        _running.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+
+        job->run();
+        complete(job);
+
+        lock.lock();
+    }
+}
+
+void Offload::complete(detail::Job* job) {
+    _completions.push(job);
+    _running.fetch_sub(1, std::memory_order_relaxed);
+    _completed.fetch_add(1, std::memory_order_relaxed);
+
+    // a Deliver task is posted or draining, it takes this one too
+    if (_pending.fetch_add(1, std::memory_order_acq_rel) != 0) {
+        return;
+    }
+
+    typedef Deliver::TaskHeapType<Deliver> TaskHeapType;
+    auto* task = TaskHeapType::new_task<TaskHeapType>();
+    if (task == nullptr) {
+        error::fatal("Offload: failed to allocate the deliver task");
+    }
+    auto task_ptr = TaskPtr{task};
+    (*task)(this);
+    _deliver = task->operator->();
+    if (_loop.post(std::move(task_ptr)).is(Failed_)) {
+        error::fatal("Offload: failed to post the deliver task");
+    }
+}
+
+void Offload::deliver() {
+    _batches += 1;
+    auto count = _pending.load(std::memory_order_acquire);
+    for (;;) {
+        // only the counted ones, the others are taken by the task their worker posts
+        for (size_t index = 0; index < count; ++index) {
+            detail::Job* job;
+            while ((job = _completions.pop()) == nullptr) {
+                // pushed, a previous producer is still linking its node
+                std::this_thread::yield();
+            }
+            job->deliver();
+            delete job;
+        }
+        _delivered += count;
+
+        auto left = _pending.fetch_sub(count, std::memory_order_acq_rel) - count;
+        if (left == 0) {
+            return;
+        }
+        count = left;
+    }
+}
+
+} // namespace offload
+} // namespace jinx
@@ -23,10 +23,16 @@ SOFTWARE.
 */
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
 #include <arpa/inet.h>
 
+#include <atomic>
+#include <cstdlib>
 #include <cstring>
+#include <new>
 #include <ostream>
 
 #include <jinx/posix.hpp>
@@ -127,6 +133,56 @@ const jinx::error::Category& category_again() noexcept {
     return __category_again;
 }
 
+/*
+    Close generations per descriptor, in pages allocated on the first close within a page.
+    The descriptors past the table share one generation.
+*/
+constexpr static int ClosePageBits = 12;
+constexpr static int ClosePageSize = 1 << ClosePageBits;
+constexpr static int ClosePageCount = 1024;
+
+static std::atomic<std::atomic<uint64_t>*> close_pages[ClosePageCount];
+static std::atomic<uint64_t> close_overflow{0};
+
+static std::atomic<uint64_t>* close_generation(int filedesc, bool create) noexcept {
+    const int index = filedesc >> ClosePageBits;
+    if (index >= ClosePageCount) {
+        return &close_overflow;
+    }
+
+    auto* page = close_pages[index].load(std::memory_order_acquire);
+    if (page == nullptr) {
+        if (not create) {
+            return nullptr;
+        }
+        auto* allocated = new(std::nothrow) std::atomic<uint64_t>[ClosePageSize]();
+        if (allocated == nullptr) {
+            error::fatal("posix close generations out of memory");
+        }
+        if (close_pages[index].compare_exchange_strong(page, allocated, std::memory_order_acq_rel)) {
+            page = allocated;
+        } else {
+            delete[] allocated;
+        }
+    }
+    return &page[filedesc & (ClosePageSize - 1)];
+}
+
+uint64_t get_close_epoch(int filedesc) noexcept {
+    if (filedesc < 0) {
+        return 0;
+    }
+    auto* generation = close_generation(filedesc, false);
+    return generation == nullptr ? 0 : generation->load(std::memory_order_acquire);
+}
+
+void notify_close(int filedesc) noexcept {
+    if (filedesc < 0) {
+        return;
+    }
+    close_generation(filedesc, true)->fetch_add(1, std::memory_order_acq_rel);
+}
+
 void IOHandle::reset(int filedesc) {
     if (_io_handle != InvalidNativeHandle) {
         int err = 0;
@@ -135,6 +191,7 @@ void IOHandle::reset(int filedesc) {
                 err = errno;
             }
         } while(err == EINTR);
+        notify_close(_io_handle);
     }
     _io_handle = filedesc;
 }
@@ -219,6 +276,27 @@ int Socket::set_keep_alive(bool enable)
     return ::setsockopt(native_handle(), SOL_SOCKET, SO_KEEPALIVE, &enable_bool, sizeof(enable_bool));
 }
 
+int Socket::set_udp_segment(int size)
+{
+#ifdef UDP_SEGMENT
+    return ::setsockopt(native_handle(), SOL_UDP, UDP_SEGMENT, &size, sizeof(size));
+#else
+    errno = ENOPROTOOPT;
+    return -1;
+#endif
+}
+
+int Socket::set_udp_gro(bool enable)
+{
+#ifdef UDP_GRO
+    int enable_bool = int(enable);
+    return ::setsockopt(native_handle(), SOL_UDP, UDP_GRO, &enable_bool, sizeof(enable_bool));
+#else
+    errno = ENOPROTOOPT;
+    return -1;
+#endif
+}
+
 Result<int> Socket::shutdown(int how)
 {
     return ::shutdown(_io_handle, how);
@@ -248,6 +326,325 @@ Result<int> Socket::create(int domain, int type, int protocol)
     return filedesc;
 }
 
+ResultGeneric MirroredMemory::create(size_t size)
+{
+    release();
+
+#if defined(__linux__)
+    const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size = (size + page - 1) / page * page;
+    if (size == 0) {
+        return Failed_;
+    }
+
+    int filedesc = ::memfd_create("jinx-mirrored", MFD_CLOEXEC);
+    if (filedesc == -1) {
+        return Failed_;
+    }
+    if (::ftruncate(filedesc, static_cast<off_t>(size)) == -1) {
+        ::close(filedesc);
+        return Failed_;
+    }
+
+    // reserve both halves, then map the file over each of them
+    auto* memory = static_cast<char*>(::mmap(nullptr, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (memory == MAP_FAILED) {
+        ::close(filedesc);
+        return Failed_;
+    }
+    for (int half = 0; half < 2; ++half) {
+        auto* mapped = ::mmap(memory + size * half, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, filedesc, 0);
+        if (mapped == MAP_FAILED) {
+            ::munmap(memory, size * 2);
+            ::close(filedesc);
+            return Failed_;
+        }
+    }
+    // the mappings keep the file
+    ::close(filedesc);
+
+    _memory = memory;
+    _size = size;
+    return Successful_;
+#else
+    return Failed_;
+#endif
+}
+
+void MirroredMemory::release() noexcept
+{
+    if (_memory != nullptr) {
+        ::munmap(_memory, _size * 2);
+    }
+    _memory = nullptr;
+    _size = 0;
+}
+
+// the region of a slot is kept in front of it, padded for the alignment of the memory given out
+static constexpr size_t SlabSlotPrefix = 16;
+static constexpr size_t SlabSlotAlign = 64;
+
+struct SlabMemoryProvider::Region : LinkedList<Region>::Node {
+    char* _memory{nullptr};
+    size_t _size{0};
+    bool _huge{false};
+    bool _resident{false};
+
+    SizeClass* _class{nullptr};
+
+    // slots handed out once since the region was mapped or dropped, the others are untouched
+    size_t _carved{0};
+    size_t _used{0};
+    // freed slots, linked through their memory
+    char* _free{nullptr};
+};
+
+struct SlabMemoryProvider::SizeClass {
+    size_t _slot_size{0};
+    size_t _region_size{0};
+    size_t _slot_count{0};
+
+    // regions with a slot available, the idle ones last
+    LinkedList<Region> _available{};
+
+    // an idle region kept with its pages, so a single slot coming and going does not fault
+    Region* _retained{nullptr};
+};
+
+SlabMemoryProvider::SlabMemoryProvider(size_t region_size, int flags)
+: _region_size(region_size), _flags(flags)
+{
+    const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t granularity = (flags & SlabHugePages) != 0 ? HugePageSize : page;
+    _region_size = (_region_size + granularity - 1) / granularity * granularity;
+    if (_region_size == 0) {
+        _region_size = granularity;
+    }
+}
+
+SlabMemoryProvider::~SlabMemoryProvider()
+{
+    for (auto& size_class : _classes) {
+        size_class->_available.clear();
+    }
+    for (auto& region : _regions) {
+        ::munmap(region->_memory, region->_size);
+    }
+}
+
+SlabMemoryProvider::SizeClass* SlabMemoryProvider::get_class(size_t slot_size) noexcept
+{
+    for (auto& size_class : _classes) {
+        if (size_class->_slot_size == slot_size) {
+            return size_class.get();
+        }
+    }
+    if (_classes.size() == MaxClasses) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SizeClass> size_class{new (std::nothrow) SizeClass{}};
+    if (size_class == nullptr) {
+        return nullptr;
+    }
+    size_class->_slot_size = slot_size;
+    size_class->_region_size = _region_size;
+    if (slot_size * MinSlots > _region_size) {
+        size_class->_region_size = (slot_size * MinSlots + _region_size - 1) / _region_size * _region_size;
+    }
+    size_class->_slot_count = size_class->_region_size / slot_size;
+
+    _classes.emplace_back(std::move(size_class));
+    return _classes.back().get();
+}
+
+SlabMemoryProvider::Region* SlabMemoryProvider::map_region(SizeClass* size_class) noexcept
+{
+    std::unique_ptr<Region> region{new (std::nothrow) Region{}};
+    if (region == nullptr) {
+        return nullptr;
+    }
+    const size_t size = size_class->_region_size;
+    const int populate = (_flags & SlabPopulate) != 0 ? MAP_POPULATE : 0;
+
+    char* memory = nullptr;
+#if defined(MAP_HUGETLB)
+    if ((_flags & SlabHugePages) != 0) {
+        auto* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+        if (mapped != MAP_FAILED) {
+            memory = static_cast<char*>(mapped);
+            region->_huge = true;
+        }
+    }
+#endif
+
+    if (memory == nullptr) {
+        // aligned to a huge page, so transparent huge pages can back the whole region
+        auto* mapped = ::mmap(nullptr, size + HugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            return nullptr;
+        }
+        auto* begin = static_cast<char*>(mapped);
+        auto* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(begin) + HugePageSize - 1) & ~(HugePageSize - 1));
+        if (aligned != begin) {
+            ::munmap(begin, static_cast<size_t>(aligned - begin));
+        }
+        auto* end = begin + size + HugePageSize;
+        if (end != aligned + size) {
+            ::munmap(aligned + size, static_cast<size_t>(end - aligned - size));
+        }
+        memory = aligned;
+
+        if (populate != 0) {
+            // mapped again in place, now prefaulted
+            mapped = ::mmap(memory, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | populate, -1, 0);
+            if (mapped == MAP_FAILED) {
+                ::munmap(memory, size);
+                return nullptr;
+            }
+        }
+#if defined(MADV_HUGEPAGE)
+        if ((_flags & SlabHugePages) != 0) {
+            ::madvise(memory, size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    region->_memory = memory;
+    region->_size = size;
+    region->_class = size_class;
+    _regions.emplace_back(std::move(region));
+    if (_regions.back()->_huge) {
+        _huge_regions += 1;
+    }
+    return _regions.back().get();
+}
+
+void SlabMemoryProvider::region_idle(Region* region) noexcept
+{
+    auto* size_class = region->_class;
+    if (size_class->_retained == nullptr) {
+        size_class->_retained = region;
+    } else {
+        ::madvise(region->_memory, region->_size, MADV_DONTNEED);
+        region->_carved = 0;
+        region->_free = nullptr;
+        region->_resident = false;
+        _resident_regions -= 1;
+    }
+
+    // taken last, so the others fill up before it is used again
+    size_class->_available.erase(region) >> JINX_IGNORE_RESULT;
+    size_class->_available.push_back(region) >> JINX_IGNORE_RESULT;
+}
+
+void* SlabMemoryProvider::alloc(size_t size) noexcept
+{
+    const size_t slot_size = (size + SlabSlotPrefix + SlabSlotAlign - 1) / SlabSlotAlign * SlabSlotAlign;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto* size_class = get_class(slot_size);
+    if (size_class == nullptr) {
+        lock.unlock();
+        auto* slot = static_cast<char*>(::malloc(size + SlabSlotPrefix)); // NOLINT
+        if (slot == nullptr) {
+            return nullptr;
+        }
+        const Region* none = nullptr;
+        ::memcpy(slot, &none, sizeof(none));
+        return slot + SlabSlotPrefix;
+    }
+
+    Region* region = nullptr;
+    if (not size_class->_available.empty()) {
+        region = size_class->_available.front();
+    } else {
+        region = map_region(size_class);
+        if (region == nullptr) {
+            return nullptr;
+        }
+        size_class->_available.push_front(region) >> JINX_IGNORE_RESULT;
+    }
+
+    char* slot = region->_free;
+    if (slot != nullptr) {
+        ::memcpy(&region->_free, slot + SlabSlotPrefix, sizeof(char*));
+    } else {
+        slot = region->_memory + region->_carved * size_class->_slot_size;
+        region->_carved += 1;
+    }
+
+    if (not region->_resident) {
+        region->_resident = true;
+        _resident_regions += 1;
+    }
+    if (region == size_class->_retained) {
+        size_class->_retained = nullptr;
+    }
+    region->_used += 1;
+    if (region->_used == size_class->_slot_count) {
+        size_class->_available.erase(region) >> JINX_IGNORE_RESULT;
+    }
+    _used_slots += 1;
+
+    const Region* owner = region;
+    ::memcpy(slot, &owner, sizeof(owner));
+    return slot + SlabSlotPrefix;
+}
+
+void SlabMemoryProvider::free(void* mem) noexcept
+{
+    if (mem == nullptr) {
+        return;
+    }
+    char* slot = static_cast<char*>(mem) - SlabSlotPrefix;
+    Region* region = nullptr;
+    ::memcpy(&region, slot, sizeof(region));
+    if (region == nullptr) {
+        ::free(slot); // NOLINT
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto* size_class = region->_class;
+    const bool was_full = region->_used == size_class->_slot_count;
+    region->_used -= 1;
+    _used_slots -= 1;
+
+    ::memcpy(slot + SlabSlotPrefix, &region->_free, sizeof(char*));
+    region->_free = slot;
+
+    if (region->_used == 0) {
+        region_idle(region);
+    } else if (was_full) {
+        size_class->_available.push_front(region) >> JINX_IGNORE_RESULT;
+    }
+}
+
+size_t SlabMemoryProvider::region_count() noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _regions.size();
+}
+
+size_t SlabMemoryProvider::resident_region_count() noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _resident_regions;
+}
+
+size_t SlabMemoryProvider::huge_region_count() noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _huge_regions;
+}
+
+size_t SlabMemoryProvider::used_slot_count() noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _used_slots;
+}
+
 std::ostream& operator <<(std::ostream& output_stream, const SocketAddress& addr)
 {
     char buffer[INET6_ADDRSTRLEN];
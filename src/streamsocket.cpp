@@ -0,0 +1,193 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <cstring>
+#include <new>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#endif
+
+#include <jinx/posix.hpp>
+#include <jinx/streamsocket.hpp>
+
+namespace jinx {
+namespace stream {
+namespace detail {
+
+#if defined(__linux__)
+
+bool ZeroCopyReferences::reserve(int io_handle) noexcept
+{
+    if (size() == Capacity) {
+        reap(io_handle);
+    }
+    return size() < Capacity;
+}
+
+void ZeroCopyReferences::hold(const Reference& reference) noexcept
+{
+    jinx_assert(size() < Capacity);
+    auto& entry = _entries[_next % Capacity];
+    reference._ref(reference._memory);
+    entry._reference = reference;
+    entry._done = false;
+    ++_next;
+}
+
+void ZeroCopyReferences::complete(uint32_t first, uint32_t last) noexcept
+{
+    // ranges may be reported out of order, released from the oldest
+    for (uint32_t sequence = first; sequence - first <= last - first; ++sequence) {
+        if (sequence - _first < size()) {
+            _entries[sequence % Capacity]._done = true;
+        }
+    }
+    while (_first != _next and _entries[_first % Capacity]._done) {
+        auto& entry = _entries[_first % Capacity];
+        entry._reference._unref(entry._reference._memory);
+        entry = {};
+        ++_first;
+    }
+}
+
+void ZeroCopyReferences::reap(int io_handle) noexcept
+{
+    while (size() > 0) {
+        char control[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+        struct msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        // nothing left, EAGAIN
+        if (::recvmsg(io_handle, &msg, MSG_ERRQUEUE) == -1) {
+            return;
+        }
+
+        for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (not ((cmsg->cmsg_level == SOL_IP and cmsg->cmsg_type == IP_RECVERR) 
+                or (cmsg->cmsg_level == SOL_IPV6 and cmsg->cmsg_type == IPV6_RECVERR))) 
+            {
+                continue;
+            }
+            struct sock_extended_err error{};
+            ::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+            if (error.ee_errno == 0 and error.ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                complete(error.ee_info, error.ee_data);
+            }
+        }
+    }
+}
+
+void ZeroCopyReferences::release() noexcept
+{
+    while (_first != _next) {
+        auto& entry = _entries[_first % Capacity];
+        entry._reference._unref(entry._reference._memory);
+        entry = {};
+        ++_first;
+    }
+    _first = 0;
+    _next = 0;
+}
+
+void ZeroCopyReferences::take(ZeroCopyReferences& other) noexcept
+{
+    release();
+    for (uint32_t sequence = other._first; sequence != other._next; ++sequence) {
+        _entries[sequence % Capacity] = other._entries[sequence % Capacity];
+        other._entries[sequence % Capacity] = {};
+    }
+    _first = other._first;
+    _next = other._next;
+    other._first = 0;
+    other._next = 0;
+}
+
+namespace {
+
+struct ZeroCopyParked {
+    posix::IOHandle _io_handle;
+    ZeroCopyReferences _references{};
+
+    explicit ZeroCopyParked(int io_handle) : _io_handle(io_handle) { }
+};
+
+struct ZeroCopyParking {
+    std::vector<ZeroCopyParked*> _parked{};
+
+    ~ZeroCopyParking() {
+        // the thread exits, the buffers still read by the kernel are left to it
+        for (auto* parked : _parked) {
+            parked->_references.reap(parked->_io_handle.native_handle());
+            if (parked->_references.size() == 0) {
+                delete parked;
+            }
+        }
+    }
+};
+
+ZeroCopyParking& zero_copy_parking() {
+    static thread_local ZeroCopyParking parking{};
+    return parking;
+}
+
+} // namespace
+
+void park_zero_copy(int io_handle, ZeroCopyReferences& references)
+{
+    auto* parked = new(std::nothrow) ZeroCopyParked{io_handle};
+    if (parked == nullptr) {
+        error::fatal("zero copy parking out of memory");
+    }
+    // the peer reads the data sent, no more is sent nor received
+    ::shutdown(io_handle, SHUT_RDWR);
+    parked->_references.take(references);
+    zero_copy_parking()._parked.push_back(parked);
+}
+
+size_t reap_zero_copy_parked() noexcept
+{
+    auto& parked = zero_copy_parking()._parked;
+    for (size_t i = 0; i < parked.size();) {
+        auto* entry = parked[i];
+        entry->_references.reap(entry->_io_handle.native_handle());
+        if (entry->_references.size() != 0) {
+            ++i;
+            continue;
+        }
+        delete entry;
+        parked[i] = parked.back();
+        parked.pop_back();
+    }
+    return parked.size();
+}
+
+#endif
+
+} // namespace detail
+} // namespace stream
+} // namespace jinx
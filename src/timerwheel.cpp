@@ -0,0 +1,233 @@
+/*
+MIT License
+
+Copyright (c) 2023 pom@vro.life
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <jinx/assert.hpp>
+#include <jinx/timerwheel.hpp>
+
+namespace jinx {
+
+static constexpr const uint64_t SlotMask = TimerWheel::SlotCount - 1;
+
+static inline uint64_t level_span(unsigned int level) noexcept {
+    return uint64_t{1} << (TimerWheel::SlotBits * level);
+}
+
+TimerWheel::TimerWheel(Clock::duration slack, const size_t* loop_tick)
+: _epoch(Clock::now()), _resolution(slack), _loop_tick(loop_tick)
+{
+    jinx_assert(slack.count() > 0);
+    for (unsigned int level = 0; level < LevelCount; ++level) {
+        for (unsigned int slot = 0; slot < SlotCount; ++slot) {
+            _slots[level][slot]._prev = head(level, slot);
+            _slots[level][slot]._next = head(level, slot);
+        }
+    }
+}
+
+TimerWheel::~TimerWheel()
+{
+    // the entries outliving the wheel are left alone
+    for (unsigned int level = 0; level < LevelCount; ++level) {
+        for (unsigned int slot = 0; slot < SlotCount; ++slot) {
+            auto* sentinel = head(level, slot);
+            for (auto* entry = sentinel->_next; entry != sentinel; entry = entry->_next) {
+                entry->_wheel = nullptr;
+            }
+        }
+    }
+}
+
+ResultGeneric TimerWheel::set_slack(Clock::duration slack) noexcept
+{
+    if (_size != 0 or slack.count() <= 0) {
+        return Failed_;
+    }
+    _epoch = Clock::now();
+    _resolution = slack;
+    _current = 0;
+    return Successful_;
+}
+
+void TimerWheel::place(Entry& entry) noexcept
+{
+    // beyond the last level, placed at its end and placed again on the way down
+    const uint64_t horizon = level_span(LevelCount) - 1;
+    const uint64_t tick = entry._tick - _current > horizon ? _current + horizon : entry._tick;
+    const uint64_t delta = tick - _current;
+
+    unsigned int level = 0;
+    while (level + 1 < LevelCount and delta >= level_span(level + 1)) {
+        ++level;
+    }
+    const auto slot = static_cast<unsigned int>((tick >> (SlotBits * level)) & SlotMask);
+
+    auto* sentinel = head(level, slot);
+    entry._level = level;
+    entry._next = sentinel;
+    entry._prev = sentinel->_prev;
+    sentinel->_prev->_next = &entry;
+    sentinel->_prev = &entry;
+    _level_size[level] += 1;
+}
+
+void TimerWheel::remove(Entry& entry) noexcept
+{
+    entry._prev->_next = entry._next;
+    entry._next->_prev = entry._prev;
+    entry._prev = entry._next = nullptr;
+    entry._wheel = nullptr;
+    _level_size[entry._level] -= 1;
+    _size -= 1;
+
+    if (_size == 0 and _armed != NotArmed and not _expiring) {
+        _armed = NotArmed;
+        disarm();
+    }
+}
+
+ResultGeneric TimerWheel::add(Entry& entry, Clock::time_point deadline, TimerCallback callback, void* arg)
+{
+    entry.cancel();
+
+    // the first tick after the deadline
+    uint64_t tick = to_tick(deadline) + 1;
+    if (tick <= _current) {
+        tick = _current + 1;
+    }
+
+    entry._wheel = this;
+    entry._tick = tick;
+    entry._callback = callback;
+    entry._arg = arg;
+    place(entry);
+    _size += 1;
+
+    if (tick < _armed and not _expiring) {
+        rearm(tick);
+        if (_armed == NotArmed) {
+            entry.cancel();
+            return Failed_;
+        }
+    }
+    return Successful_;
+}
+
+void TimerWheel::advance(uint64_t tick)
+{
+    while (_current < tick) {
+        if (_size == 0) {
+            _current = tick;
+            break;
+        }
+
+        // nothing happens before the next cascade of the lowest level in use
+        unsigned int lowest = 0;
+        while (_level_size[lowest] == 0) {
+            ++lowest;
+        }
+        if (lowest > 0) {
+            const uint64_t boundary = _current | (level_span(lowest) - 1);
+            if (boundary >= tick) {
+                _current = tick;
+                break;
+            }
+            _current = boundary;
+        }
+
+        _current += 1;
+
+        // move the slots of the windows starting now down the levels
+        for (unsigned int level = 1; level < LevelCount; ++level) {
+            if ((_current & (level_span(level) - 1)) != 0) {
+                break;
+            }
+            const auto slot = static_cast<unsigned int>((_current >> (SlotBits * level)) & SlotMask);
+            auto* sentinel = head(level, slot);
+            while (sentinel->_next != sentinel) {
+                auto* entry = sentinel->_next;
+                entry->_prev->_next = entry->_next;
+                entry->_next->_prev = entry->_prev;
+                _level_size[level] -= 1;
+                place(*entry);
+            }
+        }
+
+        auto* sentinel = head(0, static_cast<unsigned int>(_current & SlotMask));
+        while (sentinel->_next != sentinel) {
+            auto* entry = sentinel->_next;
+            auto callback = entry->_callback;
+            auto* arg = entry->_arg;
+            remove(*entry);
+            callback(arg);
+        }
+    }
+}
+
+uint64_t TimerWheel::next_expiry() noexcept
+{
+    uint64_t next = NotArmed;
+    for (unsigned int level = 0; level < LevelCount; ++level) {
+        if (_level_size[level] == 0) {
+            continue;
+        }
+        // level 0 expires the slot, the others cascade it at the start of its window
+        const uint64_t window = _current >> (SlotBits * level);
+        for (uint64_t n = 1; n <= SlotCount; ++n) {
+            const auto slot = static_cast<unsigned int>((window + n) & SlotMask);
+            auto* sentinel = head(level, slot);
+            if (sentinel->_next != sentinel) {
+                const uint64_t tick = (window + n) << (SlotBits * level);
+                next = tick < next ? tick : next;
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+void TimerWheel::rearm(uint64_t tick)
+{
+    const auto now = Clock::now();
+    const auto expiry = _epoch + _resolution * static_cast<Clock::rep>(tick);
+    const auto timeout = expiry > now ? expiry - now : Clock::duration{0};
+
+    _armed = NotArmed;
+    if (arm(timeout).is(Successful_)) {
+        _armed = tick;
+        _arm_count += 1;
+    }
+}
+
+void TimerWheel::expire()
+{
+    _armed = NotArmed;
+    _expiring = true;
+    advance(to_tick(Clock::now()));
+    _expiring = false;
+
+    if (_size != 0) {
+        rearm(next_expiry());
+    }
+}
+
+} // namespace jinx
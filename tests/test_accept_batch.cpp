@@ -0,0 +1,117 @@
+#include <jinx/assert.hpp>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/posix.hpp>
+
+using namespace jinx;
+
+const int clients = 10;
+const size_t batch = 4;
+
+std::vector<long> batches{};
+int accepted = 0;
+
+template<typename EventEngine>
+class Acceptor : public AsyncRoutine {
+    typename posix::AsyncIOPosix<EventEngine>::AcceptBatch _accept{};
+    int _fd{-1};
+    int _handles[batch];
+
+public:
+    Acceptor& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Acceptor::accept);
+        return *this;
+    }
+
+protected:
+    Async accept() {
+        return *this / _accept(_fd, _handles, batch) / &Acceptor::check;
+    }
+
+    Async check() {
+        const long count = _accept.get_result();
+        jinx_assert(count > 0 and static_cast<size_t>(count) <= batch);
+        batches.push_back(count);
+
+        for (long i = 0; i < count; ++i) {
+            jinx_assert(::fcntl(_handles[i], F_GETFL) & O_NONBLOCK);
+            jinx_assert(::fcntl(_handles[i], F_GETFD) & FD_CLOEXEC);
+            ::close(_handles[i]);
+        }
+
+        accepted += count;
+        if (accepted == clients + 1) {
+            return async_return();
+        }
+        return accept();
+    }
+};
+
+template<typename EventEngine>
+class Latecomer : public AsyncRoutine {
+    typename AsyncImplement<EventEngine>::Sleep _sleep{};
+    posix::SocketAddress _addr{};
+    posix::Socket _sock{};
+
+public:
+    Latecomer& operator ()(const posix::SocketAddress& addr) {
+        _addr = addr;
+        async_start(&Latecomer::sleep);
+        return *this;
+    }
+
+protected:
+    Async sleep() {
+        return *this / _sleep(std::chrono::milliseconds(10)) / &Latecomer::connect;
+    }
+
+    Async connect() {
+        jinx_assert(_sock.create(AF_INET, SOCK_STREAM, 0).unwrap() >= 0);
+        jinx_assert(::connect(_sock.native_handle(), _addr.data(), _addr.size()) == 0);
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+void run() {
+    EventEngine eve{false};
+    Loop loop{&eve};
+    batches.clear();
+    accepted = 0;
+
+    posix::SocketAddress addr{"127.0.0.1", 0, posix::SocketAddressAbortOnFailure};
+    posix::Socket sock{::socket(AF_INET, SOCK_STREAM, 0)};
+    jinx_assert(sock.bind(addr).unwrap() == 0);
+    jinx_assert(sock.listen(32).unwrap() == 0);
+    jinx_assert(sock.get_socket_name(addr).unwrap() == 0);
+    sock.set_non_blocking(true);
+
+    // pending before the first batch
+    std::vector<posix::Socket> peers(clients);
+    for (auto& peer : peers) {
+        jinx_assert(peer.create(AF_INET, SOCK_STREAM, 0).unwrap() >= 0);
+        jinx_assert(::connect(peer.native_handle(), addr.data(), addr.size()) == 0);
+    }
+
+    loop.task_new<Acceptor<EventEngine>>(sock.native_handle());
+    loop.task_new<Latecomer<EventEngine>>(addr);
+    loop.run();
+
+    // drained by full batches, then the latecomer wakes up the waiting one
+    jinx_assert(batches.size() == 4);
+    jinx_assert(batches[0] == 4 and batches[1] == 4 and batches[2] == 2 and batches[3] == 1);
+}
+
+int main(int argc, const char* argv[])
+{
+    run<libevent::EventEngineLibevent>();
+    run<epoll::EventEngineEpoll>();
+    return 0;
+}
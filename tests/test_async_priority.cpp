@@ -0,0 +1,56 @@
+#include <jinx/assert.hpp>
+#include <string>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+
+using namespace jinx;
+
+std::string buf;
+
+class AsyncTest : public AsyncRoutine {
+    char _name{};
+    int _round{0};
+
+public:
+    AsyncTest& operator ()(char name) {
+        _name = name;
+        _round = 0;
+        async_start(&AsyncTest::step);
+        return *this;
+    }
+
+protected:
+    Async step() {
+        buf.push_back(_name);
+        _round += 1;
+        if (_round == 4) {
+            return async_return();
+        }
+        return async_yield(&AsyncTest::step);
+    }
+};
+
+std::string run(size_t starvation_budget) {
+    libevent::EventEngineLibevent eve(false);
+    Loop loop(&eve);
+    loop.set_starvation_budget(starvation_budget);
+
+    buf.clear();
+    loop.task_new_priority<AsyncTest>(TaskPriority::Low, 'l');
+    loop.task_new<AsyncTest>('n');
+    loop.task_new_priority<AsyncTest>(TaskPriority::High, 'h');
+
+    loop.run();
+    return buf;
+}
+
+int main(int argc, const char* argv[])
+{
+    // strict
+    jinx_assert(run(0) == "hhhhnnnnllll");
+
+    // every 2 tasks taken over a waiting lower priority, the lower priorities get one in turn
+    jinx_assert(run(2) == "hhnhhlnnnlll");
+    return 0;
+}
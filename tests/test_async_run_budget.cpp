@@ -0,0 +1,73 @@
+#include <jinx/assert.hpp>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+
+using namespace jinx;
+
+typedef AsyncImplement<libevent::EventEngineLibevent> async;
+
+const int count = 1000;
+int computed = 0;
+int computed_on_wakeup = -1;
+
+class AsyncCompute : public AsyncRoutine {
+public:
+    AsyncCompute& operator ()() {
+        async_start(&AsyncCompute::compute);
+        return *this;
+    }
+
+protected:
+    Async compute() {
+        computed += 1;
+        return async_return();
+    }
+};
+
+struct Timer {
+    libevent::EventEngineLibevent* _eve{nullptr};
+    libevent::EventEngineLibevent::EventHandleTimer _handle{};
+
+    static void callback(const error::Error& error, void* arg) {
+        auto* self = static_cast<Timer*>(arg);
+        self->_eve->remove_timer(self->_handle) >> JINX_IGNORE_RESULT;
+        computed_on_wakeup = computed;
+    }
+};
+
+void run(size_t budget) {
+    libevent::EventEngineLibevent eve{false};
+    Loop loop{&eve};
+    loop.set_run_budget(budget);
+
+    computed = 0;
+    computed_on_wakeup = -1;
+
+    Timer timer{};
+    timer._eve = &eve;
+    struct timeval timeval{0, 0};
+    jinx_assert(eve.add_timer(timer._handle, &timeval, &Timer::callback, &timer).is(Successful_));
+
+    for (int i = 0; i < count; ++i) {
+        loop.task_new<AsyncCompute>();
+    }
+    loop.run();
+    jinx_assert(computed == count);
+
+    if (computed_on_wakeup == -1) {
+        eve.poll();
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    // the timer is polled only after all the ready tasks
+    run(0);
+    jinx_assert(computed_on_wakeup == count);
+
+    // the timer is polled between the ready tasks
+    run(16);
+    jinx_assert(computed_on_wakeup == 16);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <jinx/assert.hpp>
+#include <string>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+
+using namespace jinx;
+
+std::string buf;
+
+class AsyncTest : public AsyncRoutine {
+    char _name{};
+    int _round{0};
+
+public:
+    AsyncTest& operator ()(char name) {
+        _name = name;
+        _round = 0;
+        async_start(&AsyncTest::step);
+        return *this;
+    }
+
+protected:
+    Async step() {
+        buf.push_back(_name);
+        _round += 1;
+        if (_round == 3) {
+            return async_return();
+        }
+        return async_yield(&AsyncTest::step);
+    }
+};
+
+int main(int argc, const char* argv[])
+{
+    libevent::EventEngineLibevent eve(false);
+    Loop loop(&eve);
+
+    loop.task_new<AsyncTest>('a');
+    loop.task_new<AsyncTest>('b');
+    loop.task_new<AsyncTest>('c');
+
+    loop.run();
+
+    jinx_assert(buf == "abcabcabc");
+    return 0;
+}
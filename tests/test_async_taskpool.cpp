@@ -0,0 +1,62 @@
+#include <jinx/assert.hpp>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+
+using namespace jinx;
+
+typedef AsyncImplement<libevent::EventEngineLibevent> async;
+
+const size_t branches = 16;
+
+class AsyncFanOut : public AsyncRoutine {
+    async::Wait<int> _wait{};
+
+public:
+    AsyncFanOut& operator ()() {
+        _wait.initialize(WaitCondition::AllCompleted);
+        for (size_t i = 0; i < branches; ++i) {
+            jinx_assert(_wait.branch_new<async::Sleep>(std::chrono::milliseconds(0)));
+        }
+        async_start(&AsyncFanOut::wait);
+        return *this;
+    }
+
+protected:
+    Async wait() {
+        return *this / _wait / &AsyncFanOut::process;
+    }
+
+    Async process() {
+        _wait.for_each([&](TaskPtr& task, int tag) { });
+        if (not _wait.is_done()) {
+            return wait();
+        }
+        return async_return();
+    }
+};
+
+void run() {
+    libevent::EventEngineLibevent eve(false);
+    Loop loop(&eve);
+    loop.task_new<AsyncFanOut>();
+    loop.task_new<AsyncFanOut>();
+    loop.run();
+}
+
+int main(int argc, const char* argv[])
+{
+    typedef detail::TaskPool TaskPool;
+
+    run();
+    auto first = TaskPool::get_statistics();
+    jinx_assert(first.release_count == first.allocate_count + first.reuse_count);
+    jinx_assert(first.cached_count > 0);
+
+    run();
+    auto second = TaskPool::get_statistics();
+    jinx_assert(second.allocate_count == first.allocate_count);
+    jinx_assert(second.reuse_count - first.reuse_count == 2 + 2 * branches);
+    jinx_assert(second.cached_count == first.cached_count);
+    return 0;
+}
@@ -9,6 +9,7 @@ using namespace jinx;
 typedef AsyncImplement<libevent::EventEngineLibevent> async;
 
 int counter = 0;
+TimerWheel* wheel = nullptr;
 
 class AsyncTest : public AsyncRoutine {
     enum Tags {
@@ -40,6 +41,8 @@ protected:
         _wait.for_each([&](TaskPtr& task, Tags tag){
             jinx_assert(tag == Sleep1);
         });
+        // the sleeps of the branches are timers of the loop
+        jinx_assert(wheel->get_arm_count() > 0);
         counter += 1;
         return async_return();
     }
@@ -49,8 +52,10 @@ int main(int argc, const char* argv[])
 {
     libevent::EventEngineLibevent eve(false);
     Loop loop(&eve);
+    wheel = &loop.get_timer_wheel<libevent::EventEngineLibevent>();
     loop.task_new<AsyncTest>();
     loop.run();
     jinx_assert(counter == 1);
+    jinx_assert(wheel->size() == 0);
     return 0;
 }
@@ -102,8 +102,8 @@ int main(int argc, const char* argv[])
     int size = PAGE_SIZE;
     jinx_assert(setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) == 0);
 
-    loop.task_new<Reader>(fds[0]);
     loop.task_new<Writer>(fds[1]);
+    loop.task_new<Reader>(fds[0]);
 
     loop.run();
     return 0;
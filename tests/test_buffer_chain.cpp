@@ -0,0 +1,207 @@
+#include <jinx/assert.hpp>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/bufferchain.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/streamsocket.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+struct BufferConfig
+{
+    constexpr static char const* Name = "Example";
+    static constexpr const size_t Size = 1000;
+    static constexpr const size_t Reserve = 0;
+    static constexpr const long Limit = -1;
+
+    struct Information { };
+};
+
+typedef BufferAllocator<posix::MemoryProvider, BufferConfig> AllocatorType;
+typedef AllocatorType::BufferType BufferType;
+
+// larger than one buffer and the socket buffers
+const size_t message_size = 1024 * 1024 + 123;
+
+inline char pattern(size_t offset) {
+    return static_cast<char>(offset % 251);
+}
+
+BufferType fill(AllocatorType& allocator, size_t offset, size_t size) {
+    auto buffer = allocator.allocate(BufferConfig{});
+    jinx_assert(buffer != nullptr);
+    auto slice = buffer->slice_for_producer();
+    jinx_assert(size <= slice.size());
+    for (size_t i = 0; i < size; ++i) {
+        slice.begin()[i] = pattern(offset + i);
+    }
+    jinx_assert(buffer->commit(size).is(Successful_));
+    return buffer;
+}
+
+std::string content(const BufferChain& chain) {
+    std::string output(chain.size(), '\0');
+    jinx_assert(chain.copy_to(&output[0], output.size()) == chain.size());
+    return output;
+}
+
+void test_chain(AllocatorType& allocator) {
+    char header[] = "header:";
+    BufferChain chain{};
+    chain.append(fill(allocator, 0, 1000));
+    chain.append(fill(allocator, 1000, 500));
+    chain.prepend(BufferView{header, sizeof(header) - 1, 0, sizeof(header) - 1});
+    // empty buffers are not kept
+    chain.append(allocator.allocate(BufferConfig{}));
+    jinx_assert(chain.size() == 1507);
+    jinx_assert(chain.segment_count() == 3);
+    jinx_assert(allocator.active_buffer_count() == 2);
+
+    auto text = content(chain);
+    jinx_assert(text.compare(0, 7, "header:") == 0);
+    for (size_t i = 0; i < 1500; ++i) {
+        jinx_assert(text[7 + i] == pattern(i));
+    }
+
+    // the middle buffer is shared by both chains
+    auto head = chain.split(507);
+    jinx_assert(head.size() == 507 and chain.size() == 1000);
+    jinx_assert(head.segment_count() == 2 and chain.segment_count() == 2);
+    jinx_assert(allocator.active_buffer_count() == 2);
+    jinx_assert(head.segment(1).end() == chain.segment(0).begin());
+    jinx_assert(content(head) == text.substr(0, 507));
+    jinx_assert(content(chain) == text.substr(507));
+
+    struct iovec iov[4];
+    jinx_assert(chain.iovecs(iov, 4, 600) == 1);
+    jinx_assert(iov[0].iov_len == 400 and static_cast<char*>(iov[0].iov_base)[0] == pattern(1100));
+    jinx_assert(chain.iovecs(iov, 1) == 1);
+
+    chain.consume(600);
+    jinx_assert(chain.size() == 400 and chain.segment_count() == 1);
+    jinx_assert(chain.segment(0).begin()[0] == pattern(1100));
+
+    // put back together
+    head.splice(chain);
+    jinx_assert(chain.empty() and chain.segment_count() == 0);
+    jinx_assert(head.size() == 907 and head.segment_count() == 3);
+
+    head.consume(head.size());
+    jinx_assert(head.empty() and head.segment_count() == 0);
+    jinx_assert(allocator.active_buffer_count() == 0);
+}
+
+template<typename EventEngine>
+class Writer : public AsyncRoutine {
+    typedef stream::StreamSocket<posix::AsyncIOPosix<EventEngine>> StreamType;
+
+    StreamType* _stream{nullptr};
+    BufferChain* _chain{nullptr};
+    std::vector<BufferView*> _views{};
+
+public:
+    Writer& operator ()(StreamType* stream, BufferChain* chain) {
+        _stream = stream;
+        _chain = chain;
+        _views.resize(chain->segment_count());
+        jinx_assert(chain->views(_views.data(), _views.size()) == _views.size());
+        async_start(&Writer::write);
+        return *this;
+    }
+
+protected:
+    Async write() {
+        return *this / _stream->writev(_views.data(), _views.size()) / &Writer::check;
+    }
+
+    Async check() {
+        _chain->trim();
+        jinx_assert(_chain->empty() and _chain->segment_count() == 0);
+        ::shutdown(_stream->io_handle().native_handle(), SHUT_WR);
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+class Reader : public AsyncRoutine {
+    typename posix::AsyncIOPosix<EventEngine>::Recv _recv{};
+    int _fd{-1};
+    std::vector<char>* _received{nullptr};
+    char _memory[65536];
+
+public:
+    Reader& operator ()(int fd, std::vector<char>* received) {
+        _fd = fd;
+        _received = received;
+        async_start(&Reader::recv);
+        return *this;
+    }
+
+protected:
+    Async recv() {
+        return *this / _recv(_fd, SliceMutable{_memory, sizeof(_memory)}, 0) / &Reader::check;
+    }
+
+    Async check() {
+        const long size = _recv.get_result();
+        if (size == 0) {
+            return async_return();
+        }
+        _received->insert(_received->end(), _memory, _memory + size);
+        return recv();
+    }
+};
+
+template<typename EventEngine>
+void test_writev(AllocatorType& allocator) {
+    typedef stream::StreamSocket<posix::AsyncIOPosix<EventEngine>> StreamType;
+
+    EventEngine eve{false};
+    Loop loop{&eve};
+
+    BufferChain chain{};
+    const size_t size = BufferConfig::Size;
+    for (size_t offset = 0; offset < message_size; offset += size) {
+        chain.append(fill(allocator, offset, std::min(size, message_size - offset)));
+    }
+    jinx_assert(chain.size() == message_size);
+
+    int socks[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+    posix::Socket sock{socks[0]};
+    sock.set_non_blocking(true);
+    posix::Socket peer{socks[1]};
+    peer.set_non_blocking(true);
+
+    StreamType stream{};
+    stream.initialize(std::move(sock));
+
+    std::vector<char> received{};
+    loop.task_new<Writer<EventEngine>>(&stream, &chain);
+    loop.task_new<Reader<EventEngine>>(peer.native_handle(), &received);
+    loop.run();
+
+    jinx_assert(received.size() == message_size);
+    for (size_t i = 0; i < received.size(); ++i) {
+        jinx_assert(received[i] == pattern(i));
+    }
+    jinx_assert(allocator.active_buffer_count() == 0);
+}
+
+int main(int argc, const char* argv[])
+{
+    posix::MemoryProvider memory{};
+    AllocatorType allocator{memory};
+
+    test_chain(allocator);
+    test_writev<libevent::EventEngineLibevent>(allocator);
+    test_writev<epoll::EventEngineEpoll>(allocator);
+    return 0;
+}
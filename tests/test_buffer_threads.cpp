@@ -0,0 +1,169 @@
+#include <jinx/assert.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/posix.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+struct BufferConfig
+{
+    constexpr static char const* Name = "Example";
+    static constexpr const size_t Size = 1500;
+    static constexpr const size_t Reserve = 16;
+    static constexpr const long Limit = 63;
+
+    struct Information { };
+};
+
+typedef BufferAllocator<posix::MemoryProvider, BufferConfig> AllocatorType;
+typedef typename AllocatorType::BufferType BufferType;
+typedef typename AllocatorType::Allocate Allocate;
+
+const int thread_count = 8;
+const int iterations = 20000;
+const int rounds = 1000;
+
+// allocated and released on every thread, some held for a while
+void hammer(AllocatorType* allocator, int seed) {
+    BufferType held[4];
+    for (int i = 0; i < iterations; ++i) {
+        auto& slot = held[(i + seed) % 4];
+        slot = allocator->allocate(BufferConfig{});
+        if (slot != nullptr) {
+            jinx_assert(slot->size() == 0);
+            jinx_assert(slot->commit(1).is(Successful_));
+        }
+    }
+}
+
+void test_hammer() {
+    posix::MemoryProvider memory{};
+    AllocatorType allocator{memory};
+
+    std::vector<std::thread> threads{};
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back(hammer, &allocator, i);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    jinx_assert(allocator.active_buffer_count() == allocator.reserve_buffer_count());
+    jinx_assert(allocator.reserve_buffer_count() <= BufferConfig::Reserve);
+    jinx_assert(allocator.pending_request_count() == 0);
+}
+
+// the index of a thread gone is taken by the next one
+void test_slot_reuse() {
+    posix::MemoryProvider memory{};
+    AllocatorType allocator{memory};
+
+    const auto before = buffer::detail::buffer_thread_count();
+    for (int i = 0; i < 100; ++i) {
+        std::thread thread{[&]() {
+            auto buffer = allocator.allocate(BufferConfig{});
+            jinx_assert(buffer != nullptr);
+        }};
+        thread.join();
+    }
+    jinx_assert(buffer::detail::buffer_thread_count() <= before + 1);
+    jinx_assert(allocator.active_buffer_count() == allocator.reserve_buffer_count());
+}
+
+std::atomic<int> held_round{0};
+std::thread::id loop_thread{};
+int woken = 0;
+
+// both buffers of the pool are held by the other thread when it allocates
+class Waiter : public AsyncRoutine {
+    AllocatorType* _allocator{nullptr};
+    Allocate _allocate{};
+    int _round{0};
+
+public:
+    Waiter& operator ()(AllocatorType* allocator) {
+        _allocator = allocator;
+        async_start(&Waiter::wait);
+        return *this;
+    }
+
+protected:
+    Async wait() {
+        if (_round == rounds) {
+            return async_return();
+        }
+        if (held_round.load() <= _round) {
+            return async_yield(&Waiter::wait);
+        }
+        return *this / _allocate(_allocator, BufferConfig{}) / &Waiter::check;
+    }
+
+    Async check() {
+        jinx_assert(loop_thread == std::this_thread::get_id());
+        auto buffer = std::move(_allocate.get_result());
+        jinx_assert(buffer != nullptr);
+        jinx_assert(buffer->size() == 0);
+        woken += 1;
+        _round += 1;
+        return wait();
+    }
+};
+
+void release_remote(AllocatorType* allocator) {
+    for (int round = 0; round < rounds; ++round) {
+        BufferType first{};
+        BufferType second{};
+        // the waiter releases the buffer of the last round on its thread
+        while ((first = allocator->allocate(BufferConfig{})) == nullptr) {
+            std::this_thread::yield();
+        }
+        while ((second = allocator->allocate(BufferConfig{})) == nullptr) {
+            std::this_thread::yield();
+        }
+        jinx_assert(allocator->allocate(BufferConfig{}) == nullptr);
+        held_round.store(round + 1);
+
+        while (allocator->pending_request_count() == 0) {
+            std::this_thread::yield();
+        }
+        first.reset();
+    }
+}
+
+template<typename EventEngine>
+void test_release_remote() {
+    posix::MemoryProvider memory{};
+    AllocatorType allocator{memory};
+    allocator.reconfigure<BufferConfig>(0, 1);
+
+    EventEngine eve{true};
+    Loop loop{&eve};
+    loop_thread = std::this_thread::get_id();
+    held_round = 0;
+    woken = 0;
+
+    loop.task_new<Waiter>(&allocator);
+    std::thread thread{release_remote, &allocator};
+    loop.run();
+    thread.join();
+
+    jinx_assert(woken == rounds);
+    jinx_assert(allocator.active_buffer_count() == 0);
+    jinx_assert(allocator.pending_request_count() == 0);
+}
+
+int main(int argc, const char* argv[])
+{
+    test_hammer();
+    test_slot_reuse();
+    test_release_remote<libevent::EventEngineLibevent>();
+    test_release_remote<epoll::EventEngineEpoll>();
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include <jinx/assert.hpp>
+#include <cstring>
+#include <vector>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/datagram.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+const uint16_t segment = 100;
+const size_t total = 1037;
+
+size_t received = 0;
+size_t datagrams = 0;
+size_t coalesced = 0;
+
+inline char pattern(size_t offset) {
+    return static_cast<char>(offset % 251);
+}
+
+template<typename EventEngine>
+class Receiver : public AsyncRoutine {
+    typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+    int _fd{-1};
+    std::vector<char> _memory;
+    BufferView _view{};
+    datagram::RecvSegments<asyncio> _recv{};
+
+public:
+    Receiver& operator ()(int fd) {
+        _fd = fd;
+        _memory.resize(65536);
+        async_start(&Receiver::recv);
+        return *this;
+    }
+
+protected:
+    Async recv() {
+        _view = BufferView{_memory.data(), _memory.size(), 0, 0};
+        return *this / _recv(_fd, &_view) / &Receiver::check;
+    }
+
+    Async check() {
+        jinx_assert(not _recv.truncated());
+        const size_t count = _recv.segment_count();
+        if (count > 1) {
+            coalesced += 1;
+        }
+
+        size_t size = 0;
+        for (size_t i = 0; i < count; ++i) {
+            auto slice = _recv.segment(i);
+            // equal sized datagrams, the last one is shorter
+            const size_t expected = total - received < segment ? total - received : segment;
+            jinx_assert(slice.size() == expected);
+            for (size_t j = 0; j < slice.size(); ++j) {
+                jinx_assert(slice.begin()[j] == pattern(received + j));
+            }
+            received += slice.size();
+            size += slice.size();
+            datagrams += 1;
+        }
+        // the segments are the view, not copies
+        jinx_assert(_view.size() == size);
+        jinx_assert(_recv.segment(0).begin() == _view.begin());
+
+        if (received == total) {
+            return async_return();
+        }
+        return recv();
+    }
+};
+
+template<typename EventEngine>
+class Sender : public AsyncRoutine {
+    typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+    int _fd{-1};
+    const posix::SocketAddress* _to{nullptr};
+    char _memory[total];
+    BufferView _view{};
+    datagram::SendSegments<asyncio> _send{};
+
+public:
+    Sender& operator ()(int fd, const posix::SocketAddress* to) {
+        _fd = fd;
+        _to = to;
+        for (size_t i = 0; i < total; ++i) {
+            _memory[i] = pattern(i);
+        }
+        _view = BufferView{_memory, total, 0, total};
+        async_start(&Sender::send);
+        return *this;
+    }
+
+protected:
+    Async send() {
+        return *this / _send(_fd, &_view, segment, _to->data(), _to->size()) / &Sender::check;
+    }
+
+    Async check() {
+        jinx_assert(_send.get_result() == static_cast<long>(total));
+        jinx_assert(_view.size() == 0);
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+void run() {
+    EventEngine eve{false};
+    Loop loop{&eve};
+    received = 0;
+    datagrams = 0;
+    coalesced = 0;
+
+    posix::SocketAddress addr{"127.0.0.1", 0, posix::SocketAddressAbortOnFailure};
+    posix::Socket receiver{};
+    jinx_assert(receiver.create(AF_INET, SOCK_DGRAM, 0).unwrap() >= 0);
+    jinx_assert(receiver.bind(addr).unwrap() == 0);
+    jinx_assert(receiver.get_socket_name(addr).unwrap() == 0);
+    jinx_assert(receiver.set_udp_gro(true) == 0);
+    receiver.set_non_blocking(true);
+
+    posix::Socket sender{};
+    jinx_assert(sender.create(AF_INET, SOCK_DGRAM, 0).unwrap() >= 0);
+    sender.set_non_blocking(true);
+
+    loop.task_new<Receiver<EventEngine>>(receiver.native_handle());
+    loop.task_new<Sender<EventEngine>>(sender.native_handle(), &addr);
+    loop.run();
+
+    // 11 datagrams on the wire, coalesced again on the way in if the kernel can
+    jinx_assert(received == total);
+    jinx_assert(datagrams == (total + segment - 1) / segment);
+    jinx_assert(coalesced <= 1);
+}
+
+int main(int argc, const char* argv[])
+{
+    run<libevent::EventEngineLibevent>();
+    run<epoll::EventEngineEpoll>();
+    return 0;
+}
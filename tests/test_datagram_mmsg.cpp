@@ -0,0 +1,139 @@
+#include <jinx/assert.hpp>
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/datagram.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+const unsigned int datagrams = 8;
+const unsigned int capacity = 16;
+
+unsigned int received = 0;
+
+template<typename EventEngine>
+class Receiver : public AsyncRoutine {
+    typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+    int _fd{-1};
+    const posix::SocketAddress* _peer{nullptr};
+    char _memory[capacity][64];
+    BufferView _views[capacity];
+    datagram::MessageBatchStatic<capacity> _batch{};
+    datagram::RecvMMsg<asyncio> _recv{};
+
+public:
+    Receiver& operator ()(int fd, const posix::SocketAddress* peer) {
+        _fd = fd;
+        _peer = peer;
+        async_start(&Receiver::recv);
+        return *this;
+    }
+
+protected:
+    Async recv() {
+        _batch.clear();
+        for (unsigned int i = 0; i < capacity; ++i) {
+            _views[i] = BufferView{_memory[i], sizeof(_memory[i]), 0, 0};
+            jinx_assert(_batch.push(&_views[i]).is(Successful_));
+        }
+        jinx_assert(_batch.push(&_views[0]).is(Failed_));
+        return *this / _recv(_fd, &_batch) / &Receiver::check;
+    }
+
+    Async check() {
+        const auto count = static_cast<unsigned int>(_recv.get_result());
+        jinx_assert(count > 0);
+        for (unsigned int i = 0; i < count; ++i) {
+            char expected[16];
+            const int len = snprintf(expected, sizeof(expected), "datagram %u", received + i);
+            jinx_assert(_views[i].size() == static_cast<size_t>(len));
+            jinx_assert(memcmp(_views[i].data(), expected, len) == 0);
+            jinx_assert(not _batch.truncated(i));
+
+            // sent from the bound address of the peer
+            jinx_assert(_batch.address_len(i) == _peer->size());
+            jinx_assert(memcmp(_batch.address(i), _peer->data(), _peer->size()) == 0);
+        }
+        received += count;
+        if (received == datagrams) {
+            return async_return();
+        }
+        return recv();
+    }
+};
+
+template<typename EventEngine>
+class Sender : public AsyncRoutine {
+    typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+    int _fd{-1};
+    char _memory[datagrams][16];
+    BufferView _views[datagrams];
+    datagram::MessageBatchStatic<datagrams> _batch{};
+    datagram::SendMMsg<asyncio> _send{};
+
+public:
+    Sender& operator ()(int fd, const posix::SocketAddress* to) {
+        _fd = fd;
+        for (unsigned int i = 0; i < datagrams; ++i) {
+            const int len = snprintf(_memory[i], sizeof(_memory[i]), "datagram %u", i);
+            _views[i] = BufferView{_memory[i], sizeof(_memory[i]), 0, static_cast<size_t>(len)};
+            jinx_assert(_batch.push(&_views[i], to->data(), to->size()).is(Successful_));
+        }
+        async_start(&Sender::send);
+        return *this;
+    }
+
+protected:
+    Async send() {
+        return *this / _send(_fd, &_batch) / &Sender::check;
+    }
+
+    Async check() {
+        // each datagram is consumed whole
+        for (unsigned int i = 0; i < datagrams; ++i) {
+            jinx_assert(_views[i].size() == 0);
+        }
+        return async_return();
+    }
+};
+
+posix::Socket bind_udp(posix::SocketAddress& addr) {
+    posix::Socket sock{};
+    jinx_assert(sock.create(AF_INET, SOCK_DGRAM, 0).unwrap() >= 0);
+    jinx_assert(sock.bind(addr).unwrap() == 0);
+    jinx_assert(sock.get_socket_name(addr).unwrap() == 0);
+    sock.set_non_blocking(true);
+    return sock;
+}
+
+template<typename EventEngine>
+void run() {
+    EventEngine eve{false};
+    Loop loop{&eve};
+    received = 0;
+
+    posix::SocketAddress receiver_addr{"127.0.0.1", 0, posix::SocketAddressAbortOnFailure};
+    posix::SocketAddress sender_addr{"127.0.0.1", 0, posix::SocketAddressAbortOnFailure};
+    auto receiver = bind_udp(receiver_addr);
+    auto sender = bind_udp(sender_addr);
+
+    loop.task_new<Receiver<EventEngine>>(receiver.native_handle(), &sender_addr);
+    loop.task_new<Sender<EventEngine>>(sender.native_handle(), &receiver_addr);
+    loop.run();
+    jinx_assert(received == datagrams);
+}
+
+int main(int argc, const char* argv[])
+{
+    run<libevent::EventEngineLibevent>();
+    run<epoll::EventEngineEpoll>();
+    return 0;
+}
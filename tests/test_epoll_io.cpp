@@ -0,0 +1,206 @@
+#include <jinx/assert.hpp>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/posix.hpp>
+
+using namespace jinx;
+
+typedef epoll::EventEngineEpoll EventEngine;
+typedef AsyncImplement<EventEngine> async;
+typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+const int rounds = 100;
+int echoed = 0;
+int received = 0;
+
+class Echo : public AsyncRoutine {
+    int _fd{-1};
+    char _buffer[32];
+
+    asyncio::Read _read{};
+    asyncio::Write _write{};
+
+public:
+    Echo& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Echo::read);
+        return *this;
+    }
+
+protected:
+    Async read() {
+        return *this / _read(_fd, SliceMutable{_buffer, sizeof(_buffer)}) / &Echo::write;
+    }
+
+    Async write() {
+        if (_read.get_result() == 0) {
+            return async_return();
+        }
+        echoed += 1;
+        return *this / _write(_fd, SliceConst{_buffer, (size_t)_read.get_result()}) / &Echo::read;
+    }
+};
+
+class Client : public AsyncRoutine {
+    posix::IOHandle* _handle{nullptr};
+    int _count{0};
+    char _buffer[32];
+
+    asyncio::Read _read{};
+    asyncio::Write _write{};
+
+public:
+    Client& operator ()(posix::IOHandle& handle) {
+        _handle = &handle;
+        async_start(&Client::write);
+        return *this;
+    }
+
+protected:
+    Async write() {
+        if (_count == rounds) {
+            // the echo routine reads end of file
+            _handle->reset();
+            return async_return();
+        }
+        _count += 1;
+        return *this / _write(_handle->native_handle(), SliceConst{"hello", 5}) / &Client::read;
+    }
+
+    Async read() {
+        return *this / _read(_handle->native_handle(), SliceMutable{_buffer, sizeof(_buffer)}) / &Client::check;
+    }
+
+    Async check() {
+        jinx_assert(_read.get_result() == 5);
+        jinx_assert(memcmp(_buffer, "hello", 5) == 0);
+        received += 1;
+        return write();
+    }
+};
+
+class Reader : public AsyncRoutine {
+    int _fd{-1};
+    char _buffer[8];
+    asyncio::Read _read{};
+
+public:
+    Reader& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Reader::read);
+        return *this;
+    }
+
+protected:
+    Async read() {
+        return *this / _read(_fd, SliceMutable{_buffer, sizeof(_buffer)}) / &Reader::finish;
+    }
+
+    Async finish() {
+        received += 1;
+        return async_return();
+    }
+};
+
+class Writer : public AsyncRoutine {
+    int _fd{-1};
+
+public:
+    Writer& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Writer::yield);
+        return *this;
+    }
+
+protected:
+    Async yield() {
+        return async_yield(&Writer::write);
+    }
+
+    Async write() {
+        jinx_assert(received == 0);
+        jinx_assert(::write(_fd, "x", 1) == 1);
+        return async_return();
+    }
+};
+
+static void echo()
+{
+    EventEngine eve(false);
+    Loop loop(&eve);
+
+    int fds[2];
+    jinx_assert(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+    posix::IOHandle server{fds[0]};
+    posix::IOHandle client{fds[1]};
+
+    loop.task_new<Echo>(server.native_handle());
+    loop.task_new<Client>(client);
+    loop.run();
+
+    jinx_assert(echoed == rounds);
+    jinx_assert(received == rounds);
+
+    // each descriptor is registered once, however many times it waits
+    jinx_assert(eve.get_control_count() == 2);
+}
+
+static void reuse()
+{
+    EventEngine eve(false);
+    Loop loop(&eve);
+
+    // the descriptor number is reused, the new pipe must be registered again
+    for (int i = 0; i < 2; ++i) {
+        int fds[2];
+        jinx_assert(::pipe2(fds, O_NONBLOCK) == 0);
+        posix::IOHandle reader{fds[0]};
+        posix::IOHandle writer{fds[1]};
+
+        received = 0;
+        loop.task_new<Reader>(reader.native_handle());
+        loop.task_new<Writer>(writer.native_handle());
+        loop.run();
+        jinx_assert(received == 1);
+    }
+    jinx_assert(eve.get_control_count() == 2);
+}
+
+static void churn()
+{
+    EventEngine eve(false);
+    Loop loop(&eve);
+
+    int fds[2];
+    jinx_assert(::pipe2(fds, O_NONBLOCK) == 0);
+    posix::IOHandle reader{fds[0]};
+    posix::IOHandle writer{fds[1]};
+
+    // closing other descriptors leaves the registration of the pipe valid
+    for (int i = 0; i < 3; ++i) {
+        int other[2];
+        jinx_assert(::pipe2(other, O_NONBLOCK) == 0);
+        posix::IOHandle{other[0]};
+        posix::IOHandle{other[1]};
+
+        received = 0;
+        loop.task_new<Reader>(reader.native_handle());
+        loop.task_new<Writer>(writer.native_handle());
+        loop.run();
+        jinx_assert(received == 1);
+    }
+    jinx_assert(eve.get_control_count() == 1);
+}
+
+int main(int argc, const char* argv[])
+{
+    echo();
+    reuse();
+    churn();
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <csignal>
+#include <jinx/assert.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <unistd.h>
+
+#include <jinx/async.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/loopgroup.hpp>
+
+using namespace jinx;
+
+typedef epoll::EventEngineEpoll EventEngine;
+typedef AsyncImplement<EventEngine> async;
+
+std::string order{};
+std::atomic<int> counter{0};
+
+class AsyncSleepFor : public AsyncRoutine {
+    async::Sleep _sleep{};
+    char _name{0};
+    int _ms{0};
+    std::chrono::steady_clock::time_point _start{};
+
+public:
+    AsyncSleepFor& operator ()(char name, int ms) {
+        _name = name;
+        _ms = ms;
+        async_start(&AsyncSleepFor::sleep);
+        return *this;
+    }
+
+protected:
+    Async sleep() {
+        _start = std::chrono::steady_clock::now();
+        return *this / _sleep(std::chrono::milliseconds(_ms)) / &AsyncSleepFor::finish;
+    }
+
+    Async finish() {
+        const auto elapsed = std::chrono::steady_clock::now() - _start;
+        jinx_assert(elapsed >= std::chrono::milliseconds(_ms));
+        // the sleeps of the loop group only count, from their threads
+        if (_name != 'x') {
+            order.push_back(_name);
+        }
+        counter += 1;
+        return async_return();
+    }
+};
+
+class AsyncSignal : public AsyncRoutine {
+    EventEngine::EventHandleSignal _signal{};
+
+public:
+    AsyncSignal& operator ()() {
+        async_start(&AsyncSignal::prepare);
+        return *this;
+    }
+
+protected:
+    Async prepare() {
+        EventEngine::add_signal(this, _signal, SIGUSR1, &AsyncSignal::on_signal, this).abort_on(Failed_, "register signal event failed");
+        async_start(&AsyncSignal::finish);
+        return this->async_suspend();
+    }
+
+    Async finish() {
+        order.push_back('s');
+        return async_return();
+    }
+
+    static void on_signal(const error::Error& error, void* data) {
+        auto* self = reinterpret_cast<AsyncSignal*>(data);
+        EventEngine::remove_signal(self, self->_signal) >> JINX_IGNORE_RESULT;
+        self->async_resume(error) >> JINX_IGNORE_RESULT;
+    }
+};
+
+class AsyncKill : public AsyncRoutine {
+public:
+    AsyncKill& operator ()() {
+        async_start(&AsyncKill::yield);
+        return *this;
+    }
+
+protected:
+    Async yield() {
+        return this->async_yield(&AsyncKill::kill);
+    }
+
+    Async kill() {
+        ::kill(getpid(), SIGUSR1);
+        return async_return();
+    }
+};
+
+int main(int argc, const char* argv[])
+{
+    {
+        // timers fire by deadline, not by insertion
+        EventEngine eve(false);
+        Loop loop(&eve);
+        auto& wheel = loop.get_timer_wheel<EventEngine>();
+        const auto base = TimerWheel::Clock::now();
+        TimerWheel::Entry timers[4]{};
+        const char names[] = "cadb";
+        const int ms[] = {30, 10, 40, 20};
+        for (int i = 0; i < 4; ++i) {
+            jinx_assert(wheel.add(
+                timers[i],
+                base + std::chrono::milliseconds(ms[i]),
+                [](void* arg) { order.push_back(*static_cast<const char*>(arg)); },
+                const_cast<char*>(&names[i])).is(Successful_));
+        }
+        // a timeout starts when the sleep is added, after the deadlines above
+        loop.task_new<AsyncSleepFor>('e', 40);
+        loop.run();
+        jinx_assert(order == "abcde");
+    }
+
+    {
+        order.clear();
+        EventEngine eve(false);
+        Loop loop(&eve);
+        loop.task_new<AsyncSignal>();
+        loop.task_new<AsyncKill>();
+        loop.run();
+        jinx_assert(order == "s");
+    }
+
+    {
+        // cross thread submission wakes up the blocking engine
+        counter = 0;
+        LoopGroup<EventEngine> group{2};
+        group.start();
+        for (int i = 0; i < 8; ++i) {
+            jinx_assert(group.task_new_round_robin<AsyncSleepFor>('x', 1).is(Successful_));
+        }
+        group.stop();
+        group.join();
+        jinx_assert(counter == 8);
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <jinx/assert.hpp>
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/file.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+struct BufferConfigDirect
+{
+    constexpr static char const* Name = "Direct";
+    // 16 pages of data and one for the alignment
+    static constexpr const size_t Size = 17 * 4096;
+    static constexpr const size_t Reserve = 2;
+    static constexpr const long Limit = -1;
+
+    struct Information { };
+};
+
+typedef BufferAllocator<posix::MemoryProvider, BufferConfigDirect> AllocatorType;
+typedef file::ReadDirect<AllocatorType, BufferConfigDirect> ReaderType;
+
+// not a multiple of the chunk
+const size_t file_size = 1024 * 1024 + 1234;
+const char* const file_name = "test_file_read_direct.data";
+
+std::vector<char> received{};
+size_t chunks = 0;
+
+inline char pattern(size_t offset) {
+    return static_cast<char>(offset % 251);
+}
+
+class Reader : public AsyncRoutine {
+    ReaderType* _reader{nullptr};
+
+public:
+    Reader& operator ()(ReaderType* reader) {
+        _reader = reader;
+        async_start(&Reader::read);
+        return *this;
+    }
+
+protected:
+    Async read() {
+        return *this / (*_reader)() / &Reader::check;
+    }
+
+    Async check() {
+        auto& buffer = _reader->get_result();
+        if (buffer == nullptr) {
+            return async_return();
+        }
+        // page aligned for O_DIRECT
+        jinx_assert(reinterpret_cast<uintptr_t>(buffer->begin()) % 4096 == 0);
+        jinx_assert(buffer->size() <= _reader->chunk_size());
+        jinx_assert(_reader->in_flight() > 0 or received.size() + buffer->size() + _reader->chunk_size() > file_size);
+
+        received.insert(received.end(), buffer->begin(), buffer->end());
+        chunks += 1;
+        buffer.reset();
+        return read();
+    }
+};
+
+int main(int argc, const char* argv[])
+{
+    {
+        FILE* file = fopen(file_name, "wb");
+        jinx_assert(file != nullptr);
+        for (size_t i = 0; i < file_size; ++i) {
+            fputc(pattern(i), file);
+        }
+        fclose(file);
+    }
+
+    libevent::EventEngineLibevent eve{true};
+    Loop loop{&eve};
+    posix::MemoryProvider memory{};
+    AllocatorType allocator{memory};
+    {
+        offload::Offload pool{loop, 2};
+        ReaderType reader{pool, allocator, 4};
+        jinx_assert(reader.open(file_name).unwrap() >= 0);
+        jinx_assert(reader.chunk_size() == 16 * 4096);
+
+        loop.task_new<Reader>(&reader);
+        loop.run();
+        reader.close();
+    }
+
+    jinx_assert(received.size() == file_size);
+    for (size_t i = 0; i < received.size(); ++i) {
+        jinx_assert(received[i] == pattern(i));
+    }
+    jinx_assert(chunks == (file_size + 16 * 4096 - 1) / (16 * 4096));
+    jinx_assert(allocator.active_buffer_count() == allocator.reserve_buffer_count());
+
+    // missing file
+    {
+        offload::Offload pool{loop, 1};
+        ReaderType reader{pool, allocator};
+        jinx_assert(reader.open("test_file_read_direct.missing").unwrap() == -1);
+    }
+
+    ::unlink(file_name);
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include <jinx/assert.hpp>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/iouring.hpp>
+#include <jinx/streamsocket.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+int timeouts = 0;
+int reads = 0;
+
+template<typename EventEngine>
+class Reader : public AsyncRoutine {
+    typedef stream::StreamSocket<posix::AsyncIOPosix<EventEngine>> StreamType;
+
+    StreamType* _stream{nullptr};
+    char _memory[16];
+    BufferView _view{};
+    TimerWheel::Clock::time_point _start{};
+
+public:
+    Reader& operator ()(StreamType* stream) {
+        _stream = stream;
+        async_start(&Reader::read);
+        return *this;
+    }
+
+protected:
+    Async handle_error(const error::Error& error) override {
+        jinx_assert(error == make_error(posix::ErrorPosix::TimedOut));
+        jinx_assert(TimerWheel::Clock::now() - _start >= std::chrono::milliseconds(20));
+        timeouts += 1;
+        return async_return();
+    }
+
+    Async read() {
+        _start = TimerWheel::Clock::now();
+        _view = BufferView{_memory, sizeof(_memory), 0, 0};
+        return *this / _stream->read(&_view) / &Reader::check;
+    }
+
+    Async check() {
+        jinx_assert(_view.size() == 5);
+        jinx_assert(memcmp(_view.data(), "hello", 5) == 0);
+        reads += 1;
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+class Recv : public AsyncRoutine {
+    typename posix::AsyncIOPosix<EventEngine>::Recv _recv{};
+    int _fd{-1};
+    char _memory[16];
+
+public:
+    Recv& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Recv::recv);
+        return *this;
+    }
+
+protected:
+    Async handle_error(const error::Error& error) override {
+        jinx_assert(error == make_error(posix::ErrorPosix::TimedOut));
+        timeouts += 1;
+        return async_return();
+    }
+
+    Async recv() {
+        return *this
+            / _recv.set_timeout(std::chrono::milliseconds(20))(_fd, SliceMutable{_memory, sizeof(_memory)}, 0)
+            / &Recv::finish;
+    }
+
+    Async finish() { // NOLINT
+        abort();
+    }
+};
+
+template<typename EventEngine>
+class Reuse : public AsyncRoutine {
+    typename posix::AsyncIOPosix<EventEngine>::Recv _recv{};
+    typename AsyncImplement<EventEngine>::Sleep _sleep{};
+    int _fd{-1};
+    int _peer{-1};
+    char _memory[16];
+    char _again[16];
+
+public:
+    Reuse& operator ()(int fd, int peer) {
+        _fd = fd;
+        _peer = peer;
+        async_start(&Reuse::recv);
+        return *this;
+    }
+
+protected:
+    Async handle_error(const error::Error& error) override {
+        jinx_assert(error == make_error(posix::ErrorPosix::TimedOut));
+        timeouts += 1;
+
+        // the timed out receive must not take the data nor write to the memory reused
+        memset(_memory, 'z', sizeof(_memory));
+        jinx_assert(::send(_peer, "hello", 5, 0) == 5);
+        return *this / _sleep(std::chrono::milliseconds(10)) / &Reuse::recv_again;
+    }
+
+    Async recv() {
+        return *this
+            / _recv.set_timeout(std::chrono::milliseconds(20))(_fd, SliceMutable{_memory, sizeof(_memory)}, 0)
+            / &Reuse::finish;
+    }
+
+    Async recv_again() {
+        for (char c : _memory) {
+            jinx_assert(c == 'z');
+        }
+        return *this / _recv(_fd, SliceMutable{_again, sizeof(_again)}, 0) / &Reuse::check;
+    }
+
+    Async check() {
+        jinx_assert(_recv.get_result() == 5);
+        jinx_assert(memcmp(_again, "hello", 5) == 0);
+        reads += 1;
+        return async_return();
+    }
+
+    Async finish() { // NOLINT
+        abort();
+    }
+};
+
+template<typename EventEngine>
+class Writer : public AsyncRoutine {
+    typename AsyncImplement<EventEngine>::Sleep _sleep{};
+    int _fd{-1};
+
+public:
+    Writer& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Writer::sleep);
+        return *this;
+    }
+
+protected:
+    Async sleep() {
+        return *this / _sleep(std::chrono::milliseconds(5)) / &Writer::write;
+    }
+
+    Async write() {
+        jinx_assert(::send(_fd, "hello", 5, 0) == 5);
+        return async_return();
+    }
+};
+
+template<typename EventEngine, typename... Args>
+void run(Args&&... args) {
+    typedef stream::StreamSocket<posix::AsyncIOPosix<EventEngine>> StreamType;
+
+    EventEngine eve{std::forward<Args>(args)...};
+    Loop loop{&eve};
+    timeouts = 0;
+    reads = 0;
+
+    int socks[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+    posix::Socket sock{socks[0]};
+    sock.set_non_blocking(true);
+
+    StreamType stream{};
+    stream.initialize(std::move(sock));
+    stream.set_read_timeout(std::chrono::milliseconds(20));
+
+    // the peer is silent
+    loop.task_new<Reader<EventEngine>>(&stream);
+    loop.run();
+    jinx_assert(timeouts == 1 and reads == 0);
+
+    // the peer answers in time, the deadline is dropped
+    loop.task_new<Reader<EventEngine>>(&stream);
+    loop.task_new<Writer<EventEngine>>(socks[1]);
+    loop.run();
+    jinx_assert(timeouts == 1 and reads == 1);
+    jinx_assert(loop.get_timer_wheel<EventEngine>().size() == 0);
+
+    // a single operation
+    int pair[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair) == 0);
+    loop.task_new<Recv<EventEngine>>(pair[0]);
+    loop.run();
+    jinx_assert(timeouts == 2);
+
+    // the memory of a timed out receive is reused
+    loop.task_new<Reuse<EventEngine>>(pair[0], pair[1]);
+    loop.run();
+    jinx_assert(timeouts == 3 and reads == 2);
+
+    stream.reset();
+    ::close(socks[1]);
+    ::close(pair[0]);
+    ::close(pair[1]);
+    eve.poll_non_blocking();
+}
+
+int main(int argc, const char* argv[])
+{
+    run<libevent::EventEngineLibevent>(false);
+    run<epoll::EventEngineEpoll>(false);
+    run<iouring::EventEngineIoUring>(false, 256U);
+    return 0;
+}
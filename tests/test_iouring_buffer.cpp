@@ -0,0 +1,343 @@
+#include <jinx/assert.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/iouring.hpp>
+#include <jinx/posix.hpp>
+#include <jinx/streamsocket.hpp>
+
+using namespace jinx;
+
+typedef iouring::EventEngineIoUring EventEngine;
+typedef AsyncImplement<EventEngine> async;
+typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+struct BufferConfig
+{
+    constexpr static char const* Name = "Recv";
+    static constexpr const size_t Size = 256;
+    static constexpr const size_t Reserve = 0;
+    static constexpr const long Limit = -1;
+
+    struct Information { };
+};
+
+typedef buffer::BufferAllocator<posix::MemoryProvider, BufferConfig> AllocatorType;
+typedef iouring::BufferRingPool<AllocatorType, BufferConfig> RingType;
+typedef stream::StreamSocket<asyncio> StreamType;
+
+const int rounds = 20;
+const int connections = 64;
+const unsigned int entries = 16;
+const char message[] = "hello";
+
+RingType* ring = nullptr;
+AllocatorType* allocator = nullptr;
+int readers_done = 0;
+size_t idle_buffers = 0;
+
+class Reader : public AsyncRoutine {
+    StreamType* _stream{nullptr};
+    iouring::RecvBuffer<RingType> _recv{ring};
+    size_t _received{0};
+
+public:
+    Reader& operator ()(StreamType* stream) {
+        _stream = stream;
+        async_start(&Reader::read);
+        return *this;
+    }
+
+protected:
+    Async read() {
+        return *this / _stream->read(_recv) / &Reader::check;
+    }
+
+    Async check() {
+        auto& buffer = _recv.get_result();
+        jinx_assert(buffer->size() > 0);
+        jinx_assert(buffer->size() % (sizeof(message) - 1) == 0);
+        jinx_assert(memcmp(buffer->begin(), message, sizeof(message) - 1) == 0);
+        _received += buffer->size();
+
+        if (_received == rounds * (sizeof(message) - 1)) {
+            readers_done += 1;
+            return async_return();
+        }
+        return async_yield(&Reader::read);
+    }
+};
+
+class Writer : public AsyncRoutine {
+    std::vector<int>* _peers{nullptr};
+    int _round{0};
+    async::Sleep _sleep{};
+
+public:
+    Writer& operator ()(std::vector<int>* peers) {
+        _peers = peers;
+        async_start(&Writer::idle);
+        return *this;
+    }
+
+protected:
+    Async idle() {
+        return *this / _sleep(std::chrono::milliseconds(10)) / &Writer::write;
+    }
+
+    Async write() {
+        // all readers wait, none holds a buffer
+        if (_round == 0) {
+            idle_buffers = allocator->active_buffer_count();
+        }
+
+        if (_round == rounds) {
+            return async_return();
+        }
+        _round += 1;
+
+        for (int fd : *_peers) {
+            jinx_assert(::send(fd, message, sizeof(message) - 1, 0) == sizeof(message) - 1);
+        }
+        return async_yield(&Writer::write);
+    }
+};
+
+void run(unsigned int ring_entries) {
+    EventEngine eve{false, ring_entries};
+    Loop loop{&eve};
+
+    posix::MemoryProvider memory{};
+    AllocatorType pool{memory};
+    RingType buffer_ring{eve, pool, entries};
+    allocator = &pool;
+    ring = &buffer_ring;
+    readers_done = 0;
+    idle_buffers = 0;
+
+    const bool provided = eve.is_ring_available() and eve.is_recv_multishot_available();
+    jinx_assert(buffer_ring.is_registered() == eve.is_ring_available());
+
+    std::vector<int> peers{};
+    std::vector<StreamType*> streams{};
+    for (int i = 0; i < connections; ++i) {
+        int socks[2];
+        jinx_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+        posix::Socket sock{socks[0]};
+        sock.set_non_blocking(true);
+
+        auto* stream = new StreamType{};
+        stream->initialize(std::move(sock));
+        streams.push_back(stream);
+        peers.push_back(socks[1]);
+
+        loop.task_new<Reader>(stream);
+    }
+    loop.task_new<Writer>(&peers);
+    loop.run();
+
+    jinx_assert(readers_done == connections);
+
+    if (provided) {
+        // the ring holds the only buffers of the idle readers
+        jinx_assert(buffer_ring.get_provided_count() == entries);
+        jinx_assert(idle_buffers == entries);
+    } else {
+        jinx_assert(idle_buffers == 0);
+    }
+
+    for (auto* stream : streams) {
+        delete stream;
+    }
+    for (int fd : peers) {
+        ::close(fd);
+    }
+    eve.poll_non_blocking();
+}
+
+const size_t queue_limit = 4;
+const int flood_messages = 40;
+size_t max_queued = 0;
+iouring::RecvBuffer<RingType>* flood_recv = nullptr;
+
+class FloodReader : public AsyncRoutine {
+    int _fd{-1};
+    iouring::RecvBuffer<RingType> _recv{ring, queue_limit};
+    async::Sleep _sleep{};
+    size_t _received{0};
+
+public:
+    FloodReader& operator ()(int fd) {
+        _fd = fd;
+        flood_recv = &_recv;
+        async_start(&FloodReader::read);
+        return *this;
+    }
+
+protected:
+    Async read() {
+        return *this / _recv(_fd) / &FloodReader::check;
+    }
+
+    Async check() {
+        auto& buffer = _recv.get_result();
+        jinx_assert(buffer->size() % (sizeof(message) - 1) == 0);
+        jinx_assert(memcmp(buffer->begin(), message, sizeof(message) - 1) == 0);
+        _received += buffer->size();
+        if (_received == (flood_messages + 1) * (sizeof(message) - 1)) {
+            flood_recv = nullptr;
+            return async_return();
+        }
+        if (_received == sizeof(message) - 1) {
+            // the receive stays armed while the peer floods
+            return *this / _sleep(std::chrono::milliseconds(100)) / &FloodReader::read;
+        }
+        return read();
+    }
+};
+
+class FloodWriter : public AsyncRoutine {
+    int _fd{-1};
+    int _count{0};
+    async::Sleep _sleep{};
+
+public:
+    FloodWriter& operator ()(int fd) {
+        _fd = fd;
+        async_start(&FloodWriter::write);
+        return *this;
+    }
+
+protected:
+    Async write() {
+        if (flood_recv != nullptr) {
+            max_queued = std::max(max_queued, flood_recv->get_queued_count());
+        }
+        if (_count == flood_messages + 1) {
+            return async_return();
+        }
+        _count += 1;
+        jinx_assert(::send(_fd, message, sizeof(message) - 1, 0) == sizeof(message) - 1);
+        return *this / _sleep(std::chrono::milliseconds(1)) / &FloodWriter::write;
+    }
+};
+
+void flood() {
+    EventEngine eve{false};
+    Loop loop{&eve};
+
+    posix::MemoryProvider memory{};
+    AllocatorType pool{memory};
+    RingType buffer_ring{eve, pool, entries};
+    ring = &buffer_ring;
+    max_queued = 0;
+
+    int socks[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, socks) == 0);
+    posix::IOHandle reader{socks[0]};
+    posix::IOHandle writer{socks[1]};
+
+    loop.task_new<FloodReader>(reader.native_handle());
+    loop.task_new<FloodWriter>(writer.native_handle());
+    loop.run();
+
+    // the queue is bounded, every byte still arrives
+    jinx_assert(max_queued <= queue_limit);
+    eve.poll_non_blocking();
+}
+
+posix::IOHandle* detach_pipe = nullptr;
+bool detach_done = false;
+
+class DetachReader : public AsyncRoutine {
+    int _fd{-1};
+    int _peer{-1};
+    iouring::RecvBuffer<RingType> _recv{ring};
+    asyncio::Read _read{};
+    async::Sleep _sleep{};
+    char _byte{0};
+
+public:
+    DetachReader& operator ()(int fd, int peer) {
+        _fd = fd;
+        _peer = peer;
+        jinx_assert(::send(_peer, "a", 1, 0) == 1);
+        async_start(&DetachReader::receive);
+        return *this;
+    }
+
+protected:
+    Async receive() {
+        return *this / _recv(_fd) / &DetachReader::unregister;
+    }
+
+    Async unregister() {
+        jinx_assert(_recv.get_result()->size() == 1);
+
+        // the armed receive completes with more after its ring is gone
+        jinx_assert(::send(_peer, "b", 1, 0) == 1);
+        delete ring;
+        ring = nullptr;
+        return *this / _sleep(std::chrono::milliseconds(5)) / &DetachReader::reuse;
+    }
+
+    Async reuse() {
+        // the next operation must not take the operation of the receive
+        jinx_assert(::send(_peer, "c", 1, 0) == 1);
+        jinx_assert(::write(detach_pipe[1].native_handle(), "d", 1) == 1);
+        return *this / _read(detach_pipe[0].native_handle(), SliceMutable{&_byte, 1}) / &DetachReader::check;
+    }
+
+    Async check() {
+        jinx_assert(_read.get_result() == 1);
+        jinx_assert(_byte == 'd');
+        detach_done = true;
+        return async_return();
+    }
+};
+
+void detach() {
+    EventEngine eve{false};
+    Loop loop{&eve};
+
+    posix::MemoryProvider memory{};
+    AllocatorType pool{memory};
+    ring = new RingType{eve, pool, entries};
+
+    int socks[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, socks) == 0);
+    posix::IOHandle reader{socks[0]};
+    posix::IOHandle writer{socks[1]};
+
+    int fds[2];
+    jinx_assert(::pipe2(fds, O_NONBLOCK) == 0);
+    posix::IOHandle pipe[2]{posix::IOHandle{fds[0]}, posix::IOHandle{fds[1]}};
+    detach_pipe = pipe;
+    detach_done = false;
+
+    loop.task_new<DetachReader>(reader.native_handle(), writer.native_handle());
+    loop.run();
+    jinx_assert(detach_done);
+    eve.poll_non_blocking();
+
+    // every operation is recycled once, on its last completion
+    jinx_assert(eve.get_complete_count() == eve.get_submit_count());
+}
+
+int main(int argc, const char* argv[])
+{
+    flood();
+    detach();
+
+    run(256);
+
+    // readiness fallback
+    run(0);
+    return 0;
+}
@@ -0,0 +1,266 @@
+#include <jinx/assert.hpp>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/iouring.hpp>
+#include <jinx/posix.hpp>
+
+using namespace jinx;
+
+typedef iouring::EventEngineIoUring EventEngine;
+typedef AsyncImplement<EventEngine> async;
+typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+const int rounds = 100;
+const int connections = 16;
+int echoed = 0;
+int received = 0;
+
+class Echo : public AsyncRoutine {
+    posix::Socket _sock{};
+    int _fd{-1};
+    char _buffer[32];
+
+    asyncio::Recv _recv{};
+    asyncio::Send _send{};
+
+public:
+    Echo& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Echo::recv);
+        return *this;
+    }
+
+    Echo& operator ()(posix::Socket&& sock) {
+        _sock = std::move(sock);
+        return (*this)(_sock.native_handle());
+    }
+
+protected:
+    Async recv() {
+        return *this / _recv(_fd, SliceMutable{_buffer, sizeof(_buffer)}, 0) / &Echo::send;
+    }
+
+    Async send() {
+        if (_recv.get_result() == 0) {
+            return async_return();
+        }
+        echoed += 1;
+        return *this / _send(_fd, SliceConst{_buffer, (size_t)_recv.get_result()}, 0) / &Echo::recv;
+    }
+};
+
+class Client : public AsyncRoutine {
+    posix::Socket _sock{};
+    int _fd{-1};
+    int _count{0};
+    char _buffer[32];
+
+    asyncio::Read _read{};
+    asyncio::Write _write{};
+
+public:
+    Client& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Client::write);
+        return *this;
+    }
+
+    Client& operator ()(posix::Socket&& sock) {
+        _sock = std::move(sock);
+        return (*this)(_sock.native_handle());
+    }
+
+protected:
+    Async write() {
+        if (_count == rounds) {
+            ::shutdown(_fd, SHUT_WR);
+            return async_return();
+        }
+        _count += 1;
+        return *this / _write(_fd, SliceConst{"hello", 5}) / &Client::read;
+    }
+
+    Async read() {
+        return *this / _read(_fd, SliceMutable{_buffer, sizeof(_buffer)}) / &Client::check;
+    }
+
+    Async check() {
+        jinx_assert(_read.get_result() == 5);
+        jinx_assert(memcmp(_buffer, "hello", 5) == 0);
+        received += 1;
+        return write();
+    }
+};
+
+class Acceptor : public AsyncRoutine {
+    posix::Socket* _sock{nullptr};
+    asyncio::Accept _accept{};
+
+public:
+    Acceptor& operator ()(posix::Socket& sock) {
+        _sock = &sock;
+        async_start(&Acceptor::accept);
+        return *this;
+    }
+
+protected:
+    Async accept() {
+        return *this / _accept(_sock->native_handle(), nullptr, nullptr) / &Acceptor::spawn;
+    }
+
+    Async spawn() {
+        posix::Socket peer{_accept.get_result()};
+        peer.set_non_blocking(true);
+        this->task_new<Echo>(std::move(peer));
+        return async_return();
+    }
+};
+
+class Connector : public AsyncRoutine {
+    posix::Socket _sock{};
+    posix::SocketAddress _addr{};
+    asyncio::Connect _connect{};
+
+public:
+    Connector& operator ()(const posix::SocketAddress& addr) {
+        jinx_assert(_sock.create(AF_INET, SOCK_STREAM, 0).unwrap() >= 0);
+        _sock.set_non_blocking(true);
+        _addr = addr;
+        async_start(&Connector::connect);
+        return *this;
+    }
+
+protected:
+    Async connect() {
+        return *this / _connect(_sock.native_handle(), _addr.data(), _addr.size()) / &Connector::spawn;
+    }
+
+    Async spawn() {
+        this->task_new<Client>(std::move(_sock));
+        return async_return();
+    }
+};
+
+class Waiter : public AsyncRoutine {
+    int _fd{-1};
+    char _buffer[8];
+    asyncio::Recv _recv{};
+
+public:
+    Waiter& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Waiter::recv);
+        return *this;
+    }
+
+protected:
+    Async recv() {
+        return *this / _recv(_fd, SliceMutable{_buffer, sizeof(_buffer)}, 0) / &Waiter::finish;
+    }
+
+    Async finish() {
+        jinx_assert(false && "unreachable");
+        return async_return();
+    }
+};
+
+class Canceller : public AsyncRoutine {
+    TaskPtr _task{};
+
+public:
+    Canceller& operator ()(TaskPtr& task) {
+        _task = task;
+        async_start(&Canceller::yield);
+        return *this;
+    }
+
+protected:
+    Async yield() {
+        return this->async_yield(&Canceller::cancel);
+    }
+
+    Async cancel() {
+        jinx_assert(async_cancel(_task).unwrap() == ErrorCancel::NoError);
+        _task.reset();
+        return async_return();
+    }
+};
+
+static void echo(EventEngine& eve)
+{
+    Loop loop(&eve);
+
+    echoed = 0;
+    received = 0;
+
+    std::vector<posix::IOHandle> handles{};
+    for (int i = 0; i < connections; ++i) {
+        int fds[2];
+        jinx_assert(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+        handles.emplace_back(fds[0]);
+        handles.emplace_back(fds[1]);
+        loop.task_new<Echo>(fds[0]);
+        loop.task_new<Client>(fds[1]);
+    }
+
+    // accept and connect
+    posix::SocketAddress addr{"127.0.0.1", 0, posix::SocketAddressAbortOnFailure};
+    posix::Socket sock{::socket(AF_INET, SOCK_STREAM, 0)};
+    sock.set_non_blocking(true);
+    jinx_assert(sock.bind(addr).unwrap() == 0);
+    jinx_assert(sock.listen(4).unwrap() == 0);
+    jinx_assert(sock.get_socket_name(addr).unwrap() == 0);
+    loop.task_new<Acceptor>(sock);
+    loop.task_new<Connector>(addr);
+
+    loop.run();
+    jinx_assert(echoed == rounds * (connections + 1));
+    jinx_assert(received == rounds * (connections + 1));
+}
+
+static void cancel(EventEngine& eve)
+{
+    Loop loop(&eve);
+
+    int fds[2];
+    jinx_assert(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+    posix::IOHandle reader{fds[0]};
+    posix::IOHandle writer{fds[1]};
+
+    auto task = loop.task_new<Waiter>(reader.native_handle());
+    loop.task_new<Canceller>(task);
+    task.reset();
+    loop.run();
+
+    // the loop is done before the cancellation completes
+    eve.poll();
+}
+
+int main(int argc, const char* argv[])
+{
+    {
+        EventEngine eve(false);
+        echo(eve);
+        cancel(eve);
+
+        if (eve.is_ring_available()) {
+            // reads go to the ring, writes complete right away, a tick shares one enter
+            jinx_assert(eve.get_submit_count() >= rounds * (connections + 1) * 2);
+            jinx_assert(eve.get_enter_count() * 4 < eve.get_submit_count());
+            jinx_assert(eve.get_complete_count() == eve.get_submit_count());
+        }
+    }
+
+    {
+        // readiness fallback
+        EventEngine eve(false, 0);
+        jinx_assert(not eve.is_ring_available());
+        echo(eve);
+        cancel(eve);
+        jinx_assert(eve.get_submit_count() == 0);
+    }
+    return 0;
+}
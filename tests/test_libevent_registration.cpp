@@ -0,0 +1,124 @@
+#include <jinx/assert.hpp>
+#include <cstring>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/streamsocket.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+typedef libevent::EventEngineLibevent EventEngine;
+typedef posix::AsyncIOPosix<EventEngine> asyncio;
+typedef stream::StreamSocket<asyncio> StreamType;
+
+const int rounds = 100;
+int pongs = 0;
+
+class Ping : public AsyncRoutine {
+    StreamType* _stream{nullptr};
+    int _round{0};
+    char _memory[16];
+    BufferView _view{};
+
+public:
+    Ping& operator ()(StreamType* stream) {
+        _stream = stream;
+        async_start(&Ping::write);
+        return *this;
+    }
+
+protected:
+    Async write() {
+        if (_round == rounds) {
+            return async_return();
+        }
+        _round += 1;
+        memcpy(_memory, "ping", 4);
+        _view = BufferView{_memory, sizeof(_memory), 0, 4};
+        return *this / _stream->write(&_view) / &Ping::read;
+    }
+
+    Async read() {
+        _view = BufferView{_memory, sizeof(_memory), 0, 0};
+        return *this / _stream->read(&_view) / &Ping::check;
+    }
+
+    Async check() {
+        jinx_assert(_view.size() == 4);
+        jinx_assert(memcmp(_view.data(), "pong", 4) == 0);
+        pongs += 1;
+        return write();
+    }
+};
+
+class Pong : public AsyncRoutine {
+    StreamType* _stream{nullptr};
+    int _round{0};
+    char _memory[16];
+    BufferView _view{};
+
+public:
+    Pong& operator ()(StreamType* stream) {
+        _stream = stream;
+        async_start(&Pong::read);
+        return *this;
+    }
+
+protected:
+    Async read() {
+        if (_round == rounds) {
+            return async_return();
+        }
+        _round += 1;
+        _view = BufferView{_memory, sizeof(_memory), 0, 0};
+        return *this / _stream->read(&_view) / &Pong::write;
+    }
+
+    Async write() {
+        jinx_assert(_view.size() == 4);
+        jinx_assert(memcmp(_view.data(), "ping", 4) == 0);
+        memcpy(_memory, "pong", 4);
+        _view = BufferView{_memory, sizeof(_memory), 0, 4};
+        return *this / _stream->write(&_view) / &Pong::read;
+    }
+};
+
+void connect(StreamType& a, StreamType& b) {
+    int socks[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+    posix::Socket sock1{socks[0]};
+    posix::Socket sock2{socks[1]};
+    sock1.set_non_blocking(true);
+    sock2.set_non_blocking(true);
+    a.initialize(std::move(sock1));
+    b.initialize(std::move(sock2));
+}
+
+int main(int argc, const char* argv[])
+{
+    EventEngine eve{false};
+    Loop loop{&eve};
+
+    StreamType ping{};
+    StreamType pong{};
+
+    // every read waits, each socket is added once
+    connect(ping, pong);
+    loop.task_new<Ping>(&ping);
+    loop.task_new<Pong>(&pong);
+    loop.run();
+    jinx_assert(pongs == rounds);
+    jinx_assert(eve.get_control_count() == 2);
+
+    // the registrations follow the new sockets, likely the same numbers
+    connect(ping, pong);
+    loop.task_new<Ping>(&ping);
+    loop.task_new<Pong>(&pong);
+    loop.run();
+    jinx_assert(pongs == rounds * 2);
+    jinx_assert(eve.get_control_count() == 4);
+    return 0;
+}
@@ -42,5 +42,25 @@ int main(int argc, const char* argv[])
     jinx_assert(list.erase(&node2).is(Successful_));
     jinx_assert(list.erase(&node3).is(Successful_));
     jinx_assert(list.empty());
+
+    // the first node pushed back is the head
+    jinx_assert(list.push_back(&node1).is(Successful_));
+    jinx_assert(list.front() == &node1);
+    jinx_assert(list.back() == &node1);
+    jinx_assert(list.push_back(&node2).is(Successful_));
+    jinx_assert(list.push_back(&node3).is(Successful_));
+
+    idx = 0;
+    list.for_each([&](mynode* node) {
+        jinx_assert(node->_i == idx);
+        ++idx;
+    });
+    jinx_assert(idx == 3);
+
+    jinx_assert(list.pop_front().is(Successful_));
+    jinx_assert(list.front() == &node2);
+    jinx_assert(list.pop_front().is(Successful_));
+    jinx_assert(list.pop_front().is(Successful_));
+    jinx_assert(list.empty());
     return 0;
 }
@@ -0,0 +1,78 @@
+#include <jinx/assert.hpp>
+#include <thread>
+#include <vector>
+
+#include <jinx/linkedlist.hpp>
+
+using namespace jinx;
+
+struct mynode : public LinkedListMPSC<mynode>::Node
+{
+    int _producer{0};
+    int _i{0};
+    mynode() = default;
+    explicit mynode(int val) : _i(val) { }
+};
+
+int main(int argc, const char* argv[])
+{
+    LinkedListMPSC<mynode> list;
+    mynode node1{0};
+    mynode node2{1};
+    mynode node3{2};
+
+    jinx_assert(list.pop() == nullptr);
+    jinx_assert(list.is_empty_unsafe());
+
+    list.push(&node1);
+    list.push(&node2);
+    list.push(&node3);
+    jinx_assert(list.get_size_unsafe() == 3);
+
+    jinx_assert(list.pop() == &node1);
+    jinx_assert(list.pop() == &node2);
+
+    // reuse a popped node
+    list.push(&node1);
+    jinx_assert(list.pop() == &node3);
+    jinx_assert(list.pop() == &node1);
+    jinx_assert(list.pop() == nullptr);
+    jinx_assert(list.is_empty_unsafe());
+
+    // multi-producer, order of each producer must be kept
+    const int producers = 4;
+    const int count = 10000;
+    std::vector<mynode> nodes(producers * count);
+    std::vector<std::thread> threads{};
+
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < count; ++i) {
+                auto& node = nodes[p * count + i];
+                node._producer = p;
+                node._i = i;
+                list.push(&node);
+            }
+        });
+    }
+
+    std::vector<int> last(producers, -1);
+    int popped = 0;
+    while (popped != producers * count) {
+        auto* node = list.pop();
+        if (node == nullptr) {
+            continue;
+        }
+        jinx_assert(node->_i == last[node->_producer] + 1);
+        last[node->_producer] = node->_i;
+        ++popped;
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    jinx_assert(list.pop() == nullptr);
+    jinx_assert(list.is_empty_unsafe());
+    return 0;
+}
@@ -28,7 +28,7 @@ protected:
     }
 
     Async finish() {
-        jinx_assert(counter == 1);
+        jinx_assert(counter == 0);
         counter += 1;
         _lock->unlock();
         return this->async_return();
@@ -56,7 +56,7 @@ public:
     }
 
     Async finish() {
-        jinx_assert(counter == 0);
+        jinx_assert(counter == 1);
         counter += 1;
         _lock->unlock();
         return this->async_return();
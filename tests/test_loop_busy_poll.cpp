@@ -0,0 +1,68 @@
+#include <jinx/assert.hpp>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+
+using namespace jinx;
+
+typedef AsyncImplement<libevent::EventEngineLibevent> async;
+
+const int count = 5;
+int woken = 0;
+
+class AsyncNap : public AsyncRoutine {
+    async::Sleep _sleep{};
+    int _count{0};
+
+public:
+    AsyncNap& operator ()() {
+        async_start(&AsyncNap::nap);
+        return *this;
+    }
+
+protected:
+    Async nap() {
+        if (_count == count) {
+            return async_return();
+        }
+        _count += 1;
+        return *this / _sleep(std::chrono::milliseconds(2)) / &AsyncNap::wake;
+    }
+
+    Async wake() {
+        woken += 1;
+        return nap();
+    }
+};
+
+void run(Loop& loop, std::chrono::microseconds window) {
+    woken = 0;
+    loop.set_busy_poll(window);
+    loop.reset_busy_poll_counters();
+    loop.task_new<AsyncNap>();
+    loop.run();
+    jinx_assert(woken == count);
+}
+
+int main(int argc, const char* argv[])
+{
+    libevent::EventEngineLibevent eve{false};
+    Loop loop{&eve};
+
+    // blocking polls only
+    run(loop, std::chrono::microseconds{0});
+    jinx_assert(loop.get_busy_poll_spin_count() == 0);
+    jinx_assert(loop.get_busy_poll_sleep_count() == 0);
+
+    // every nap ends within the window
+    run(loop, std::chrono::seconds{1});
+    jinx_assert(loop.get_busy_poll_hit_count() == count);
+    jinx_assert(loop.get_busy_poll_sleep_count() == 0);
+    jinx_assert(loop.get_busy_poll_spin_count() >= count);
+
+    // every nap outlasts the window
+    run(loop, std::chrono::microseconds{1});
+    jinx_assert(loop.get_busy_poll_sleep_count() == count);
+    jinx_assert(loop.get_busy_poll_hit_count() == 0);
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <jinx/assert.hpp>
+#include <thread>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+
+using namespace jinx;
+
+typedef AsyncImplement<libevent::EventEngineLibevent> async;
+
+const int count = 10000;
+int counter = 0;
+std::thread::id loop_thread{};
+Loop* loop_ptr{nullptr};
+
+template<typename T, typename... Args>
+TaskPtr make_task(Args&&... args) {
+    typedef typename T::template TaskHeapType<T> TaskHeapType;
+    auto* task = TaskHeapType::template new_task<TaskHeapType>();
+    TaskPtr ptr{task};
+    (*task)(std::forward<Args>(args)...);
+    return ptr;
+}
+
+class AsyncCount : public AsyncRoutine {
+public:
+    AsyncCount& operator ()() {
+        async_start(&AsyncCount::count);
+        return *this;
+    }
+
+protected:
+    Async count() {
+        jinx_assert(loop_thread == std::this_thread::get_id());
+        counter += 1;
+        return async_return();
+    }
+};
+
+class AsyncKeeper : public AsyncRoutine {
+public:
+    AsyncKeeper& operator ()() {
+        async_start(&AsyncKeeper::wait);
+        return *this;
+    }
+
+protected:
+    Async wait() {
+        return async_suspend();
+    }
+};
+
+class AsyncFinish : public AsyncRoutine {
+    TaskPtr _keeper{};
+
+public:
+    AsyncFinish& operator ()(TaskPtr& keeper) {
+        _keeper = keeper;
+        async_start(&AsyncFinish::finish);
+        return *this;
+    }
+
+protected:
+    Async finish() {
+        jinx_assert(counter == count);
+        jinx_assert(async_cancel(_keeper).unwrap() == ErrorCancel::NoError);
+        _keeper.reset();
+
+        // post from the loop thread spawns directly
+        jinx_assert(loop_ptr->is_owner_thread());
+        auto task = make_task<AsyncCount>();
+        auto copy = task;
+        jinx_assert(loop_ptr->post(std::move(task)).is(Successful_));
+        jinx_assert(not task);
+        jinx_assert(loop_ptr->post(std::move(copy)).is(Failed_));
+        return async_return();
+    }
+};
+
+int main(int argc, const char* argv[])
+{
+    libevent::EventEngineLibevent eve{true};
+    Loop loop{&eve};
+    loop_ptr = &loop;
+
+    auto keeper = loop.task_new<AsyncKeeper>();
+    loop_thread = std::this_thread::get_id();
+
+    std::thread producer{[&]() {
+        for (int i = 0; i < count; ++i) {
+            auto task = make_task<AsyncCount>();
+            jinx_assert(loop.post(std::move(task)).is(Successful_));
+        }
+        auto task = make_task<AsyncFinish>(keeper);
+        jinx_assert(loop.post(std::move(task)).is(Successful_));
+    }};
+
+    loop.run();
+    producer.join();
+
+    jinx_assert(counter == count + 1);
+    jinx_assert(loop.get_load() == 0);
+    jinx_assert(not loop.is_owner_thread());
+
+    // posted tasks of a loop that never runs are released on exit
+    {
+        libevent::EventEngineLibevent eve2{true};
+        Loop loop2{&eve2};
+        std::thread thread{[&]() {
+            auto task = make_task<AsyncCount>();
+            jinx_assert(loop2.post(std::move(task)).is(Successful_));
+        }};
+        thread.join();
+        jinx_assert(loop2.get_load() == 1);
+        loop2.exit();
+        jinx_assert(loop2.get_load() == 0);
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <jinx/assert.hpp>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/loopgroup.hpp>
+
+using namespace jinx;
+
+typedef AsyncImplement<libevent::EventEngineLibevent> async;
+
+std::atomic<int> counter{0};
+std::mutex mutex{};
+std::set<std::thread::id> threads{};
+
+class AsyncTest : public AsyncRoutine {
+    async::Sleep _sleep{};
+
+public:
+    AsyncTest& operator ()() {
+        async_start(&AsyncTest::sleep);
+        return *this;
+    }
+
+protected:
+    Async sleep() {
+        return *this / _sleep(std::chrono::milliseconds(10)) / &AsyncTest::finish;
+    }
+
+    Async finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        }
+        counter += 1;
+        return async_return();
+    }
+};
+
+class AsyncForever : public AsyncRoutine {
+    async::Sleep _sleep{};
+
+public:
+    AsyncForever& operator ()() {
+        async_start(&AsyncForever::sleep);
+        return *this;
+    }
+
+protected:
+    Async sleep() {
+        return *this / _sleep(std::chrono::seconds(99999)) / &AsyncForever::finish;
+    }
+
+    Async finish() {
+        jinx_assert(false && "unreachable");
+        return async_return();
+    }
+};
+
+int main(int argc, const char* argv[])
+{
+    {
+        LoopGroup<libevent::EventEngineLibevent> group{4, false};
+        jinx_assert(group.size() == 4);
+
+        jinx_assert(group.task_new<AsyncTest>(0).is(Successful_));
+        jinx_assert(group.task_new<AsyncTest>(1).is(Successful_));
+        jinx_assert(group.get_load(0) == 1);
+
+        group.start();
+
+        for (int i = 0; i < 8; ++i) {
+            jinx_assert(group.task_new_round_robin<AsyncTest>().is(Successful_));
+        }
+        for (int i = 0; i < 8; ++i) {
+            jinx_assert(group.task_new_least_loaded<AsyncTest>().is(Successful_));
+        }
+
+        group.stop();
+        jinx_assert(group.task_new<AsyncTest>(0).is(Failed_));
+        group.join();
+
+        jinx_assert(counter == 18);
+        jinx_assert(threads.size() == 4);
+    }
+
+    {
+        // cancel on shutdown
+        LoopGroup<libevent::EventEngineLibevent> group{2};
+        group.start();
+        jinx_assert(group.task_new_round_robin<AsyncForever>().is(Successful_));
+        jinx_assert(group.task_new_round_robin<AsyncForever>().is(Successful_));
+        group.stop(true);
+        group.join();
+    }
+    return 0;
+}
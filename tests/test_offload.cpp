@@ -0,0 +1,302 @@
+#include <jinx/assert.hpp>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/offload.hpp>
+
+using namespace jinx;
+using namespace jinx::offload;
+
+const int task_count = 100;
+const size_t concurrency = 4;
+
+int done = 0;
+std::thread::id loop_thread{};
+
+class AsyncSquare : public AsyncRoutine {
+    Offload* _pool{nullptr};
+    int _value{0};
+    AsyncOffload<int> _offload{};
+
+public:
+    AsyncSquare& operator ()(Offload* pool, int value) {
+        _pool = pool;
+        _value = value;
+        async_start(&AsyncSquare::square);
+        return *this;
+    }
+
+protected:
+    Async square() {
+        const int value = _value;
+        return *this / _offload(*_pool, [value]() {
+            jinx_assert(loop_thread != std::this_thread::get_id());
+            return value * value;
+        }) / &AsyncSquare::check;
+    }
+
+    Async check() {
+        jinx_assert(loop_thread == std::this_thread::get_id());
+        jinx_assert(_offload.get_result() == _value * _value);
+        done += 1;
+        return async_return();
+    }
+};
+
+class AsyncFailure : public AsyncRoutine {
+    Offload* _pool{nullptr};
+    AsyncOffload<void> _offload{};
+
+public:
+    AsyncFailure& operator ()(Offload* pool) {
+        _pool = pool;
+        async_start(&AsyncFailure::fail);
+        return *this;
+    }
+
+protected:
+    Async fail() {
+        return *this / _offload(*_pool, []() {
+            throw std::runtime_error("failed");
+        }) / &AsyncFailure::unreachable;
+    }
+
+    Async unreachable() {
+        jinx_assert(false);
+        return async_return();
+    }
+
+    Async handle_error(const error::Error& error) override {
+        jinx_assert(error == make_error(ErrorOffload::WorkFailed));
+        done += 1;
+        return async_return();
+    }
+};
+
+std::atomic<bool> gate{false};
+
+// holds the only worker until the gate opens
+class AsyncHolder : public AsyncRoutine {
+    Offload* _pool{nullptr};
+    AsyncOffload<void> _offload{};
+
+public:
+    AsyncHolder& operator ()(Offload* pool) {
+        _pool = pool;
+        async_start(&AsyncHolder::hold);
+        return *this;
+    }
+
+protected:
+    Async hold() {
+        return *this / _offload(*_pool, []() {
+            while (not gate.load()) {
+                std::this_thread::yield();
+            }
+        }) / &AsyncHolder::check;
+    }
+
+    Async check() {
+        done += 1;
+        return async_return();
+    }
+};
+
+// waits in the queue behind the holder
+class AsyncQueued : public AsyncRoutine {
+    Offload* _pool{nullptr};
+    AsyncOffload<int> _offload{};
+
+public:
+    AsyncQueued& operator ()(Offload* pool) {
+        _pool = pool;
+        async_start(&AsyncQueued::submit);
+        return *this;
+    }
+
+protected:
+    Async submit() {
+        if (_pool->running() == 0) {
+            return async_yield(&AsyncQueued::submit);
+        }
+        return *this / _offload(*_pool, []() { return 1; }) / &AsyncQueued::check;
+    }
+
+    Async check() {
+        jinx_assert(_offload.get_result() == 1);
+        done += 1;
+        return async_return();
+    }
+};
+
+// the queue is full, refused and opens the gate
+class AsyncRefused : public AsyncRoutine {
+    Offload* _pool{nullptr};
+    AsyncOffload<void> _offload{};
+
+public:
+    AsyncRefused& operator ()(Offload* pool) {
+        _pool = pool;
+        async_start(&AsyncRefused::submit);
+        return *this;
+    }
+
+protected:
+    Async submit() {
+        if (_pool->running() == 0 or _pool->queued() == 0) {
+            return async_yield(&AsyncRefused::submit);
+        }
+        return *this / _offload(*_pool, []() { jinx_assert(false); }) / &AsyncRefused::unreachable;
+    }
+
+    Async unreachable() {
+        jinx_assert(false);
+        return async_return();
+    }
+
+    Async handle_error(const error::Error& error) override {
+        jinx_assert(error == make_error(ErrorOffload::QueueFull));
+        gate = true;
+        done += 1;
+        return async_return();
+    }
+};
+
+int submitted = 0;
+
+// a job done, one running and one queued when the pool stops
+class AsyncStopper : public AsyncRoutine {
+    Offload* _pool{nullptr};
+
+public:
+    AsyncStopper& operator ()(Offload* pool) {
+        _pool = pool;
+        async_start(&AsyncStopper::stop);
+        return *this;
+    }
+
+protected:
+    Async stop() {
+        if (submitted < 3) {
+            return async_yield(&AsyncStopper::stop);
+        }
+        // the loop does not run the Deliver task meanwhile
+        while (_pool->completed() == 0) {
+            std::this_thread::yield();
+        }
+        jinx_assert(_pool->delivered() == 0);
+        _pool->stop();
+        jinx_assert(_pool->completed() == 3);
+        jinx_assert(_pool->delivered() == 3);
+        // the posted Deliver task runs after the pool is gone
+        delete _pool;
+        return async_return();
+    }
+};
+
+class AsyncSlow : public AsyncRoutine {
+    Offload* _pool{nullptr};
+    int _value{0};
+    AsyncOffload<int> _offload{};
+
+public:
+    AsyncSlow& operator ()(Offload* pool, int value) {
+        _pool = pool;
+        _value = value;
+        async_start(&AsyncSlow::submit);
+        return *this;
+    }
+
+protected:
+    Async submit() {
+        const int value = _value;
+        submitted += 1;
+        return *this / _offload(*_pool, [value]() {
+            if (value == 1) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            return value;
+        }) / &AsyncSlow::check;
+    }
+
+    Async check() {
+        jinx_assert(_offload.get_result() == _value);
+        done += 1;
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+void stop_in_flight() {
+    EventEngine eve{true};
+    Loop loop{&eve};
+    done = 0;
+    submitted = 0;
+
+    auto* pool = new Offload{loop, 1};
+    for (int i = 0; i < 3; ++i) {
+        loop.task_new<AsyncSlow>(pool, i);
+    }
+    loop.task_new<AsyncStopper>(pool);
+    loop.run();
+
+    jinx_assert(done == 3);
+}
+
+template<typename EventEngine>
+void run() {
+    EventEngine eve{true};
+    Loop loop{&eve};
+    done = 0;
+    loop_thread = std::this_thread::get_id();
+
+    {
+        Offload pool{loop, concurrency};
+        jinx_assert(pool.concurrency() == concurrency);
+
+        for (int i = 0; i < task_count; ++i) {
+            loop.task_new<AsyncSquare>(&pool, i);
+        }
+        loop.task_new<AsyncFailure>(&pool);
+        loop.run();
+
+        jinx_assert(done == task_count + 1);
+        jinx_assert(pool.queued() == 0);
+        jinx_assert(pool.running() == 0);
+        jinx_assert(pool.queue_peak() > 0);
+        jinx_assert(pool.completed() == task_count + 1);
+        jinx_assert(pool.delivered() == task_count + 1);
+        jinx_assert(pool.batches() > 0);
+        jinx_assert(pool.batches() <= pool.delivered());
+    }
+
+    // one worker, one queued job
+    {
+        done = 0;
+        gate = false;
+        Offload pool{loop, 1, 1};
+
+        loop.task_new<AsyncHolder>(&pool);
+        loop.task_new<AsyncQueued>(&pool);
+        loop.task_new<AsyncRefused>(&pool);
+        loop.run();
+
+        jinx_assert(done == 3);
+        jinx_assert(pool.queue_peak() == 1);
+        jinx_assert(pool.completed() == 2);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    run<libevent::EventEngineLibevent>();
+    run<epoll::EventEngineEpoll>();
+    stop_in_flight<libevent::EventEngineLibevent>();
+    stop_in_flight<epoll::EventEngineEpoll>();
+    return 0;
+}
@@ -87,6 +87,6 @@ int main(int argc, const char* argv[])
     queue.reset();
 
     std::cout << buf << std::endl;
-    jinx_assert(buf == "put1put2get1get2get3put3");
+    jinx_assert(buf == "get1put1put2put3get2get3");
     return 0;
 }
@@ -0,0 +1,313 @@
+#include <jinx/assert.hpp>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/posix.hpp>
+
+using namespace jinx;
+
+// larger than the socket buffers, sent in parts
+const size_t file_size = 4 * 1024 * 1024;
+const off_t file_offset = 1000;
+const size_t pipe_size = 65536;
+
+std::vector<char> received{};
+
+inline char pattern(size_t offset) {
+    return static_cast<char>(offset % 251);
+}
+
+template<typename EventEngine>
+class Reader : public AsyncRoutine {
+    typename posix::AsyncIOPosix<EventEngine>::Read _read{};
+    int _fd{-1};
+    char _memory[65536];
+
+public:
+    Reader& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Reader::read);
+        return *this;
+    }
+
+protected:
+    Async read() {
+        return *this / _read(_fd, SliceMutable{_memory, sizeof(_memory)}) / &Reader::check;
+    }
+
+    Async check() {
+        const long size = _read.get_result();
+        if (size == 0) {
+            return async_return();
+        }
+        received.insert(received.end(), _memory, _memory + size);
+        return read();
+    }
+};
+
+template<typename EventEngine>
+class FileSender : public AsyncRoutine {
+    typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+    typename asyncio::SendFile _send_file{};
+    int _fd{-1};
+    int _file{-1};
+    off_t _offset{file_offset};
+
+public:
+    FileSender& operator ()(int fd, int file) {
+        _fd = fd;
+        _file = file;
+        async_start(&FileSender::send);
+        return *this;
+    }
+
+protected:
+    Async send() {
+        // asks for more than the file has
+        return *this / _send_file(_fd, _file, &_offset, file_size) / &FileSender::check;
+    }
+
+    Async check() {
+        jinx_assert(_send_file.get_result() == static_cast<long>(file_size - file_offset));
+        jinx_assert(_offset == static_cast<off_t>(file_size));
+        ::shutdown(_fd, SHUT_WR);
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+class PipeSender : public AsyncRoutine {
+    typedef posix::AsyncIOPosix<EventEngine> asyncio;
+
+    typename asyncio::Splice _to_pipe{};
+    typename asyncio::Splice _to_socket{};
+    int _fd{-1};
+    int _file{-1};
+    int _pipe[2]{-1, -1};
+    loff_t _offset{0};
+
+public:
+    PipeSender& operator ()(int fd, int file) {
+        _fd = fd;
+        _file = file;
+        jinx_assert(::pipe(_pipe) == 0);
+        async_start(&PipeSender::fill);
+        return *this;
+    }
+
+protected:
+    void async_finalize() noexcept override {
+        ::close(_pipe[0]);
+        ::close(_pipe[1]);
+        AsyncRoutine::async_finalize();
+    }
+
+    Async fill() {
+        if (_offset == static_cast<loff_t>(file_size)) {
+            ::shutdown(_fd, SHUT_WR);
+            return async_return();
+        }
+        // no more than the pipe holds, the rest waits for the pipe to be writable
+        return *this / _to_pipe(_file, &_offset, _pipe[1], nullptr, pipe_size, 0U) / &PipeSender::drain;
+    }
+
+    Async drain() {
+        const size_t size = static_cast<size_t>(_to_pipe.get_result());
+        jinx_assert(size > 0);
+        return *this / _to_socket(_pipe[0], nullptr, _fd, nullptr, size, 0U) / &PipeSender::check;
+    }
+
+    Async check() {
+        jinx_assert(_to_socket.get_result() == _to_pipe.get_result());
+        return fill();
+    }
+};
+
+const size_t relay_size = 1000;
+const auto relay_delay = std::chrono::milliseconds(100);
+
+// splices from a socket with nothing to read yet, waits for it without spinning
+template<typename EventEngine>
+class SocketRelay : public AsyncRoutine {
+    typename posix::AsyncIOPosix<EventEngine>::Splice _to_pipe{};
+    int _fd{-1};
+    int _pipe{-1};
+
+public:
+    SocketRelay& operator ()(int fd, int pipe) {
+        _fd = fd;
+        _pipe = pipe;
+        async_start(&SocketRelay::relay);
+        return *this;
+    }
+
+protected:
+    Async relay() {
+        return *this / _to_pipe(_fd, nullptr, _pipe, nullptr, relay_size, 0U) / &SocketRelay::check;
+    }
+
+    Async check() {
+        jinx_assert(_to_pipe.get_result() == static_cast<long>(relay_size));
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+class LateWriter : public AsyncRoutine {
+    typename AsyncImplement<EventEngine>::Sleep _sleep{};
+    int _fd{-1};
+
+public:
+    LateWriter& operator ()(int fd) {
+        _fd = fd;
+        async_start(&LateWriter::sleep);
+        return *this;
+    }
+
+protected:
+    Async sleep() {
+        return *this / _sleep(relay_delay) / &LateWriter::write;
+    }
+
+    Async write() {
+        std::vector<char> data(relay_size);
+        for (size_t i = 0; i < relay_size; ++i) {
+            data[i] = pattern(i);
+        }
+        jinx_assert(::write(_fd, data.data(), data.size()) == static_cast<ssize_t>(relay_size));
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+void run_relay() {
+    EventEngine eve{false};
+    Loop loop{&eve};
+
+    int socks[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, socks) == 0);
+    int pipes[2];
+    jinx_assert(::pipe(pipes) == 0);
+
+    loop.task_new<SocketRelay<EventEngine>>(socks[0], pipes[1]);
+    loop.task_new<LateWriter<EventEngine>>(socks[1]);
+    const auto cpu = std::clock();
+    loop.run();
+    const auto used = std::chrono::microseconds((std::clock() - cpu) * 1000000 / CLOCKS_PER_SEC);
+    jinx_assert(used < relay_delay / 2);
+
+    char data[relay_size];
+    jinx_assert(::read(pipes[0], data, sizeof(data)) == static_cast<ssize_t>(relay_size));
+    for (size_t i = 0; i < relay_size; ++i) {
+        jinx_assert(data[i] == pattern(i));
+    }
+    ::close(pipes[0]);
+    ::close(pipes[1]);
+    ::close(socks[0]);
+    ::close(socks[1]);
+}
+
+template<typename EventEngine>
+class ClosedPeerSender : public AsyncRoutine {
+    typename posix::AsyncIOPosix<EventEngine>::SendFile _send_file{};
+    int _fd{-1};
+    int _file{-1};
+    off_t _offset{0};
+
+public:
+    ClosedPeerSender& operator ()(int fd, int file) {
+        _fd = fd;
+        _file = file;
+        async_start(&ClosedPeerSender::send);
+        return *this;
+    }
+
+protected:
+    Async send() {
+        return *this / _send_file(_fd, _file, &_offset, file_size) / &ClosedPeerSender::unreachable;
+    }
+
+    Async unreachable() {
+        jinx_assert(false);
+        return async_return();
+    }
+
+    Async handle_error(const error::Error& error) override {
+        jinx_assert(error == make_error(posix::ErrorPosix::BrokenPipe));
+        return async_return();
+    }
+};
+
+// the default action of SIGPIPE ends the process
+template<typename EventEngine>
+void run_closed_peer(int file) {
+    EventEngine eve{false};
+    Loop loop{&eve};
+
+    int socks[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, socks) == 0);
+    ::close(socks[1]);
+
+    loop.task_new<ClosedPeerSender<EventEngine>>(socks[0], file);
+    loop.run();
+
+    sigset_t pending{};
+    jinx_assert(sigpending(&pending) == 0);
+    jinx_assert(sigismember(&pending, SIGPIPE) == 0);
+    ::close(socks[0]);
+}
+
+template<typename EventEngine, template<typename> class Sender>
+void run(int file, size_t expected_offset) {
+    EventEngine eve{false};
+    Loop loop{&eve};
+    received.clear();
+
+    int socks[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, socks) == 0);
+
+    loop.task_new<Sender<EventEngine>>(socks[0], file);
+    loop.task_new<Reader<EventEngine>>(socks[1]);
+    loop.run();
+
+    jinx_assert(received.size() == file_size - expected_offset);
+    for (size_t i = 0; i < received.size(); ++i) {
+        jinx_assert(received[i] == pattern(expected_offset + i));
+    }
+    ::close(socks[0]);
+    ::close(socks[1]);
+}
+
+int main(int argc, const char* argv[])
+{
+    FILE* file = tmpfile();
+    jinx_assert(file != nullptr);
+    std::vector<char> content(file_size);
+    for (size_t i = 0; i < file_size; ++i) {
+        content[i] = pattern(i);
+    }
+    jinx_assert(fwrite(content.data(), 1, content.size(), file) == file_size);
+    jinx_assert(fflush(file) == 0);
+    const int fd = fileno(file);
+
+    run<libevent::EventEngineLibevent, FileSender>(fd, file_offset);
+    run<epoll::EventEngineEpoll, FileSender>(fd, file_offset);
+    run<libevent::EventEngineLibevent, PipeSender>(fd, 0);
+    run<epoll::EventEngineEpoll, PipeSender>(fd, 0);
+    run_relay<libevent::EventEngineLibevent>();
+    run_relay<epoll::EventEngineEpoll>();
+    run_closed_peer<libevent::EventEngineLibevent>(fd);
+    run_closed_peer<epoll::EventEngineEpoll>(fd);
+
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <jinx/assert.hpp>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <vector>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <jinx/buffer.hpp>
+#include <jinx/posix.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+struct BufferConfigSmall
+{
+    constexpr static char const* Name = "Small";
+    static constexpr const size_t Size = 1500;
+    static constexpr const size_t Reserve = 4;
+    static constexpr const long Limit = -1;
+
+    struct Information { };
+};
+
+struct BufferConfigLarge
+{
+    constexpr static char const* Name = "Large";
+    static constexpr const size_t Size = 512 * 1024;
+    static constexpr const size_t Reserve = 0;
+    static constexpr const long Limit = -1;
+
+    struct Information { };
+};
+
+typedef BufferAllocator<posix::SlabMemoryProvider, BufferConfigSmall, BufferConfigLarge> AllocatorType;
+typedef AllocatorType::BufferType BufferType;
+
+bool is_resident(void* memory) {
+    const auto page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    auto* start = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(memory) & ~(page - 1));
+    unsigned char vec = 0;
+    jinx_assert(::mincore(start, 1, &vec) == 0);
+    return (vec & 1) != 0;
+}
+
+void test_slots() {
+    const size_t region_size = 64 * 1024;
+    const size_t size = 1000;
+    posix::SlabMemoryProvider slab{region_size};
+
+    // 1000 bytes and the prefix round up to 1024 bytes slots, 64 in a region
+    const size_t slots = region_size / 1024;
+    std::vector<char*> memory{};
+    std::set<char*> distinct{};
+    for (size_t i = 0; i < slots + 1; ++i) {
+        auto* mem = static_cast<char*>(slab.alloc(size));
+        jinx_assert(mem != nullptr);
+        jinx_assert(reinterpret_cast<uintptr_t>(mem) % 16 == 0);
+        ::memset(mem, static_cast<int>(i), size);
+        memory.push_back(mem);
+        distinct.insert(mem);
+    }
+    jinx_assert(distinct.size() == slots + 1);
+    jinx_assert(slab.region_count() == 2);
+    jinx_assert(slab.resident_region_count() == 2);
+    jinx_assert(slab.used_slot_count() == slots + 1);
+    for (size_t i = 0; i < memory.size(); ++i) {
+        jinx_assert(memory[i][0] == static_cast<char>(i) and memory[i][size - 1] == static_cast<char>(i));
+    }
+
+    // a freed slot is taken again before the region is extended
+    slab.free(memory[3]);
+    auto* again = static_cast<char*>(slab.alloc(size));
+    jinx_assert(again == memory[3]);
+
+    // the idle second region keeps its pages
+    slab.free(memory[slots]);
+    jinx_assert(slab.resident_region_count() == 2);
+    jinx_assert(is_resident(memory[slots]));
+
+    // the busy region is preferred over the idle one
+    slab.free(memory[0]);
+    jinx_assert(slab.alloc(size) == memory[0]);
+
+    // the first region goes idle and back to the OS
+    jinx_assert(is_resident(memory[0]));
+    for (size_t i = 0; i < slots; ++i) {
+        slab.free(memory[i]);
+    }
+    jinx_assert(slab.used_slot_count() == 0);
+    jinx_assert(slab.resident_region_count() == 1);
+    jinx_assert(slab.region_count() == 2);
+    jinx_assert(not is_resident(memory[0]));
+
+    // the kept one is taken first, as it was
+    auto* mem = static_cast<char*>(slab.alloc(size));
+    jinx_assert(mem == memory[slots]);
+    jinx_assert(mem[size - 1] == static_cast<char>(slots));
+    slab.free(mem);
+
+    // each size has regions of its own
+    auto* other = slab.alloc(3000);
+    jinx_assert(other != nullptr);
+    jinx_assert(slab.region_count() == 3);
+    slab.free(other);
+}
+
+void test_allocator(int flags) {
+    posix::SlabMemoryProvider slab{posix::SlabMemoryProvider::HugePageSize, flags};
+    {
+        AllocatorType allocator{slab};
+        jinx_assert(allocator.reserve_buffer_count() == BufferConfigSmall::Reserve);
+        jinx_assert(slab.used_slot_count() == BufferConfigSmall::Reserve);
+
+        std::vector<BufferType> buffers{};
+        for (int i = 0; i < 100; ++i) {
+            buffers.emplace_back(allocator.allocate(BufferConfigSmall{}));
+            jinx_assert(buffers.back() != nullptr);
+            auto slice = buffers.back()->slice_for_producer();
+            ::memset(slice.begin(), i, slice.size());
+            jinx_assert(buffers.back()->commit(slice.size()).is(Successful_));
+        }
+        for (int i = 0; i < 8; ++i) {
+            buffers.emplace_back(allocator.allocate(BufferConfigLarge{}));
+            jinx_assert(buffers.back() != nullptr);
+            jinx_assert(buffers.back()->capacity() >= BufferConfigLarge::Size);
+        }
+        // 1500 bytes buffers in one region, the large ones in regions of at least 8 slots
+        jinx_assert(slab.region_count() == 2);
+        jinx_assert(slab.used_slot_count() == 108);
+        for (int i = 0; i < 100; ++i) {
+            auto* data = buffers[i]->begin();
+            jinx_assert(data[0] == static_cast<char>(i) and data[BufferConfigSmall::Size - 1] == static_cast<char>(i));
+        }
+        if ((flags & posix::SlabMemoryProvider::SlabHugePages) == 0) {
+            jinx_assert(slab.huge_region_count() == 0);
+        }
+
+        buffers.clear();
+        // the reserve of the small buffers is kept, the large ones are freed, their region kept idle
+        jinx_assert(allocator.active_buffer_count() == BufferConfigSmall::Reserve);
+        jinx_assert(slab.used_slot_count() == BufferConfigSmall::Reserve);
+        jinx_assert(slab.resident_region_count() == 2);
+    }
+    jinx_assert(slab.used_slot_count() == 0);
+    jinx_assert(slab.region_count() == 2);
+}
+
+int main(int argc, const char* argv[])
+{
+    test_slots();
+    test_allocator(0);
+    test_allocator(posix::SlabMemoryProvider::SlabPopulate);
+    // falls back to transparent huge pages without reserved ones
+    test_allocator(posix::SlabMemoryProvider::SlabHugePages | posix::SlabMemoryProvider::SlabPopulate);
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <jinx/assert.hpp>
+#include <algorithm>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/streamsocket.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+// more views than one sendmsg takes, one larger than the socket buffers, some empty
+const size_t view_count = 24;
+const size_t large_view = 5;
+
+std::vector<char> content{};
+std::vector<char> received{};
+size_t written = 0;
+
+inline char pattern(size_t offset) {
+    return static_cast<char>(offset % 251);
+}
+
+template<typename EventEngine>
+class Reader : public AsyncRoutine {
+    typename posix::AsyncIOPosix<EventEngine>::Recv _recv{};
+    int _fd{-1};
+    char _memory[65536];
+
+public:
+    Reader& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Reader::recv);
+        return *this;
+    }
+
+protected:
+    Async recv() {
+        return *this / _recv(_fd, SliceMutable{_memory, sizeof(_memory)}, 0) / &Reader::check;
+    }
+
+    Async check() {
+        const long size = _recv.get_result();
+        if (size == 0) {
+            return async_return();
+        }
+        received.insert(received.end(), _memory, _memory + size);
+        return recv();
+    }
+};
+
+// takes the default writev of Stream
+template<typename EventEngine>
+class StreamWriteOnly : public stream::Stream {
+    stream::StreamSocket<posix::AsyncIOPosix<EventEngine>>* _socket{nullptr};
+
+public:
+    explicit StreamWriteOnly(stream::StreamSocket<posix::AsyncIOPosix<EventEngine>>* socket)
+    : _socket(socket)
+    { }
+
+    Awaitable& shutdown() override { return _socket->shutdown(); }
+    void reset() noexcept override { _socket->reset(); }
+    Awaitable& write(BufferView* view) override { return _socket->write(view); }
+    Awaitable& read(BufferView* view) override { return _socket->read(view); }
+};
+
+class Writer : public AsyncRoutine {
+    stream::Stream* _stream{nullptr};
+    int _fd{-1};
+    BufferView _views[view_count];
+    BufferView* _pointers[view_count];
+
+public:
+    Writer& operator ()(stream::Stream* stream, int fd) {
+        _stream = stream;
+        _fd = fd;
+        size_t offset = 0;
+        for (size_t i = 0; i < view_count; ++i) {
+            size_t size = i % 3 == 2 ? 0 : i * 10 + 1;
+            if (i == large_view) {
+                size = 1024 * 1024;
+            }
+            _views[i] = BufferView{&content[offset], size, 0, size};
+            _pointers[i] = &_views[i];
+            offset += size;
+        }
+        written = offset;
+        async_start(&Writer::write);
+        return *this;
+    }
+
+protected:
+    Async write() {
+        return *this / _stream->writev(_pointers, view_count) / &Writer::check;
+    }
+
+    Async check() {
+        for (size_t i = 0; i < view_count; ++i) {
+            jinx_assert(_views[i].size() == 0);
+        }
+        ::shutdown(_fd, SHUT_WR);
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+void run(bool write_only) {
+    typedef stream::StreamSocket<posix::AsyncIOPosix<EventEngine>> StreamType;
+
+    EventEngine eve{false};
+    Loop loop{&eve};
+    received.clear();
+
+    int socks[2];
+    jinx_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+    posix::Socket sock{socks[0]};
+    sock.set_non_blocking(true);
+    posix::Socket peer{socks[1]};
+    peer.set_non_blocking(true);
+
+    StreamType stream{};
+    stream.initialize(std::move(sock));
+
+    StreamWriteOnly<EventEngine> write_only_stream{&stream};
+    stream::Stream* writer_stream = &stream;
+    if (write_only) {
+        writer_stream = &write_only_stream;
+    }
+
+    loop.task_new<Writer>(writer_stream, stream.io_handle().native_handle());
+    loop.task_new<Reader<EventEngine>>(peer.native_handle());
+    loop.run();
+
+    jinx_assert(received.size() == written);
+    jinx_assert(std::equal(received.begin(), received.end(), content.begin()));
+}
+
+int main(int argc, const char* argv[])
+{
+    content.resize(2 * 1024 * 1024);
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = pattern(i);
+    }
+
+    run<libevent::EventEngineLibevent>(false);
+    run<epoll::EventEngineEpoll>(false);
+    run<epoll::EventEngineEpoll>(true);
+    return 0;
+}
@@ -0,0 +1,282 @@
+#include <jinx/assert.hpp>
+#include <cstring>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <jinx/async.hpp>
+#include <jinx/buffer.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+#include <jinx/streamsocket.hpp>
+
+using namespace jinx;
+using namespace jinx::buffer;
+
+struct BufferConfigLarge
+{
+    constexpr static char const* Name = "Large";
+    static constexpr const size_t Size = 256 * 1024;
+    static constexpr const size_t Reserve = 2;
+    static constexpr const long Limit = -1;
+
+    struct Information { };
+};
+
+typedef BufferAllocator<posix::MemoryProvider, BufferConfigLarge> AllocatorType;
+typedef AllocatorType::BufferType BufferType;
+
+const size_t small_size = 100;
+const size_t threshold = 16 * 1024;
+const size_t reset_size = 128 * 1024;
+
+std::vector<char> received{};
+
+inline char pattern(size_t offset) {
+    return static_cast<char>(offset % 251);
+}
+
+template<typename EventEngine>
+class Reader : public AsyncRoutine {
+    typename posix::AsyncIOPosix<EventEngine>::Recv _recv{};
+    int _fd{-1};
+    char _memory[65536];
+
+public:
+    Reader& operator ()(int fd) {
+        _fd = fd;
+        async_start(&Reader::recv);
+        return *this;
+    }
+
+protected:
+    Async recv() {
+        return *this / _recv(_fd, SliceMutable{_memory, sizeof(_memory)}, 0) / &Reader::check;
+    }
+
+    Async check() {
+        const long size = _recv.get_result();
+        if (size == 0) {
+            ::shutdown(_fd, SHUT_WR);
+            return async_return();
+        }
+        received.insert(received.end(), _memory, _memory + size);
+        return recv();
+    }
+};
+
+template<typename EventEngine>
+class Writer : public AsyncRoutine {
+    typedef stream::StreamSocket<posix::AsyncIOPosix<EventEngine>> StreamType;
+
+    StreamType* _stream{nullptr};
+    AllocatorType* _allocator{nullptr};
+    BufferType _buffer{};
+    size_t _offset{0};
+    uint32_t _pending{0};
+
+public:
+    Writer& operator ()(StreamType* stream, AllocatorType* allocator) {
+        _stream = stream;
+        _allocator = allocator;
+        async_start(&Writer::write_large);
+        return *this;
+    }
+
+protected:
+    void fill(size_t size) {
+        _buffer = _allocator->allocate(BufferConfigLarge{});
+        jinx_assert(_buffer != nullptr);
+        auto slice = _buffer->slice_for_producer();
+        for (size_t i = 0; i < size; ++i) {
+            slice.begin()[i] = pattern(_offset + i);
+        }
+        _buffer->commit(size) >> JINX_IGNORE_RESULT;
+        _offset += size;
+    }
+
+    Async write_large() {
+        fill(BufferConfigLarge::Size);
+        return *this / _stream->write(_buffer) / &Writer::write_small;
+    }
+
+    Async write_small() {
+        // the kernel keeps the memory of the last send at least
+        _pending = _stream->zero_copy_references().size();
+        jinx_assert(_pending > 0);
+        jinx_assert(_buffer->size() == 0);
+
+        fill(small_size);
+        return *this / _stream->write(_buffer) / &Writer::shutdown;
+    }
+
+    Async shutdown() {
+        // copied, nothing held
+        jinx_assert(_stream->zero_copy_references().size() <= _pending);
+        _buffer.reset();
+        return *this / _stream->shutdown() / &Writer::async_return;
+    }
+};
+
+template<typename EventEngine>
+class ResetWriter : public AsyncRoutine {
+    typedef stream::StreamSocket<posix::AsyncIOPosix<EventEngine>> StreamType;
+
+    StreamType* _stream{nullptr};
+    AllocatorType* _allocator{nullptr};
+    BufferType _buffer{};
+
+public:
+    ResetWriter& operator ()(StreamType* stream, AllocatorType* allocator) {
+        _stream = stream;
+        _allocator = allocator;
+        async_start(&ResetWriter::write);
+        return *this;
+    }
+
+protected:
+    Async write() {
+        _buffer = _allocator->allocate(BufferConfigLarge{});
+        jinx_assert(_buffer != nullptr);
+        auto slice = _buffer->slice_for_producer();
+        for (size_t i = 0; i < reset_size; ++i) {
+            slice.begin()[i] = pattern(i);
+        }
+        _buffer->commit(reset_size) >> JINX_IGNORE_RESULT;
+        return *this / _stream->write(_buffer) / &ResetWriter::reset;
+    }
+
+    Async reset() {
+        // the peer reads nothing yet, the kernel still holds the buffer
+        jinx_assert(_stream->zero_copy_references().size() > 0);
+        _buffer.reset();
+        _stream->reset();
+
+        // the buffers allocated next must not be the one in flight
+        std::vector<BufferType> buffers{};
+        for (int i = 0; i < 4; ++i) {
+            buffers.push_back(_allocator->allocate(BufferConfigLarge{}));
+            jinx_assert(buffers.back() != nullptr);
+            memset(buffers.back()->slice_for_producer().begin(), 'x', reset_size);
+        }
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+void reset_in_flight() {
+    typedef stream::StreamSocket<posix::AsyncIOPosix<EventEngine>> StreamType;
+
+    EventEngine eve{false};
+    Loop loop{&eve};
+    received.clear();
+
+    posix::MemoryProvider memory{};
+    AllocatorType allocator{memory};
+
+    posix::SocketAddress addr{"127.0.0.1", 0, posix::SocketAddressAbortOnFailure};
+    posix::Socket listener{};
+    jinx_assert(listener.create(AF_INET, SOCK_STREAM, 0).unwrap() >= 0);
+    // most of the data waits in the queue of the sender, still on the pages of the buffer
+    int size = 4096;
+    jinx_assert(::setsockopt(listener.native_handle(), SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) == 0);
+    // segments below the window, the loopback ones would wait for window probes
+    int segment = 1024;
+    jinx_assert(::setsockopt(listener.native_handle(), IPPROTO_TCP, TCP_MAXSEG, &segment, sizeof(segment)) == 0);
+    jinx_assert(listener.bind(addr).unwrap() == 0);
+    jinx_assert(listener.listen(1).unwrap() == 0);
+    jinx_assert(listener.get_socket_name(addr).unwrap() == 0);
+
+    posix::Socket client{};
+    jinx_assert(client.create(AF_INET, SOCK_STREAM, 0).unwrap() >= 0);
+    size = 1024 * 1024;
+    jinx_assert(::setsockopt(client.native_handle(), SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) == 0);
+    jinx_assert(::setsockopt(client.native_handle(), IPPROTO_TCP, TCP_MAXSEG, &segment, sizeof(segment)) == 0);
+    jinx_assert(::connect(client.native_handle(), addr.data(), addr.size()) == 0);
+    posix::Socket server{::accept(listener.native_handle(), nullptr, nullptr)};
+    jinx_assert(server.is_valid());
+    client.set_non_blocking(true);
+    server.set_non_blocking(true);
+
+    StreamType stream{};
+    stream.initialize(std::move(client));
+    jinx_assert(stream.set_zero_copy(threshold).is(Successful_));
+
+    loop.task_new<ResetWriter<EventEngine>>(&stream, &allocator);
+    loop.run();
+
+    // parked with the buffer until the peer reads it
+    jinx_assert(stream::reap_zero_copy_parked() == 1);
+    jinx_assert(allocator.active_buffer_count() > allocator.reserve_buffer_count());
+
+    loop.task_new<Reader<EventEngine>>(server.native_handle());
+    loop.run();
+
+    jinx_assert(received.size() == reset_size);
+    for (size_t i = 0; i < received.size(); ++i) {
+        jinx_assert(received[i] == pattern(i));
+    }
+
+    jinx_assert(stream::reap_zero_copy_parked() == 0);
+    jinx_assert(allocator.active_buffer_count() == allocator.reserve_buffer_count());
+}
+
+template<typename EventEngine>
+void run() {
+    typedef stream::StreamSocket<posix::AsyncIOPosix<EventEngine>> StreamType;
+
+    EventEngine eve{false};
+    Loop loop{&eve};
+    received.clear();
+
+    posix::MemoryProvider memory{};
+    AllocatorType allocator{memory};
+
+    posix::SocketAddress addr{"127.0.0.1", 0, posix::SocketAddressAbortOnFailure};
+    posix::Socket listener{};
+    jinx_assert(listener.create(AF_INET, SOCK_STREAM, 0).unwrap() >= 0);
+    jinx_assert(listener.bind(addr).unwrap() == 0);
+    jinx_assert(listener.listen(1).unwrap() == 0);
+    jinx_assert(listener.get_socket_name(addr).unwrap() == 0);
+
+    posix::Socket client{};
+    jinx_assert(client.create(AF_INET, SOCK_STREAM, 0).unwrap() >= 0);
+    jinx_assert(::connect(client.native_handle(), addr.data(), addr.size()) == 0);
+    posix::Socket server{::accept(listener.native_handle(), nullptr, nullptr)};
+    jinx_assert(server.is_valid());
+    client.set_non_blocking(true);
+    server.set_non_blocking(true);
+
+    {
+        StreamType stream{};
+        stream.initialize(std::move(client));
+        jinx_assert(stream.set_zero_copy(threshold).is(Successful_));
+
+        loop.task_new<Writer<EventEngine>>(&stream, &allocator);
+        loop.task_new<Reader<EventEngine>>(server.native_handle());
+        loop.run();
+
+        jinx_assert(received.size() == BufferConfigLarge::Size + small_size);
+        for (size_t i = 0; i < received.size(); ++i) {
+            jinx_assert(received[i] == pattern(i));
+        }
+
+        // every completion is queued once the peer read all of it
+        stream.zero_copy_references().reap(stream.io_handle().native_handle());
+        jinx_assert(stream.zero_copy_references().size() == 0);
+    }
+
+    // back to the pool
+    jinx_assert(allocator.active_buffer_count() == allocator.reserve_buffer_count());
+}
+
+int main(int argc, const char* argv[])
+{
+    run<libevent::EventEngineLibevent>();
+    run<epoll::EventEngineEpoll>();
+
+    reset_in_flight<libevent::EventEngineLibevent>();
+    reset_in_flight<epoll::EventEngineEpoll>();
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <jinx/assert.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <jinx/async.hpp>
+#include <jinx/libevent.hpp>
+#include <jinx/epoll.hpp>
+
+using namespace jinx;
+
+const int count = 200;
+const int spread = 50;
+
+std::vector<int> order{};
+TimerWheel* wheel = nullptr;
+
+struct Timer {
+    TimerWheel::Entry _entry{};
+    int _ms{0};
+};
+
+template<typename EventEngine>
+class AsyncSleepFor : public AsyncRoutine {
+    typename AsyncImplement<EventEngine>::Sleep _sleep{};
+    int _ms{0};
+    TimerWheel::Clock::time_point _start{};
+
+public:
+    AsyncSleepFor& operator ()(int ms) {
+        _ms = ms;
+        async_start(&AsyncSleepFor::sleep);
+        return *this;
+    }
+
+protected:
+    Async sleep() {
+        _start = TimerWheel::Clock::now();
+        return *this / _sleep(std::chrono::milliseconds(_ms)) / &AsyncSleepFor::finish;
+    }
+
+    Async finish() {
+        // never early
+        jinx_assert(TimerWheel::Clock::now() - _start >= std::chrono::milliseconds(_ms));
+        order.push_back(_ms);
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+class AsyncTimeout : public AsyncRoutine {
+    typedef AsyncImplement<EventEngine> async;
+
+    enum Tags {
+        Short,
+        Long
+    };
+
+    Tagged<Tags, typename async::Sleep> _short{};
+    Tagged<Tags, typename async::Sleep> _long{};
+    typename async::template Wait<Tags> _wait{};
+
+public:
+    AsyncTimeout& operator ()() {
+        _wait.initialize(WaitCondition::FirstCompleted);
+        _wait.branch_create(_short(std::chrono::milliseconds(5)).set_tag(Short)) >> JINX_IGNORE_RESULT;
+        _wait.branch_create(_long(std::chrono::hours(24)).set_tag(Long)) >> JINX_IGNORE_RESULT;
+        async_start(&AsyncTimeout::wait);
+        return *this;
+    }
+
+protected:
+    Async wait() {
+        return *this / _wait / &AsyncTimeout::process;
+    }
+
+    Async process() {
+        // the branches share the wheel of the loop
+        jinx_assert(wheel->size() > 0);
+        order.push_back(-1);
+        return async_return();
+    }
+};
+
+template<typename EventEngine>
+void run() {
+    EventEngine eve{false};
+    Loop loop{&eve};
+    jinx_assert(loop.set_timer_slack(std::chrono::microseconds(100)).is(Successful_));
+    wheel = &loop.get_timer_wheel<EventEngine>();
+    order.clear();
+
+    // 200 sleeps over 50 timeouts
+    for (int i = 0; i < count; ++i) {
+        loop.task_new<AsyncSleepFor<EventEngine>>((i * 7) % spread * 3);
+    }
+    loop.run();
+
+    // a timeout starts when it is added, none expired early
+    jinx_assert(order.size() == count);
+    jinx_assert(wheel->size() == 0);
+
+    // 200 timers over 50 deadlines, some past the first level of the wheel
+    order.clear();
+    const auto arms = wheel->get_arm_count();
+    const auto base = TimerWheel::Clock::now();
+    std::unique_ptr<Timer[]> timers{new Timer[count]};
+    for (int i = 0; i < count; ++i) {
+        timers[i]._ms = (i * 7) % spread * 3;
+        jinx_assert(wheel->add(
+            timers[i]._entry,
+            base + std::chrono::milliseconds(timers[i]._ms),
+            [](void* arg) { order.push_back(static_cast<Timer*>(arg)->_ms); },
+            &timers[i]).is(Successful_));
+    }
+    // keeps the loop running past the last deadline
+    loop.task_new<AsyncSleepFor<EventEngine>>(spread * 3 + 10);
+    loop.run();
+
+    jinx_assert(order.size() == count + 1);
+    for (size_t i = 1; i < order.size(); ++i) {
+        jinx_assert(order[i - 1] <= order[i]);
+    }
+    // armed per deadline and per cascade of the upper levels, not per timer
+    jinx_assert(wheel->get_arm_count() - arms < count / 2);
+    jinx_assert(wheel->size() == 0);
+
+    // cancelled by the first completed branch
+    order.clear();
+    loop.task_new<AsyncTimeout<EventEngine>>();
+    loop.run();
+    jinx_assert(order.size() == 1 and order[0] == -1);
+    // the long sleep left the wheel with its branch
+    jinx_assert(wheel->size() == 0);
+
+    // the slack is fixed while timers are pending
+    TimerWheel::Entry entry{};
+    jinx_assert(wheel->add(entry, std::chrono::seconds(1), [](void*) { }, nullptr).is(Successful_));
+    jinx_assert(loop.set_timer_slack(std::chrono::milliseconds(1)).is(Failed_));
+    entry.cancel();
+    jinx_assert(loop.set_timer_slack(std::chrono::milliseconds(1)).is(Successful_));
+    jinx_assert(wheel->get_slack() == std::chrono::milliseconds(1));
+}
+
+int main(int argc, const char* argv[])
+{
+    run<libevent::EventEngineLibevent>();
+    run<epoll::EventEngineEpoll>();
+    return 0;
+}